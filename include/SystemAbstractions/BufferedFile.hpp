@@ -0,0 +1,109 @@
+#ifndef SYSTEM_ABSTRACTIONS_BUFFERED_FILE_HPP
+#define SYSTEM_ABSTRACTIONS_BUFFERED_FILE_HPP
+
+/**
+ * @file BufferedFile.hpp
+ *
+ * This module declares the SystemAbstractions::BufferedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "IFile.hpp"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class wraps another file, reading ahead of and writing behind
+     * the current position through a buffer, so that many small reads
+     * and writes turn into a few large ones on the wrapped file.
+     *
+     * The wrapped file is only accessed through its ReadAt, WriteAt,
+     * GetSize, and SetSize methods, so its own current position is
+     * neither used nor changed.  Nothing else should write to the
+     * wrapped file while it's wrapped, since data read ahead into
+     * the buffer would not reflect the change.
+     *
+     * @note
+     *     Data written is held in the buffer until it fills up,
+     *     the file is read or resized, or the Flush method is called,
+     *     so errors writing it are only reported by the Flush method.
+     *     Data which could not be written stays in the buffer, so
+     *     later writes elsewhere in the file fail, reads stop short of
+     *     it, and Clone returns nullptr, until a flush succeeds.
+     *     The buffer is also flushed when the object is destroyed.
+     */
+    class BufferedFile: public IFile {
+        // Lifecycle management
+    public:
+        ~BufferedFile() noexcept;
+        BufferedFile(const BufferedFile&) = delete;
+        BufferedFile(BufferedFile&&) noexcept;
+        BufferedFile& operator=(const BufferedFile&) = delete;
+        BufferedFile& operator=(BufferedFile&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the instance constructor.
+         *
+         * @param[in] file
+         *     This is the file to wrap.
+         *
+         * @param[in] bufferSize
+         *     This is the number of bytes to read ahead or hold
+         *     behind at a time.
+         */
+        explicit BufferedFile(
+            std::shared_ptr< IFile > file,
+            size_t bufferSize = 65536
+        );
+
+        /**
+         * This method writes any data being held in the buffer
+         * to the wrapped file.
+         *
+         * @return
+         *     A flag indicating whether or not all the data held
+         *     in the buffer was written successfully is returned.
+         */
+        bool Flush();
+
+        // IFile
+    public:
+        virtual uint64_t GetSize() const override;
+        virtual bool SetSize(uint64_t size) override;
+        virtual uint64_t GetPosition() const override;
+        virtual void SetPosition(uint64_t position) override;
+        virtual size_t Peek(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) const override;
+        virtual size_t Peek(void* buffer, size_t numBytes) const override;
+        virtual size_t Read(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override;
+        virtual size_t Read(void* buffer, size_t numBytes) override;
+        virtual size_t Write(const Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override;
+        virtual size_t Write(const void* buffer, size_t numBytes) override;
+        virtual size_t ReadAt(uint64_t position, void* buffer, size_t numBytes) const override;
+        virtual size_t WriteAt(uint64_t position, const void* buffer, size_t numBytes) override;
+        virtual std::shared_ptr< IFile > Clone() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_BUFFERED_FILE_HPP */
@@ -0,0 +1,112 @@
+#ifndef SYSTEM_ABSTRACTIONS_DIAGNOSTICS_BINARY_LOG_HPP
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTICS_BINARY_LOG_HPP
+
+/**
+ * @file DiagnosticsBinaryLog.hpp
+ *
+ * This module declares the SystemAbstractions::DiagnosticsBinaryLogReporter
+ * and SystemAbstractions::DecodeDiagnosticsBinaryLog functions.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "DiagnosticsSender.hpp"
+
+#include <functional>
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+
+namespace SystemAbstractions {
+
+    /**
+     * This is the type of function called by DecodeDiagnosticsBinaryLog
+     * to deliver each diagnostic message decoded from a binary log.
+     *
+     * @param[in] time
+     *     This is the time, in seconds, at which the message was
+     *     recorded, relative to when the reporter recording it was made.
+     *
+     * @param[in] senderName
+     *     This identifies the origin of the diagnostic information.
+     *
+     * @param[in] level
+     *     This is used to filter out less-important information.
+     *     The level is higher the more important the information is.
+     *
+     * @param[in] message
+     *     This is the content of the message, including any
+     *     context prefix.
+     */
+    typedef std::function<
+        void(
+            double time,
+            const std::string& senderName,
+            size_t level,
+            const std::string& message
+        )
+    > DiagnosticsBinaryLogMessageDelegate;
+
+    /**
+     * This function returns a new raw diagnostic message delegate which
+     * records all received diagnostic messages into the given file,
+     * in a compact binary form, without formatting them.
+     *
+     * Each message is recorded as the time received, the level,
+     * references to the sender name, context prefix, and format string,
+     * and the raw values of the arguments.  Sender names, context
+     * prefixes, and format strings are each recorded only once.
+     * Formatting is left to DecodeDiagnosticsBinaryLog, which can
+     * be run later, such as by a separate program.
+     *
+     * Records are only ever appended to the file, so the file
+     * may already hold records from earlier reporters.  The file
+     * must be decoded on a machine with the same byte order as the
+     * one which recorded it.  Arguments for "%Lf" and similar
+     * conversions are recorded in the recording machine's own
+     * "long double" representation, so they should be decoded
+     * by a program built with the same compiler.
+     *
+     * Format strings are recognized by content, so formats built at
+     * run time are fine.  Once many different strings have been
+     * recorded, the reporter forgets them and records them again
+     * as needed, so memory used to record and decode stays bounded.
+     *
+     * The delegate is meant to be given to
+     * DiagnosticsSender::SubscribeToRawDiagnostics.
+     *
+     * @param[in] file
+     *     This is the file to which to record all diagnostic messages.
+     *     It should be opened for writing (or appending) in binary mode.
+     *
+     * @return
+     *     The new raw diagnostic message delegate is returned.
+     */
+    DiagnosticsSender::DiagnosticRawMessageDelegate DiagnosticsBinaryLogReporter(
+        FILE* file
+    );
+
+    /**
+     * This function reads diagnostic messages recorded in the given file
+     * by DiagnosticsBinaryLogReporter, formats them, and delivers them
+     * to the given delegate.
+     *
+     * @param[in] file
+     *     This is the file from which to read diagnostic messages.
+     *     It should be opened for reading in binary mode.
+     *
+     * @param[in] delegate
+     *     This is the function to call to deliver each message decoded.
+     *
+     * @return
+     *     An indication of whether or not the whole file was decoded
+     *     successfully is returned.
+     */
+    bool DecodeDiagnosticsBinaryLog(
+        FILE* file,
+        DiagnosticsBinaryLogMessageDelegate delegate
+    );
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_DIAGNOSTICS_BINARY_LOG_HPP */
@@ -19,6 +19,10 @@ namespace SystemAbstractions {
      * This is a helper object which pushes a string onto the context
      * stack of a diagnostic sender.  The string pushed is popped when
      * the helper object is destroyed.
+     *
+     * Since context stacks are kept per thread, the helper object
+     * must be destroyed by the same thread that made it.  It allocates
+     * no memory of its own, so it's cheap to make on the stack.
      */
     class DiagnosticsContext {
         // Lifecycle Management
@@ -51,16 +55,10 @@ namespace SystemAbstractions {
         // Private properties
     private:
         /**
-         * This is the type of structure that contains the private
-         * properties of the instance.  It is defined in the implementation
-         * and declared here to ensure that it is scoped inside the class.
+         * This is the sender upon which this class is pushing a context
+         * as long as the class instance exists.
          */
-        struct Impl;
-
-        /**
-         * This contains the private properties of the instance.
-         */
-        std::unique_ptr< Impl > impl_;
+        DiagnosticsSender& diagnosticsSender_;
     };
 
 }
@@ -15,8 +15,120 @@
 #include <stddef.h>
 #include <string>
 
+/**
+ * This is the lowest level of diagnostic message kept in the program
+ * when published through the SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING,
+ * SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED, or
+ * SYSTEM_ABSTRACTIONS_DIAGNOSTIC_LAZY macros.  Messages published with
+ * a constant level below this are removed entirely by the compiler.
+ * It may be raised (for example, in release builds) by defining it
+ * on the compiler command line.
+ */
+#ifndef SYSTEM_ABSTRACTIONS_DIAGNOSTICS_COMPILED_MIN_LEVEL
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTICS_COMPILED_MIN_LEVEL 0
+#endif /* SYSTEM_ABSTRACTIONS_DIAGNOSTICS_COMPILED_MIN_LEVEL */
+
+/**
+ * This evaluates to an indication of whether or not a diagnostic
+ * message of the given level would be delivered by the given sender
+ * to any subscriber, checking first the compiled-in minimum level,
+ * and then the sender's current minimum level.
+ *
+ * @param[in] sender
+ *     This is the sender which would publish the message.
+ *
+ * @param[in] level
+ *     This is the level of the message.
+ */
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTIC_ENABLED(sender, level) \
+    ( \
+        ((size_t)(level) >= SystemAbstractions::DIAGNOSTICS_COMPILED_MIN_LEVEL) \
+        && ((size_t)(level) >= (sender).GetMinLevel()) \
+    )
+
+/**
+ * This publishes a static diagnostic message from the given sender,
+ * without evaluating the message at all unless the message would
+ * be delivered to a subscriber.
+ *
+ * @param[in] sender
+ *     This is the sender from which to publish the message.
+ *
+ * @param[in] level
+ *     This is used to filter out less-important information.
+ *     The level is higher the more important the information is.
+ *
+ * @param[in] message
+ *     This is the content of the message.
+ */
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(sender, level, message) \
+    do { \
+        if (SYSTEM_ABSTRACTIONS_DIAGNOSTIC_ENABLED(sender, level)) { \
+            (sender).SendDiagnosticInformationString((level), (message)); \
+        } \
+    } while (false)
+
+/**
+ * This publishes a diagnostic message from the given sender, formatted
+ * according to the rules and capabilities of the C standard library
+ * function "sprintf", without evaluating the arguments at all unless
+ * the message would be delivered to a subscriber.
+ *
+ * @param[in] sender
+ *     This is the sender from which to publish the message.
+ *
+ * @param[in] level
+ *     This is used to filter out less-important information.
+ *     The level is higher the more important the information is.
+ *
+ * @param[in] ...
+ *     These are the formatting string and the arguments to use
+ *     to build the message.
+ */
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(sender, level, ...) \
+    do { \
+        if (SYSTEM_ABSTRACTIONS_DIAGNOSTIC_ENABLED(sender, level)) { \
+            (sender).SendDiagnosticInformationFormatted((level), __VA_ARGS__); \
+        } \
+    } while (false)
+
+/**
+ * This publishes a diagnostic message from the given sender, built
+ * by calling the given function, which is only called (and the
+ * function object itself is only made) if the message would
+ * be delivered to a subscriber.
+ *
+ * @param[in] sender
+ *     This is the sender from which to publish the message.
+ *
+ * @param[in] level
+ *     This is used to filter out less-important information.
+ *     The level is higher the more important the information is.
+ *
+ * @param[in] ...
+ *     This is the function to call to build the message.
+ *     It must return something convertible to std::string.
+ *     (It's taken as variable arguments so that commas in
+ *     a lambda's capture list don't split it.)
+ */
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTIC_LAZY(sender, level, ...) \
+    do { \
+        if ((size_t)(level) >= SystemAbstractions::DIAGNOSTICS_COMPILED_MIN_LEVEL) { \
+            (sender).SendDiagnosticInformationLazy((level), __VA_ARGS__); \
+        } \
+    } while (false)
+
 namespace SystemAbstractions {
 
+    /**
+     * This is the lowest level of diagnostic message kept in the
+     * program when published through the diagnostic macros.  It's
+     * compared against instead of the preprocessor definition
+     * so that the comparison isn't flagged as always true when
+     * the definition is zero.
+     */
+    constexpr size_t DIAGNOSTICS_COMPILED_MIN_LEVEL = SYSTEM_ABSTRACTIONS_DIAGNOSTICS_COMPILED_MIN_LEVEL;
+
     /**
      * This represents an object that sends diagnostic information
      * to other objects.
@@ -63,6 +175,43 @@ namespace SystemAbstractions {
             )
         > DiagnosticMessageDelegate;
 
+        /**
+         * This is the type of function given when subscribing
+         * to diagnostic messages in raw form, and called to deliver
+         * any diagnostic messages published while the subscription lasts.
+         * Messages are delivered before they're formatted, so that
+         * subscribers can format them later, or not at all.
+         *
+         * @param[in] senderName
+         *     This identifies the origin of the diagnostic information.
+         *
+         * @param[in] level
+         *     This is used to filter out less-important information.
+         *     The higher the level, the more important the information is.
+         *
+         * @param[in] contextPrefix
+         *     This is the contextual information to put in front
+         *     of the message once it's formatted.
+         *
+         * @param[in] format
+         *     This is the formatting string to use as a guide to build
+         *     the message, according to the rules and capabilities of
+         *     the C standard library function "sprintf".  Messages
+         *     published as strings are delivered with the format "%s".
+         *
+         * @param[in] args
+         *     These are the arguments to use to build the message.
+         */
+        typedef std::function<
+            void(
+                const std::string& senderName,
+                size_t level,
+                const std::string& contextPrefix,
+                const char* format,
+                va_list args
+            )
+        > DiagnosticRawMessageDelegate;
+
         // Lifecycle Management
     public:
         ~DiagnosticsSender() noexcept;
@@ -103,6 +252,28 @@ namespace SystemAbstractions {
             size_t minLevel = 0
         );
 
+        /**
+         * This method forms a new subscription to diagnostic messages
+         * published by the sender, to be delivered before they're
+         * formatted.
+         *
+         * @param[in] delegate
+         *     This is the function to call to deliver messages
+         *     to this subscriber.
+         *
+         * @param[in] minLevel
+         *     This is the minimum level of message that this subscriber
+         *     desires to receive.
+         *
+         * @return
+         *     A function is returned which may be called
+         *     to terminate the subscription.
+         */
+        UnsubscribeDelegate SubscribeToRawDiagnostics(
+            DiagnosticRawMessageDelegate delegate,
+            size_t minLevel = 0
+        );
+
         /**
          * This method returns a function which can be used to subscribe
          * the sender to diagnostic messages published by another sender,
@@ -142,6 +313,10 @@ namespace SystemAbstractions {
          * according to the rules and capabilities of the C standard library
          * function "sprintf".
          *
+         * The message is only formatted if there are subscribers
+         * (other than raw subscribers) desiring to receive it,
+         * and then only once.
+         *
          * @param[in] level
          *     This is used to filter out less-important information.
          *     The level is higher the more important the information is.
@@ -152,19 +327,52 @@ namespace SystemAbstractions {
          */
         void SendDiagnosticInformationFormatted(size_t level, const char* format, ...) const;
 
+        /**
+         * This method publishes a diagnostic message built by calling
+         * the given function, but only if there are subscribers desiring
+         * to receive it, so that the cost of building the message
+         * is not paid otherwise.
+         *
+         * @param[in] level
+         *     This is used to filter out less-important information.
+         *     The level is higher the more important the information is.
+         *
+         * @param[in] buildMessage
+         *     This is the function to call to build the message.
+         *     It must return something convertible to std::string.
+         */
+        template< typename MessageBuilder > void SendDiagnosticInformationLazy(
+            size_t level,
+            MessageBuilder&& buildMessage
+        ) const {
+            if (level >= GetMinLevel()) {
+                SendDiagnosticInformationString(level, buildMessage());
+            }
+        }
+
         /**
          * This method adds the given string onto the top of the contextual
          * information stack for the sender.
          *
+         * Each thread has its own contextual information stack for
+         * each sender, which only affects messages published by that
+         * thread.  Pushing and popping never takes a lock, and doesn't
+         * allocate memory once the thread has pushed contexts of similar
+         * size onto the sender before.  Contexts a thread leaves pushed
+         * are thrown away when that thread destroys the sender,
+         * or else when the thread exits.  Contexts pushed after that,
+         * such as from the destructor of a thread-local object,
+         * are ignored.
+         *
          * @param[in] context
          *     This is the string to push onto the contextural
          *     information stack.
          */
-        void PushContext(std::string context);
+        void PushContext(const std::string& context);
 
         /**
          * This method removes the top string off of the contextual
-         * information stack.
+         * information stack of the current thread for the sender.
          */
         void PopContext();
 
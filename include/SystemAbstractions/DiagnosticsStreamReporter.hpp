@@ -11,6 +11,8 @@
 
 #include "DiagnosticsSender.hpp"
 
+#include <memory>
+#include <stddef.h>
 #include <stdio.h>
 
 namespace SystemAbstractions {
@@ -36,6 +38,128 @@ namespace SystemAbstractions {
         FILE* error
     );
 
+    /**
+     * This class formats and prints received diagnostic messages
+     * to log files, in the same way as the delegate returned by the
+     * DiagnosticsStreamReporter function, except that the printing
+     * is done by a thread of its own, so that threads publishing
+     * messages are never held up by slow log files.
+     *
+     * Messages are formatted by the publishing thread and placed in
+     * a fixed-size queue.  The reporter's thread takes them out in
+     * batches and writes each batch with as few system calls as
+     * possible.
+     *
+     * All messages queued are written before the reporter is destroyed,
+     * or before the program exits, whichever comes first.
+     */
+    class AsyncDiagnosticsStreamReporter {
+        // Types
+    public:
+        /**
+         * These are the different things which can be done
+         * with a message published while the queue is full.
+         */
+        enum class OverflowPolicy {
+            /**
+             * The publishing thread waits until there is room
+             * in the queue for the message.
+             */
+            Block,
+
+            /**
+             * The oldest message in the queue is thrown away
+             * to make room for the new one.
+             */
+            DropOldest,
+
+            /**
+             * The new message is thrown away.
+             */
+            DropNewest,
+        };
+
+        // Lifecycle Management
+    public:
+        ~AsyncDiagnosticsStreamReporter() noexcept;
+        AsyncDiagnosticsStreamReporter(const AsyncDiagnosticsStreamReporter&) = delete;
+        AsyncDiagnosticsStreamReporter(AsyncDiagnosticsStreamReporter&&) noexcept;
+        AsyncDiagnosticsStreamReporter& operator=(const AsyncDiagnosticsStreamReporter&) = delete;
+        AsyncDiagnosticsStreamReporter& operator=(AsyncDiagnosticsStreamReporter&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the constructor.
+         *
+         * @param[in] output
+         *     This is the file to which to print all diagnostic messages
+         *     with levels that are under the "Levels::WARNING" level
+         *     informally defined in the DiagnosticsSender class.
+         *
+         * @param[in] error
+         *     This is the file to which to print all diagnostic messages
+         *     with levels that are at or over the "Levels::WARNING" level
+         *     informally defined in the DiagnosticsSender class.
+         *
+         * @param[in] queueCapacity
+         *     This is the minimum number of messages which can be
+         *     waiting to be printed at once.
+         *
+         * @param[in] overflowPolicy
+         *     This selects what to do with a message published
+         *     while the queue is full.
+         */
+        AsyncDiagnosticsStreamReporter(
+            FILE* output,
+            FILE* error,
+            size_t queueCapacity = 4096,
+            OverflowPolicy overflowPolicy = OverflowPolicy::Block
+        );
+
+        /**
+         * This method returns a delegate which can be used to subscribe
+         * the reporter to diagnostic messages.  The delegate does
+         * nothing once the reporter is destroyed.
+         *
+         * @return
+         *     A delegate which can be used to subscribe the reporter
+         *     to diagnostic messages is returned.
+         */
+        DiagnosticsSender::DiagnosticMessageDelegate GetDelegate() const;
+
+        /**
+         * This method blocks until all messages published before
+         * it was called have been printed and flushed.
+         */
+        void Flush();
+
+        /**
+         * This method returns the number of messages thrown away
+         * because the queue was full, or because they could not be
+         * written to the log file.  A warning is also printed
+         * whenever this number goes up.
+         *
+         * @return
+         *     The number of messages thrown away is returned.
+         */
+        size_t GetDroppedCount() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
 }
 
 #endif /* SYSTEM_ABSTRACTIONS_DIAGNOSTICS_STREAM_REPORTER_HPP */
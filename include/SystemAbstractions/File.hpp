@@ -12,8 +12,12 @@
 #include "IFile.hpp"
 #include "IFileSystemEntry.hpp"
 
+#include <functional>
 #include <memory>
+#include <stddef.h>
+#include <stdint.h>
 #include <string>
+#include <time.h>
 #include <vector>
 
 namespace SystemAbstractions {
@@ -21,8 +25,217 @@ namespace SystemAbstractions {
     /**
      * This class represents a file accessed through the
      * native operating system.
+     *
+     * @note
+     *     On Windows, the ReadAt and WriteAt methods read and write at
+     *     the given position, but the operating system still moves the
+     *     file pointer, so they put the current position back afterwards.
+     *     Calling them from more than one thread at once, or while
+     *     another thread uses the current position, is safe for the
+     *     data but may leave the current position wrong.
      */
     class File: public IFileSystemEntry {
+        // Types
+    public:
+        /**
+         * This is the type of function called when an asynchronous
+         * file operation is complete.
+         *
+         * @param[in] success
+         *     This indicates whether or not the operation succeeded.
+         *
+         * @param[in] amount
+         *     This is the number of bytes read or written.
+         */
+        typedef std::function< void(bool success, size_t amount) > AsyncCompletionDelegate;
+
+        /**
+         * These are the different ways data written to a file can be
+         * made durable by the Sync method, trading throughput against
+         * how much survives a crash or power failure.
+         */
+        enum class SyncMode {
+            /**
+             * Nothing is done; the operating system writes the data
+             * back to storage whenever it sees fit.
+             */
+            None,
+
+            /**
+             * The operating system is asked to start writing the data
+             * back to storage, without waiting for it to finish,
+             * and without writing back metadata such as the file size.
+             * Where this isn't supported, the Data mode is used instead.
+             */
+            StartWriteback,
+
+            /**
+             * The data, and only as much metadata as is needed to read
+             * it back (such as the file size), are written to storage
+             * before returning.
+             */
+            Data,
+
+            /**
+             * The data and all metadata are written to storage before
+             * returning.  Where the operating system supports it,
+             * the storage device is also told to flush its own cache.
+             */
+            Full,
+        };
+
+        /**
+         * This represents one entry in a directory, as it's being
+         * visited by the VisitDirectory method.
+         *
+         * The name and type of the entry come from the directory itself.
+         * The size and last modified time are only looked up if asked for,
+         * and then only once.
+         *
+         * @note
+         *     An entry is only valid during the call to the visitor
+         *     to which it's given.
+         */
+        class DirectoryEntry {
+            // Types
+        public:
+            /**
+             * These are the different kinds of things which can be
+             * found in a directory.
+             */
+            enum class Type {
+                /**
+                 * The type of the entry could not be determined.
+                 */
+                Unknown,
+
+                /**
+                 * The entry is a regular file.
+                 */
+                File,
+
+                /**
+                 * The entry is a directory.
+                 */
+                Directory,
+
+                /**
+                 * The entry is a symbolic link (which is not followed).
+                 */
+                SymbolicLink,
+
+                /**
+                 * The entry is something else, such as a device,
+                 * pipe, or socket.
+                 */
+                Other,
+            };
+
+            // Lifecycle management
+        public:
+            virtual ~DirectoryEntry() noexcept {}
+
+            // Public methods
+        public:
+            /**
+             * This method returns the name of the entry, not including
+             * the path to the directory containing it.
+             *
+             * @return
+             *     The name of the entry is returned.
+             */
+            virtual const std::string& GetName() const = 0;
+
+            /**
+             * This method returns the type of the entry.
+             *
+             * @return
+             *     The type of the entry is returned.
+             */
+            virtual Type GetType() const = 0;
+
+            /**
+             * This method returns the size of the entry, in bytes.
+             *
+             * @return
+             *     The size of the entry, in bytes, is returned.
+             *
+             * @retval 0
+             *     This is returned if the size could not be determined.
+             */
+            virtual uint64_t GetSize() const = 0;
+
+            /**
+             * This method returns the time the entry was last modified.
+             *
+             * @return
+             *     The time the entry was last modified is returned.
+             *
+             * @retval 0
+             *     This is returned if the time could not be determined.
+             */
+            virtual time_t GetLastModifiedTime() const = 0;
+        };
+
+        /**
+         * This is the type of function called for each entry
+         * in a directory by the VisitDirectory method.
+         *
+         * @param[in] entry
+         *     This is the directory entry being visited.
+         *
+         * @return
+         *     A flag indicating whether or not to continue on
+         *     to the next entry is returned.
+         */
+        typedef std::function< bool(const DirectoryEntry& entry) > DirectoryVisitor;
+
+        /**
+         * This summarizes what happened when a directory tree was
+         * deleted or copied.
+         *
+         * When something in the tree can't be deleted or copied,
+         * the rest of the tree is still processed, as far as possible.
+         */
+        struct DirectoryOperationResult {
+            /**
+             * This is the number of files (including symbolic links
+             * and other entries which aren't directories) deleted
+             * or copied.
+             */
+            size_t filesProcessed = 0;
+
+            /**
+             * This is the number of directories deleted or copied,
+             * including the top one.
+             */
+            size_t directoriesProcessed = 0;
+
+            /**
+             * This is the number of entries which could not
+             * be deleted or copied.
+             */
+            size_t failures = 0;
+
+            /**
+             * If any entries could not be deleted or copied, this is
+             * the path of the first one found, for use in reporting.
+             */
+            std::string firstFailurePath;
+
+            /**
+             * This indicates whether or not the whole tree was
+             * deleted or copied successfully.
+             *
+             * @return
+             *     An indication of whether or not the whole tree was
+             *     deleted or copied successfully is returned.
+             */
+            explicit operator bool() const {
+                return (failures == 0);
+            }
+        };
+
         // Lifecycle Management
     public:
         ~File() noexcept;
@@ -135,6 +348,29 @@ namespace SystemAbstractions {
          */
         static void ListDirectory(const std::string& directory, std::vector< std::string >& list);
 
+        /**
+         * This method calls the given visitor for each entry in a
+         * directory, one at a time as they're read from the directory,
+         * without building a list of them.  The "." and ".." entries
+         * are skipped.
+         *
+         * @param[in] directory
+         *     This is the directory to visit.
+         *
+         * @param[in] visitor
+         *     This is the function to call for each entry in the directory.
+         *     If it returns false, no further entries are visited.
+         *
+         * @return
+         *     A flag indicating whether or not the directory could
+         *     be opened and read is returned.  Stopping early because
+         *     the visitor returned false is not considered a failure.
+         */
+        static bool VisitDirectory(
+            const std::string& directory,
+            DirectoryVisitor visitor
+        );
+
         /**
          * This method creates a directory if it doesn't already exist.
          *
@@ -150,18 +386,49 @@ namespace SystemAbstractions {
         /**
          * This method deletes a directory and all its contents.
          *
+         * Subdirectories are deleted in parallel, by a pool of threads.
+         * Deleting a directory which doesn't exist is considered
+         * a success.
+         *
          * @param[in] directory
          *     This is the directory to delete.
          *
          * @return
-         *     A flag indicating whether or not the method succeeded
-         *     is returned.
+         *     A flag indicating whether or not the whole directory
+         *     was deleted is returned.
          */
         static bool DeleteDirectory(const std::string& directory);
 
+        /**
+         * This method deletes a directory and all its contents,
+         * and summarizes what was deleted, and what couldn't be.
+         *
+         * Subdirectories are deleted in parallel, by a pool of threads.
+         * Deleting a directory which doesn't exist is considered
+         * a success.
+         *
+         * @param[in] directory
+         *     This is the directory to delete.
+         *
+         * @param[out] result
+         *     This is where to put the summary of what was deleted,
+         *     and what couldn't be.
+         *
+         * @return
+         *     A flag indicating whether or not the whole directory
+         *     was deleted is returned.
+         */
+        static bool DeleteDirectory(
+            const std::string& directory,
+            DirectoryOperationResult& result
+        );
+
         /**
          * This method copies a directory and all its contents.
          *
+         * Subdirectories and files are copied in parallel,
+         * by a pool of threads.
+         *
          * @param[in] existingDirectory
          *     This is the directory to copy.
          *
@@ -169,14 +436,41 @@ namespace SystemAbstractions {
          *     This is the destination to which to copy the existing directory.
          *
          * @return
-         *     A flag indicating whether or not the method succeeded
-         *     is returned.
+         *     A flag indicating whether or not the whole directory
+         *     was copied is returned.
          */
         static bool CopyDirectory(
             const std::string& existingDirectory,
             const std::string& newDirectory
         );
 
+        /**
+         * This method copies a directory and all its contents,
+         * and summarizes what was copied, and what couldn't be.
+         *
+         * Subdirectories and files are copied in parallel,
+         * by a pool of threads.
+         *
+         * @param[in] existingDirectory
+         *     This is the directory to copy.
+         *
+         * @param[in] newDirectory
+         *     This is the destination to which to copy the existing directory.
+         *
+         * @param[out] result
+         *     This is where to put the summary of what was copied,
+         *     and what couldn't be.
+         *
+         * @return
+         *     A flag indicating whether or not the whole directory
+         *     was copied is returned.
+         */
+        static bool CopyDirectory(
+            const std::string& existingDirectory,
+            const std::string& newDirectory,
+            DirectoryOperationResult& result
+        );
+
         /**
          * This method returns a list of directories that are considered
          * the root directories in the filesystem.  For example, in
@@ -204,6 +498,151 @@ namespace SystemAbstractions {
          */
         static void SetWorkingDirectory(const std::string& workingDirectory);
 
+        /**
+         * This method starts reading a region of the file starting at
+         * the given position, without using or changing the current
+         * position in the file, and returns without waiting for it
+         * to finish.
+         *
+         * @note
+         *     The file must stay open, and the buffer must remain valid,
+         *     until the completion delegate is called.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to read.
+         *
+         * @param[out] buffer
+         *     This is where to put the bytes read from the file.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to read from the file.
+         *
+         * @param[in] completionDelegate
+         *     This is the function to call when the read is complete.
+         *     It's called from a worker thread, so it should not
+         *     block for long.
+         */
+        void ReadAtAsync(
+            uint64_t position,
+            void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        );
+
+        /**
+         * This method starts writing a region of the file starting at
+         * the given position, without using or changing the current
+         * position in the file, and returns without waiting for it
+         * to finish.
+         *
+         * @note
+         *     The file must stay open, and the buffer must remain valid,
+         *     until the completion delegate is called.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to write.
+         *
+         * @param[in] buffer
+         *     This is where to fetch the bytes to write to the file.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to write to the file.
+         *
+         * @param[in] completionDelegate
+         *     This is the function to call when the write is complete.
+         *     It's called from a worker thread, so it should not
+         *     block for long.
+         */
+        void WriteAtAsync(
+            uint64_t position,
+            const void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        );
+
+        /**
+         * This method starts flushing all data written to the file to
+         * the storage device holding it, and returns without waiting
+         * for it to finish.
+         *
+         * @note
+         *     The file must stay open until the completion delegate
+         *     is called.
+         *
+         * @param[in] completionDelegate
+         *     This is the function to call when the flush is complete.
+         *     It's called from a worker thread, so it should not
+         *     block for long.
+         */
+        void SyncAsync(AsyncCompletionDelegate completionDelegate);
+
+        /**
+         * This method reserves storage for a region of the file, so that
+         * writing it later doesn't fail for lack of space, and the file
+         * is laid out in as few pieces as possible.  Any data already in
+         * the region is left as is.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte
+         *     of the region.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes in the region.
+         *
+         * @param[in] changeSize
+         *     This indicates whether or not to extend the size of
+         *     the file to include the region, if it doesn't already.
+         *     If not, the storage is reserved beyond the end of the
+         *     file, ready for data to be appended to it.
+         *
+         * @return
+         *     A flag indicating whether or not the storage was
+         *     reserved is returned.  This fails if the file system
+         *     doesn't support reserving storage.
+         */
+        bool Preallocate(
+            uint64_t position,
+            uint64_t numBytes,
+            bool changeSize = false
+        );
+
+        /**
+         * This method releases the storage used by a region of the file,
+         * which afterwards reads back as zeroes.  The size of the file
+         * is not changed.
+         *
+         * @note
+         *     File systems may only release whole blocks, zeroing
+         *     the rest of the region instead.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte
+         *     of the region.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes in the region.
+         *
+         * @return
+         *     A flag indicating whether or not the storage was
+         *     released is returned.  This fails if the file system
+         *     doesn't support sparse files.
+         */
+        bool PunchHole(uint64_t position, uint64_t numBytes);
+
+        /**
+         * This method makes data written to the file durable,
+         * in the given way.
+         *
+         * @param[in] mode
+         *     This selects what is written back to storage, and
+         *     whether or not to wait for it.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool Sync(SyncMode mode = SyncMode::Full);
+
         // IFileSystemEntry
     public:
         virtual bool IsExisting() override;
@@ -229,6 +668,8 @@ namespace SystemAbstractions {
         virtual size_t Read(void* buffer, size_t numBytes) override;
         virtual size_t Write(const Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override;
         virtual size_t Write(const void* buffer, size_t numBytes) override;
+        virtual size_t ReadAt(uint64_t position, void* buffer, size_t numBytes) const override;
+        virtual size_t WriteAt(uint64_t position, const void* buffer, size_t numBytes) override;
         virtual std::shared_ptr< IFile > Clone() override;
 
         // Private properties
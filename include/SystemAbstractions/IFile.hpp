@@ -173,6 +173,75 @@ namespace SystemAbstractions {
          */
         virtual size_t Write(const void* buffer, size_t numBytes) = 0;
 
+        /**
+         * This method reads a region of the file starting at the given
+         * position, without using or changing the current position
+         * in the file.
+         *
+         * Since the current position is left alone, any number of
+         * threads may call this method on the same file object at once,
+         * as long as the implementation doesn't say otherwise.
+         *
+         * @note
+         *     The default implementation moves the current position to
+         *     the region, peeks at it, and then moves the position back,
+         *     for implementations which have no way to read without
+         *     moving it.  It is not safe to call from more than one
+         *     thread at once.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to read.
+         *
+         * @param[out] buffer
+         *     This is where to put the bytes read from the file.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to read from the file.
+         *
+         * @return
+         *     The number of bytes actually read is returned.
+         */
+        virtual size_t ReadAt(uint64_t position, void* buffer, size_t numBytes) const {
+            const auto self = const_cast< IFile* >(this);
+            const auto originalPosition = GetPosition();
+            self->SetPosition(position);
+            const auto amountRead = Peek(buffer, numBytes);
+            self->SetPosition(originalPosition);
+            return amountRead;
+        }
+
+        /**
+         * This method writes a region of the file starting at the given
+         * position, without using or changing the current position
+         * in the file.
+         *
+         * @note
+         *     The default implementation moves the current position to
+         *     the region, writes it, and then moves the position back,
+         *     for implementations which have no way to write without
+         *     moving it.  It is not safe to call from more than one
+         *     thread at once.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to write.
+         *
+         * @param[in] buffer
+         *     This is where to fetch the bytes to write to the file.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to write to the file.
+         *
+         * @return
+         *     The number of bytes actually written is returned.
+         */
+        virtual size_t WriteAt(uint64_t position, const void* buffer, size_t numBytes) {
+            const auto originalPosition = GetPosition();
+            SetPosition(position);
+            const auto amountWritten = Write(buffer, numBytes);
+            SetPosition(originalPosition);
+            return amountWritten;
+        }
+
         /**
          * This method creates a new file object which operates on
          * the same file but has its own current file position.
@@ -11,6 +11,7 @@
 
 #include "DiagnosticsSender.hpp"
 
+#include <functional>
 #include <memory>
 #include <stdint.h>
 #include <vector>
@@ -36,6 +37,21 @@ namespace SystemAbstractions {
             void(const std::vector< uint8_t >& message)
         > MessageReceivedDelegate;
 
+        /**
+         * This is the type of callback issued whenever more data
+         * is received from the peer of the connection, handing over
+         * the buffer holding the data rather than lending it.
+         *
+         * @param[in] message
+         *     This holds the data received from the peer of the
+         *     connection.  The receiver may keep it, or pass it along
+         *     to other threads, for as long as it likes.  Once no longer
+         *     referenced, its memory may be reused to receive more data.
+         */
+        typedef std::function<
+            void(std::shared_ptr< std::vector< uint8_t > > message)
+        > MessageBufferReceivedDelegate;
+
         /**
          * This is the type of callback issued whenever
          * the connection is broken.
@@ -106,6 +122,43 @@ namespace SystemAbstractions {
             BrokenDelegate brokenDelegate
         ) = 0;
 
+        /**
+         * This method starts message processing on the connection,
+         * listening for incoming messages and sending outgoing messages,
+         * handing over the buffers holding received data to the caller,
+         * so that it can keep the data without copying it.
+         *
+         * @note
+         *     The default implementation copies the data into a new
+         *     buffer, for implementations which have no way to
+         *     hand over the buffers they receive into.
+         *
+         * @param[in] messageBufferReceivedDelegate
+         *     This is the callback issued whenever more data
+         *     is received from the peer of the connection.
+         *
+         * @param[in] brokenDelegate
+         *     This is the callback issued whenever
+         *     the connection is broken.
+         *
+         * @return
+         *     An indication of whether or not the method was
+         *     successful is returned.
+         */
+        virtual bool Process(
+            MessageBufferReceivedDelegate messageBufferReceivedDelegate,
+            BrokenDelegate brokenDelegate
+        ) {
+            return Process(
+                [messageBufferReceivedDelegate](const std::vector< uint8_t >& message){
+                    messageBufferReceivedDelegate(
+                        std::make_shared< std::vector< uint8_t > >(message)
+                    );
+                },
+                brokenDelegate
+            );
+        }
+
         /**
          * This method returns the IPv4 address of the peer, if there
          * is a connection established.
@@ -167,6 +220,57 @@ namespace SystemAbstractions {
          */
         virtual void SendMessage(const std::vector< uint8_t >& message) = 0;
 
+        /**
+         * This method appends the given data to the queue of data
+         * currently being sent to the peer, taking ownership of the
+         * data rather than copying it.  The actual sending
+         * is performed by the processor worker thread.
+         *
+         * @note
+         *     The default implementation copies the data, for
+         *     implementations which have no way to take ownership of it.
+         *
+         * @note
+         *     A derived class which overrides only some of the
+         *     SendMessage overloads hides the others, so it should
+         *     bring them back into scope with
+         *     "using INetworkConnection::SendMessage;".
+         *
+         * @param[in] message
+         *     This holds the data to be appended to the send queue.
+         */
+        virtual void SendMessage(std::vector< uint8_t >&& message) {
+            SendMessage(static_cast< const std::vector< uint8_t >& >(message));
+        }
+
+        /**
+         * This method appends the given shared data to the queue of data
+         * currently being sent to the peer, without copying it, so that
+         * the same data may be sent to many peers cheaply.  The data
+         * must not be modified after this call.  The actual sending
+         * is performed by the processor worker thread.
+         *
+         * @note
+         *     The default implementation copies the data, for
+         *     implementations which have no way to share it.
+         *
+         * @note
+         *     A derived class which overrides only some of the
+         *     SendMessage overloads hides the others, so it should
+         *     bring them back into scope with
+         *     "using INetworkConnection::SendMessage;".
+         *
+         * @param[in] message
+         *     This holds the data to be appended to the send queue.
+         *     If this is null, nothing is sent.
+         */
+        virtual void SendMessage(std::shared_ptr< const std::vector< uint8_t > > message) {
+            if (message == nullptr) {
+                return;
+            }
+            SendMessage(*message);
+        }
+
         /**
          * This method breaks the connection to the peer.
          *
@@ -0,0 +1,170 @@
+#ifndef SYSTEM_ABSTRACTIONS_MAPPED_FILE_HPP
+#define SYSTEM_ABSTRACTIONS_MAPPED_FILE_HPP
+
+/**
+ * @file MappedFile.hpp
+ *
+ * This module declares the SystemAbstractions::MappedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "IFile.hpp"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class represents a file accessed through the native operating
+     * system by mapping its contents into the address space of the
+     * process.  Reading and writing the file is done by copying
+     * memory rather than making system calls, and the contents may
+     * also be accessed directly, without copying them at all.
+     *
+     * This suits large files which are mostly read, especially
+     * when they're scanned through in small pieces.
+     *
+     * When the file is written past its end, the mapping grows
+     * geometrically, so while the file is open for writing, it may be
+     * larger on disk than it appears through this class.  The extra
+     * bytes are cut off when the file is closed or cloned.
+     */
+    class MappedFile: public IFile {
+        // Types
+    public:
+        /**
+         * This represents a contiguous range of the contents of the
+         * file, which may be accessed directly without copying it.
+         */
+        struct Range {
+            /**
+             * This points to the first byte of the range.
+             */
+            const uint8_t* data;
+
+            /**
+             * This is the number of bytes in the range.
+             */
+            size_t size;
+        };
+
+        // Lifecycle Management
+    public:
+        ~MappedFile() noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the instance constructor.
+         *
+         * @param[in] path
+         *     This is the path to the file in the file system.
+         */
+        MappedFile(std::string path);
+
+        /**
+         * This method returns the path to the file in the file system.
+         *
+         * @return
+         *     The path to the file in the file system is returned.
+         */
+        std::string GetPath() const;
+
+        /**
+         * This method opens the file and maps it for reading only.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool OpenReadOnly();
+
+        /**
+         * This method opens the file, creating it if it doesn't
+         * already exist, and maps it for reading and writing.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool OpenReadWrite();
+
+        /**
+         * This method unmaps and closes the file.
+         */
+        void Close();
+
+        /**
+         * This method provides direct access to the given range of the
+         * contents of the file, without copying it.  Less than the
+         * requested number of bytes may be provided, if the range
+         * extends past the end of the file.
+         *
+         * @note
+         *     The range provided is only valid until the file is
+         *     closed or its size is changed.
+         *
+         * @param[in] offset
+         *     This is the offset from the beginning of the file
+         *     of the first byte of the range.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes in the range.
+         *
+         * @return
+         *     The requested range of the contents of the file is returned.
+         *     Its size is zero if the file isn't open or the offset
+         *     is at or past the end of the file.
+         */
+        Range GetRange(uint64_t offset, size_t numBytes) const;
+
+        // IFile
+    public:
+        virtual uint64_t GetSize() const override;
+        virtual bool SetSize(uint64_t size) override;
+        virtual uint64_t GetPosition() const override;
+        virtual void SetPosition(uint64_t position) override;
+        virtual size_t Peek(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) const override;
+        virtual size_t Peek(void* buffer, size_t numBytes) const override;
+        virtual size_t Read(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override;
+        virtual size_t Read(void* buffer, size_t numBytes) override;
+        virtual size_t Write(const Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override;
+        virtual size_t Write(const void* buffer, size_t numBytes) override;
+        virtual size_t ReadAt(uint64_t position, void* buffer, size_t numBytes) const override;
+        virtual size_t WriteAt(uint64_t position, const void* buffer, size_t numBytes) override;
+        virtual std::shared_ptr< IFile > Clone() override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This is the type of structure that contains the platform-specific
+         * private properties of the instance.  It is defined in the
+         * platform-specific part of the implementation and declared here to
+         * ensure that it is scoped inside the class.
+         */
+        struct Platform;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_MAPPED_FILE_HPP */
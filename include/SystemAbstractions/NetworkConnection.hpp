@@ -13,6 +13,7 @@
 #include "INetworkConnection.hpp"
 
 #include <memory>
+#include <stddef.h>
 #include <stdint.h>
 #include <vector>
 
@@ -42,6 +43,27 @@ namespace SystemAbstractions {
          */
         struct Platform;
 
+        /**
+         * These are the different ways in which network connections
+         * can be processed.
+         */
+        enum class ProcessingModel {
+            /**
+             * In this model, each connection has its own worker thread
+             * which sends and receives data for that connection only.
+             */
+            ThreadPerConnection,
+
+            /**
+             * In this model, all connections share a small fixed pool
+             * of worker threads, each waiting on many connections at once.
+             * Delegates are called from these shared threads, so they
+             * should not block for long, since that would hold up
+             * other connections.
+             */
+            SharedEventLoop,
+        };
+
         // Lifecycle Management
     public:
         ~NetworkConnection() noexcept;
@@ -71,6 +93,33 @@ namespace SystemAbstractions {
          */
         static uint32_t GetAddressOfHost(const std::string& host);
 
+        /**
+         * This is a helper free function which selects how network
+         * connections are processed.  The selection applies to all
+         * connections which start processing after the call, including
+         * those made by network endpoints for connecting clients.
+         * Connections already processing are unaffected.
+         *
+         * @param[in] processingModel
+         *     This is the way in which network connections
+         *     should be processed.
+         *
+         * @param[in] numThreads
+         *     This is the number of worker threads to use for
+         *     the shared event loop model.  If zero, the number of
+         *     hardware threads of the host machine is used.
+         *
+         * @return
+         *     An indication of whether or not the given processing model
+         *     was selected is returned.  If not, because the model
+         *     isn't supported on this platform or its resources could
+         *     not be acquired, the thread-per-connection model is used.
+         */
+        static bool SetProcessingModel(
+            ProcessingModel processingModel,
+            size_t numThreads = 0
+        );
+
         // INetworkConnection
     public:
         virtual DiagnosticsSender::UnsubscribeDelegate SubscribeToDiagnostics(
@@ -82,12 +131,18 @@ namespace SystemAbstractions {
             MessageReceivedDelegate messageReceivedDelegate,
             BrokenDelegate brokenDelegate
         ) override;
+        virtual bool Process(
+            MessageBufferReceivedDelegate messageBufferReceivedDelegate,
+            BrokenDelegate brokenDelegate
+        ) override;
         virtual uint32_t GetPeerAddress() const override;
         virtual uint16_t GetPeerPort() const override;
         virtual bool IsConnected() const override;
         virtual uint32_t GetBoundAddress() const override;
         virtual uint16_t GetBoundPort() const override;
         virtual void SendMessage(const std::vector< uint8_t >& message) override;
+        virtual void SendMessage(std::vector< uint8_t >&& message) override;
+        virtual void SendMessage(std::shared_ptr< const std::vector< uint8_t > > message) override;
         virtual void Close(bool clean = false) override;
 
         // Private properties
@@ -12,6 +12,7 @@
 #include "DiagnosticsSender.hpp"
 #include "NetworkConnection.hpp"
 
+#include <functional>
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
@@ -57,6 +58,48 @@ namespace SystemAbstractions {
             )
         > PacketReceivedDelegate;
 
+        /**
+         * This represents one datagram-oriented message received by
+         * the network endpoint, as part of a batch.
+         */
+        struct ReceivedPacket {
+            /**
+             * This is the IPv4 address of the client who sent the message.
+             */
+            uint32_t address;
+
+            /**
+             * This is the port number of the client who sent the message.
+             */
+            uint16_t port;
+
+            /**
+             * This points to the contents of the datagram sent by the
+             * client.  It's only valid during the callback in which
+             * the packet is delivered.
+             */
+            const uint8_t* body;
+
+            /**
+             * This is the number of bytes in the datagram sent by
+             * the client.
+             */
+            size_t bodySize;
+        };
+
+        /**
+         * This is the type of callback function to be called whenever
+         * one or more new datagram-oriented messages are received by
+         * the network endpoint, when it's configured to receive
+         * messages in batches.
+         *
+         * @param[in] packets
+         *     These are the datagrams received, in the order received.
+         */
+        typedef std::function<
+            void(const std::vector< ReceivedPacket >& packets)
+        > PacketsReceivedDelegate;
+
         /**
          * These are the different sets of behavior that can be
          * configured for a network endpoint.
@@ -124,6 +167,26 @@ namespace SystemAbstractions {
             size_t minLevel = 0
         );
 
+        /**
+         * This method sets the number of sockets the endpoint uses to
+         * listen for connections, when opened in connection mode.
+         * Where the operating system supports it, that many sockets
+         * are bound to the same port, and the operating system spreads
+         * incoming connections among them.  Each socket has its own
+         * thread accepting connections, so the new connection delegate
+         * may be called from more than one thread at the same time.
+         *
+         * Where the operating system doesn't support this, only one
+         * socket is used.
+         *
+         * This must be called before the Open method to take effect.
+         *
+         * @param[in] numListeners
+         *     This is the number of sockets to use to listen for
+         *     connections.  The default is one.
+         */
+        void SetNumListeners(size_t numListeners);
+
         /**
          * This method starts message or connection processing on the endpoint,
          * depending on the given mode.
@@ -174,6 +237,74 @@ namespace SystemAbstractions {
             uint16_t port
         );
 
+        /**
+         * This method starts message or connection processing on the endpoint,
+         * depending on the given mode, delivering any datagram-oriented
+         * messages received in batches, rather than one at a time.
+         * Where the operating system supports it, each batch is received
+         * with a single system call.
+         *
+         * @param[in] newConnectionDelegate
+         *     This is the callback function to be called whenever
+         *     a new client connects to the network endpoint.
+         *
+         * @param[in] packetsReceivedDelegate
+         *     This is the callback function to be called whenever
+         *     one or more new datagram-oriented messages are received by
+         *     the network endpoint.
+         *
+         * @param[in] mode
+         *     This selects the kind of processing to perform with
+         *     the endpoint.
+         *
+         * @param[in] localAddress
+         *     This is the address to use on the network for the endpoint.
+         *     It is only required for multicast send mode.  It is not
+         *     used at all for multicast receive mode, since in this mode
+         *     the socket requests membership in the multicast group on
+         *     all interfaces.  For datagram and connection modes, if an
+         *     address is specified, it limits the traffic to a single
+         *     interface.
+         *
+         * @param[in] groupAddress
+         *     This is the address to select for multicasting, if a multicast
+         *     mode is selected.
+         *
+         * @param[in] port
+         *     This is the port number to use on the network.  For multicast
+         *     modes, it is required and is the multicast port number.
+         *     For datagram and connection modes, it is optional, and if set,
+         *     specifies the local port number to bind; otherwise an
+         *     arbitrary ephemeral port is bound.
+         *
+         * @param[in] maxPacketsPerBatch
+         *     This is the maximum number of datagrams to deliver in
+         *     one batch.
+         *
+         * @param[in] maxPacketSize
+         *     This is the largest datagram, in bytes, expected to be
+         *     received.  Space for maxPacketsPerBatch datagrams of this
+         *     size is set aside while the endpoint is open, so it should
+         *     be no more than what the application actually sends
+         *     (for example, 1500 bytes for datagrams which fit in one
+         *     Ethernet frame).  Any larger datagram is cut short
+         *     to this size.  It can't be more than 65536.
+         *
+         * @return
+         *     An indication of whether or not the method was
+         *     successful is returned.
+         */
+        bool Open(
+            NewConnectionDelegate newConnectionDelegate,
+            PacketsReceivedDelegate packetsReceivedDelegate,
+            Mode mode,
+            uint32_t localAddress,
+            uint32_t groupAddress,
+            uint16_t port,
+            size_t maxPacketsPerBatch,
+            size_t maxPacketSize = 65536
+        );
+
         /**
          * This method returns the network port that the endpoint
          * has bound for its use.
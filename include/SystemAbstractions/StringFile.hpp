@@ -44,7 +44,9 @@ namespace SystemAbstractions {
          * This is an instance constructor.
          *
          * @param[in] initialValue
-         *     This is the initial contents of the file.
+         *     This is the initial contents of the file.  If it's
+         *     moved in, it becomes the contents of the file
+         *     without being copied.
          */
         StringFile(std::vector< uint8_t > initialValue);
 
@@ -68,6 +70,36 @@ namespace SystemAbstractions {
          */
         StringFile& operator=(const std::vector< uint8_t > &b);
 
+        /**
+         * This is the move assignment from std::vector< uint8_t > operator.
+         * The vector given becomes the contents of the file,
+         * without being copied.
+         */
+        StringFile& operator=(std::vector< uint8_t >&& b);
+
+        /**
+         * This method moves the contents of the file out of it,
+         * without copying them, leaving the file empty.
+         *
+         * @return
+         *     The former contents of the file are returned.
+         */
+        std::vector< uint8_t > Release();
+
+        /**
+         * This method provides direct access to the contents of the file,
+         * without copying them.  The number of bytes is given by
+         * the GetSize method.
+         *
+         * @note
+         *     The pointer returned is only valid until the file
+         *     is next modified.
+         *
+         * @return
+         *     A pointer to the first byte of the file is returned.
+         */
+        const uint8_t* GetData() const;
+
         /**
          * This method removes the given number of bytes from the front
          * of the string, and moves the file pointer back to either
@@ -92,6 +124,8 @@ namespace SystemAbstractions {
         virtual size_t Read(void* buffer, size_t numBytes) override;
         virtual size_t Write(const Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override;
         virtual size_t Write(const void* buffer, size_t numBytes) override;
+        virtual size_t ReadAt(uint64_t position, void* buffer, size_t numBytes) const override;
+        virtual size_t WriteAt(uint64_t position, const void* buffer, size_t numBytes) override;
         virtual std::shared_ptr< IFile > Clone() override;
 
         // Private properties
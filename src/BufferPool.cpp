@@ -0,0 +1,109 @@
+/**
+ * @file BufferPool.cpp
+ *
+ * This module contains the implementation of the
+ * SystemAbstractions::BufferPool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "BufferPool.hpp"
+
+#include <mutex>
+
+namespace SystemAbstractions {
+
+    /**
+     * This holds the private properties of the BufferPool class.
+     */
+    struct BufferPool::Impl {
+        // Properties
+
+        /**
+         * This is the number of bytes of memory to reserve
+         * in each new buffer.
+         */
+        size_t bufferCapacity = 0;
+
+        /**
+         * This is the maximum number of unused buffers to keep
+         * for reuse.
+         */
+        size_t maxBuffersPooled = 0;
+
+        /**
+         * These are the unused buffers held for reuse.
+         */
+        std::vector< std::unique_ptr< Buffer > > buffers;
+
+        /**
+         * This is used to synchronize access to the object.
+         */
+        std::mutex mutex;
+
+        // Methods
+
+        /**
+         * This method takes back a buffer which is no longer
+         * referenced by anyone, either keeping it for reuse or
+         * freeing it if the pool is full.
+         *
+         * @param[in] buffer
+         *     This is the buffer to take back.
+         */
+        void Release(Buffer* buffer) {
+            std::unique_ptr< Buffer > bufferOwner(buffer);
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (buffers.size() < maxBuffersPooled) {
+                buffers.push_back(std::move(bufferOwner));
+            }
+        }
+    };
+
+    BufferPool::~BufferPool() noexcept = default;
+    BufferPool::BufferPool(BufferPool&& other) noexcept = default;
+    BufferPool& BufferPool::operator=(BufferPool&& other) noexcept = default;
+
+    BufferPool::BufferPool(
+        size_t bufferCapacity,
+        size_t maxBuffersPooled
+    )
+        : impl_(new Impl())
+    {
+        impl_->bufferCapacity = bufferCapacity;
+        impl_->maxBuffersPooled = maxBuffersPooled;
+    }
+
+    auto BufferPool::Acquire() -> std::shared_ptr< Buffer > {
+        std::unique_ptr< Buffer > buffer;
+        {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            if (!impl_->buffers.empty()) {
+                buffer = std::move(impl_->buffers.back());
+                impl_->buffers.pop_back();
+            }
+        }
+        if (buffer == nullptr) {
+            buffer.reset(new Buffer());
+            buffer->reserve(impl_->bufferCapacity);
+        }
+        const std::weak_ptr< Impl > weakImpl(impl_);
+        return std::shared_ptr< Buffer >(
+            buffer.release(),
+            [weakImpl](Buffer* buffer){
+                const auto impl = weakImpl.lock();
+                if (impl == nullptr) {
+                    delete buffer;
+                } else {
+                    impl->Release(buffer);
+                }
+            }
+        );
+    }
+
+    size_t BufferPool::GetBuffersPooled() const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->buffers.size();
+    }
+
+}
@@ -0,0 +1,103 @@
+#ifndef SYSTEM_ABSTRACTIONS_BUFFER_POOL_HPP
+#define SYSTEM_ABSTRACTIONS_BUFFER_POOL_HPP
+
+/**
+ * @file BufferPool.hpp
+ *
+ * This module declares the SystemAbstractions::BufferPool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class keeps a supply of buffers of data which can be handed
+     * out and shared freely, and which come back to the pool to be
+     * reused, rather than having their memory freed, once they're
+     * no longer referenced.
+     *
+     * All methods are thread-safe, and buffers may be released from
+     * any thread, even after the pool itself is destroyed.
+     */
+    class BufferPool {
+        // Types
+    public:
+        /**
+         * This represents a buffer of data handed out by the pool.
+         */
+        typedef std::vector< uint8_t > Buffer;
+
+        // Lifecycle management
+    public:
+        ~BufferPool() noexcept;
+        BufferPool(const BufferPool&) = delete;
+        BufferPool(BufferPool&& other) noexcept;
+        BufferPool& operator=(const BufferPool& other) = delete;
+        BufferPool& operator=(BufferPool&& other) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is an instance constructor.
+         *
+         * @param[in] bufferCapacity
+         *     This is the number of bytes of memory to reserve
+         *     in each new buffer.
+         *
+         * @param[in] maxBuffersPooled
+         *     This is the maximum number of unused buffers to keep
+         *     for reuse.  Buffers released while the pool is already
+         *     holding this many have their memory freed instead.
+         */
+        BufferPool(
+            size_t bufferCapacity,
+            size_t maxBuffersPooled
+        );
+
+        /**
+         * This method hands out a buffer from the pool, making a new
+         * one if the pool has none to reuse.  The contents and size
+         * of the buffer are unspecified; a reused buffer keeps the
+         * size and contents it had when it was released.
+         *
+         * @return
+         *     A reference to the buffer is returned.  When the last
+         *     reference to the buffer is released, the buffer goes
+         *     back to the pool.
+         */
+        std::shared_ptr< Buffer > Acquire();
+
+        /**
+         * This method returns the number of unused buffers
+         * currently held by the pool for reuse.
+         *
+         * @return
+         *     The number of unused buffers currently held by the pool
+         *     for reuse is returned.
+         */
+        size_t GetBuffersPooled() const;
+
+        // Private properties
+    private:
+        /**
+         * This contains any platform-specific state for the object.
+         */
+        struct Impl;
+
+        /**
+         * This contains any platform-specific state for the object.
+         * It's shared with buffers handed out, so they can find their
+         * way back to the pool.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_BUFFER_POOL_HPP */
@@ -0,0 +1,372 @@
+/**
+ * @file BufferedFile.cpp
+ *
+ * This module contains the implementation of the
+ * SystemAbstractions::BufferedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <algorithm>
+#include <string.h>
+#include <SystemAbstractions/BufferedFile.hpp>
+
+namespace SystemAbstractions {
+
+    /**
+     * This contains the private properties of a BufferedFile instance.
+     */
+    struct BufferedFile::Impl {
+        // Properties
+
+        /**
+         * This is the file being wrapped.
+         */
+        std::shared_ptr< IFile > file;
+
+        /**
+         * This is the number of bytes to read ahead or hold
+         * behind at a time.
+         */
+        size_t bufferSize = 0;
+
+        /**
+         * This is the current position in the file.
+         */
+        uint64_t position = 0;
+
+        /**
+         * This holds data read ahead from the wrapped file.
+         */
+        Buffer readBuffer;
+
+        /**
+         * This is the position in the wrapped file of the first byte
+         * in the read buffer.
+         */
+        uint64_t readBufferStart = 0;
+
+        /**
+         * This is the number of bytes in the read buffer which
+         * hold data read ahead from the wrapped file.
+         */
+        size_t readBufferSize = 0;
+
+        /**
+         * This holds data written but not yet passed along
+         * to the wrapped file.
+         */
+        Buffer writeBuffer;
+
+        /**
+         * This is the position in the wrapped file where the
+         * first byte in the write buffer is to be written.
+         */
+        uint64_t writeBufferStart = 0;
+
+        // Methods
+
+        /**
+         * This method writes any data held in the write buffer
+         * to the wrapped file.  Any data which could not be written
+         * is kept in the write buffer, to be tried again later.
+         *
+         * @return
+         *     A flag indicating whether or not all the data held
+         *     in the write buffer was written successfully is returned.
+         */
+        bool Flush() {
+            if (writeBuffer.empty()) {
+                return true;
+            }
+            const auto amountWritten = std::min(
+                file->WriteAt(
+                    writeBufferStart,
+                    writeBuffer.data(),
+                    writeBuffer.size()
+                ),
+                writeBuffer.size()
+            );
+            (void)writeBuffer.erase(
+                writeBuffer.begin(),
+                writeBuffer.begin() + amountWritten
+            );
+            writeBufferStart += amountWritten;
+            return writeBuffer.empty();
+        }
+
+        /**
+         * This method copies whatever part of the given region of the
+         * file is at the front of the region and in the read buffer.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to copy.
+         *
+         * @param[out] buffer
+         *     This is where to put the bytes copied.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes in the region.
+         *
+         * @return
+         *     The number of bytes copied is returned.
+         */
+        size_t CopyFromReadBuffer(
+            uint64_t position,
+            uint8_t* buffer,
+            size_t numBytes
+        ) const {
+            if (
+                (position < readBufferStart)
+                || (position >= readBufferStart + readBufferSize)
+            ) {
+                return 0;
+            }
+            const auto offset = (size_t)(position - readBufferStart);
+            const auto amountCopied = std::min(numBytes, readBufferSize - offset);
+            (void)memcpy(buffer, readBuffer.data() + offset, amountCopied);
+            return amountCopied;
+        }
+
+        /**
+         * This method reads a region of the file, from the read
+         * buffer where possible, and otherwise from the wrapped file,
+         * reading ahead into the read buffer for small reads.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to read.
+         *
+         * @param[out] buffer
+         *     This is where to put the bytes read from the file.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to read from the file.
+         *
+         * @return
+         *     The number of bytes actually read is returned.
+         *     If data held in the write buffer could not be written,
+         *     the read stops short of it.
+         */
+        size_t ReadAt(
+            uint64_t position,
+            void* buffer,
+            size_t numBytes
+        ) {
+            if (!Flush()) {
+                if (position >= writeBufferStart) {
+                    return 0;
+                }
+                numBytes = (size_t)std::min(
+                    (uint64_t)numBytes,
+                    writeBufferStart - position
+                );
+            }
+            const auto destination = (uint8_t*)buffer;
+            auto amountRead = CopyFromReadBuffer(position, destination, numBytes);
+            while (amountRead < numBytes) {
+                const auto nextPosition = position + amountRead;
+                const auto amountLeft = numBytes - amountRead;
+                if (amountLeft >= bufferSize) {
+                    amountRead += file->ReadAt(
+                        nextPosition,
+                        destination + amountRead,
+                        amountLeft
+                    );
+                    break;
+                }
+                readBuffer.resize(bufferSize);
+                readBufferStart = nextPosition;
+                readBufferSize = file->ReadAt(
+                    nextPosition,
+                    readBuffer.data(),
+                    bufferSize
+                );
+                amountRead += CopyFromReadBuffer(
+                    nextPosition,
+                    destination + amountRead,
+                    amountLeft
+                );
+                if (readBufferSize < bufferSize) {
+                    break;
+                }
+            }
+            return amountRead;
+        }
+
+        /**
+         * This method writes a region of the file, holding small writes
+         * in the write buffer until it fills up or there is a write
+         * to a different part of the file.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to write.
+         *
+         * @param[in] buffer
+         *     This is where to fetch the bytes to write to the file.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to write to the file.
+         *
+         * @return
+         *     The number of bytes actually written or held in the
+         *     write buffer is returned.
+         */
+        size_t WriteAt(
+            uint64_t position,
+            const void* buffer,
+            size_t numBytes
+        ) {
+            if (numBytes == 0) {
+                return 0;
+            }
+            readBufferSize = 0;
+            if (
+                !writeBuffer.empty()
+                && (
+                    (position != writeBufferStart + writeBuffer.size())
+                    || (writeBuffer.size() + numBytes > bufferSize)
+                )
+                && !Flush()
+            ) {
+                return 0;
+            }
+            if (numBytes >= bufferSize) {
+                return file->WriteAt(position, buffer, numBytes);
+            }
+            if (writeBuffer.empty()) {
+                writeBuffer.reserve(bufferSize);
+                writeBufferStart = position;
+            }
+            (void)writeBuffer.insert(
+                writeBuffer.end(),
+                (const uint8_t*)buffer,
+                (const uint8_t*)buffer + numBytes
+            );
+            return numBytes;
+        }
+    };
+
+    BufferedFile::~BufferedFile() noexcept {
+        if (impl_ == nullptr) {
+            return;
+        }
+        (void)impl_->Flush();
+    }
+    BufferedFile::BufferedFile(BufferedFile&&) noexcept = default;
+    BufferedFile& BufferedFile::operator=(BufferedFile&& other) noexcept {
+        if (this != &other) {
+            if (impl_ != nullptr) {
+                (void)impl_->Flush();
+            }
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    BufferedFile::BufferedFile(
+        std::shared_ptr< IFile > file,
+        size_t bufferSize
+    )
+        : impl_(new Impl())
+    {
+        impl_->file = file;
+        impl_->bufferSize = std::max(bufferSize, (size_t)1);
+    }
+
+    bool BufferedFile::Flush() {
+        return impl_->Flush();
+    }
+
+    uint64_t BufferedFile::GetSize() const {
+        auto size = impl_->file->GetSize();
+        if (!impl_->writeBuffer.empty()) {
+            size = std::max(
+                size,
+                impl_->writeBufferStart + impl_->writeBuffer.size()
+            );
+        }
+        return size;
+    }
+
+    bool BufferedFile::SetSize(uint64_t size) {
+        impl_->readBufferSize = 0;
+        if (!impl_->Flush()) {
+            return false;
+        }
+        return impl_->file->SetSize(size);
+    }
+
+    uint64_t BufferedFile::GetPosition() const {
+        return impl_->position;
+    }
+
+    void BufferedFile::SetPosition(uint64_t position) {
+        impl_->position = position;
+    }
+
+    size_t BufferedFile::Peek(Buffer& buffer, size_t numBytes, size_t offset) const {
+        if (numBytes == 0) {
+            numBytes = buffer.size() - offset;
+        }
+        if (numBytes == 0) {
+            return 0;
+        }
+        return Peek(&buffer[offset], numBytes);
+    }
+
+    size_t BufferedFile::Peek(void* buffer, size_t numBytes) const {
+        return impl_->ReadAt(impl_->position, buffer, numBytes);
+    }
+
+    size_t BufferedFile::Read(Buffer& buffer, size_t numBytes, size_t offset) {
+        if (numBytes == 0) {
+            numBytes = buffer.size() - offset;
+        }
+        if (numBytes == 0) {
+            return 0;
+        }
+        return Read(&buffer[offset], numBytes);
+    }
+
+    size_t BufferedFile::Read(void* buffer, size_t numBytes) {
+        const auto amountRead = impl_->ReadAt(impl_->position, buffer, numBytes);
+        impl_->position += amountRead;
+        return amountRead;
+    }
+
+    size_t BufferedFile::Write(const Buffer& buffer, size_t numBytes, size_t offset) {
+        if (numBytes == 0) {
+            numBytes = buffer.size() - offset;
+        }
+        if (numBytes == 0) {
+            return 0;
+        }
+        return Write(&buffer[offset], numBytes);
+    }
+
+    size_t BufferedFile::Write(const void* buffer, size_t numBytes) {
+        const auto amountWritten = impl_->WriteAt(impl_->position, buffer, numBytes);
+        impl_->position += amountWritten;
+        return amountWritten;
+    }
+
+    size_t BufferedFile::ReadAt(uint64_t position, void* buffer, size_t numBytes) const {
+        return impl_->ReadAt(position, buffer, numBytes);
+    }
+
+    size_t BufferedFile::WriteAt(uint64_t position, const void* buffer, size_t numBytes) {
+        return impl_->WriteAt(position, buffer, numBytes);
+    }
+
+    std::shared_ptr< IFile > BufferedFile::Clone() {
+        if (!impl_->Flush()) {
+            return nullptr;
+        }
+        const auto file = impl_->file->Clone();
+        if (file == nullptr) {
+            return nullptr;
+        }
+        return std::make_shared< BufferedFile >(file, impl_->bufferSize);
+    }
+
+}
@@ -12,24 +12,49 @@
 #include <algorithm>
 #include <stddef.h>
 #include <deque>
+#include <string.h>
 
 namespace {
 
+    /**
+     * This is the smallest capacity allocated for the ring buffer
+     * of a queue in Ring mode.
+     */
+    constexpr size_t MINIMUM_RING_CAPACITY = 4096;
+
     /**
      * This represents one sequential piece of data being
      * held in a DataQueue.
      */
     struct Element {
         /**
-         * This holds the actual bytes in the queue element.
+         * This holds the actual bytes in the queue element,
+         * unless they are shared.
          */
         SystemAbstractions::DataQueue::Buffer data;
 
+        /**
+         * If the bytes in the queue element are shared rather than
+         * held by the element, this refers to them.
+         */
+        std::shared_ptr< const SystemAbstractions::DataQueue::Buffer > sharedData;
+
         /**
          * This is the number of bytes that have already
          * been consumed from this element.
          */
         size_t consumed = 0;
+
+        /**
+         * This method returns the actual bytes in the queue element,
+         * whether they are held by the element or shared.
+         *
+         * @return
+         *     The actual bytes in the queue element are returned.
+         */
+        const SystemAbstractions::DataQueue::Buffer& GetData() const {
+            return (sharedData == nullptr) ? data : *sharedData;
+        }
     };
 
 }
@@ -42,6 +67,11 @@ namespace SystemAbstractions {
     struct DataQueue::Impl {
         // Properties
 
+        /**
+         * This is the way the queue stores its data.
+         */
+        Mode mode = Mode::Buffers;
+
         /**
          * This is where the actual data is stored in the queue.
          * It's in two levels:
@@ -51,6 +81,19 @@ namespace SystemAbstractions {
          */
         std::deque< Element > elements;
 
+        /**
+         * This is where the actual data is stored in the queue,
+         * in Ring mode.  Its size is always either zero or
+         * a power of two.
+         */
+        Buffer ring;
+
+        /**
+         * This is the offset in the ring buffer of the first byte
+         * in the queue, in Ring mode.
+         */
+        size_t ringHead = 0;
+
         /**
          * This keeps track of the total number of bytes across
          * all elements of the queue.
@@ -59,6 +102,79 @@ namespace SystemAbstractions {
 
         // Methods
 
+        /**
+         * This method copies the given number of bytes from the
+         * front of the ring buffer.
+         *
+         * @param[out] destination
+         *     This is where to copy the bytes.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to copy.  It must not be
+         *     more than the number of bytes in the queue.
+         */
+        void RingCopy(
+            uint8_t* destination,
+            size_t numBytes
+        ) const {
+            const auto firstPart = std::min(numBytes, ring.size() - ringHead);
+            (void)memcpy(destination, ring.data() + ringHead, firstPart);
+            (void)memcpy(destination + firstPart, ring.data(), numBytes - firstPart);
+        }
+
+        /**
+         * This method copies the given bytes onto the end of the
+         * ring buffer, growing the ring buffer first if necessary.
+         *
+         * @param[in] data
+         *     This points to the bytes to copy.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to copy.
+         */
+        void RingEnqueue(
+            const uint8_t* data,
+            size_t numBytes
+        ) {
+            if (numBytes == 0) {
+                return;
+            }
+            if (totalBytes + numBytes > ring.size()) {
+                auto newCapacity = std::max(ring.size(), MINIMUM_RING_CAPACITY);
+                while (newCapacity < totalBytes + numBytes) {
+                    newCapacity *= 2;
+                }
+                Buffer newRing(newCapacity);
+                if (totalBytes > 0) {
+                    RingCopy(newRing.data(), totalBytes);
+                }
+                ring.swap(newRing);
+                ringHead = 0;
+            }
+            const auto tail = (ringHead + totalBytes) & (ring.size() - 1);
+            const auto firstPart = std::min(numBytes, ring.size() - tail);
+            (void)memcpy(ring.data() + tail, data, firstPart);
+            (void)memcpy(ring.data(), data + firstPart, numBytes - firstPart);
+            totalBytes += numBytes;
+        }
+
+        /**
+         * This method removes the given number of bytes from the
+         * front of the ring buffer.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to remove.  It must not be
+         *     more than the number of bytes in the queue.
+         */
+        void RingDrop(size_t numBytes) {
+            totalBytes -= numBytes;
+            if (totalBytes == 0) {
+                ringHead = 0;
+            } else {
+                ringHead = (ringHead + numBytes) & (ring.size() - 1);
+            }
+        }
+
         /**
          * This method tries to copy, move, and/or remove the given number
          * of bytes from the queue, based on the given mode flags.
@@ -85,19 +201,35 @@ namespace SystemAbstractions {
             bool removeData
         ) -> Buffer {
             Buffer buffer;
-            auto nextElement = elements.begin();
             auto bytesLeftFromQueue = std::min(numBytesRequested, totalBytes);
+            if (mode == Mode::Ring) {
+                if (returnData) {
+                    buffer.resize(bytesLeftFromQueue);
+                    if (bytesLeftFromQueue > 0) {
+                        RingCopy(buffer.data(), bytesLeftFromQueue);
+                    }
+                }
+                if (removeData) {
+                    RingDrop(bytesLeftFromQueue);
+                }
+                return buffer;
+            }
+            auto nextElement = elements.begin();
             while (bytesLeftFromQueue > 0) {
+                const auto& data = nextElement->GetData();
                 if (
                     (nextElement->consumed == 0)
-                    && (nextElement->data.size() == bytesLeftFromQueue)
+                    && (data.size() == bytesLeftFromQueue)
                     && buffer.empty()
                 ) {
                     if (returnData) {
-                        if (removeData) {
+                        if (
+                            removeData
+                            && (nextElement->sharedData == nullptr)
+                        ) {
                             buffer = std::move(nextElement->data);
                         } else {
-                            buffer = nextElement->data;
+                            buffer = data;
                         }
                     }
                     if (removeData) {
@@ -106,26 +238,29 @@ namespace SystemAbstractions {
                     }
                     break;
                 }
+                if (returnData && buffer.empty()) {
+                    buffer.reserve(bytesLeftFromQueue);
+                }
                 const auto bytesToConsume = std::min(
                     bytesLeftFromQueue,
-                    nextElement->data.size() - nextElement->consumed
+                    data.size() - nextElement->consumed
                 );
                 if (returnData) {
                     (void)buffer.insert(
                         buffer.end(),
-                        nextElement->data.begin() + nextElement->consumed,
-                        nextElement->data.begin() + nextElement->consumed + bytesToConsume
+                        data.begin() + nextElement->consumed,
+                        data.begin() + nextElement->consumed + bytesToConsume
                     );
                 }
                 bytesLeftFromQueue -= bytesToConsume;
                 if (removeData) {
                     nextElement->consumed += bytesToConsume;
                     totalBytes -= bytesToConsume;
-                    if (nextElement->consumed >= nextElement->data.size()) {
+                    if (nextElement->consumed >= data.size()) {
                         nextElement = elements.erase(nextElement);
                     }
                 } else {
-                    if (nextElement->consumed + bytesToConsume >= nextElement->data.size()) {
+                    if (nextElement->consumed + bytesToConsume >= data.size()) {
                         ++nextElement;
                     }
                 }
@@ -138,12 +273,17 @@ namespace SystemAbstractions {
     DataQueue::DataQueue(DataQueue&& other) noexcept = default;
     DataQueue& DataQueue::operator=(DataQueue&& other) noexcept = default;
 
-    DataQueue::DataQueue()
+    DataQueue::DataQueue(Mode mode)
         : impl_(new Impl())
     {
+        impl_->mode = mode;
     }
 
     void DataQueue::Enqueue(const Buffer& data) {
+        if (impl_->mode == Mode::Ring) {
+            impl_->RingEnqueue(data.data(), data.size());
+            return;
+        }
         impl_->totalBytes += data.size();
         Element newElement;
         newElement.data = data;
@@ -151,12 +291,30 @@ namespace SystemAbstractions {
     }
 
     void DataQueue::Enqueue(Buffer&& data) {
+        if (impl_->mode == Mode::Ring) {
+            impl_->RingEnqueue(data.data(), data.size());
+            return;
+        }
         impl_->totalBytes += data.size();
         Element newElement;
         newElement.data = std::move(data);
         impl_->elements.push_back(std::move(newElement));
     }
 
+    void DataQueue::Enqueue(std::shared_ptr< const Buffer > data) {
+        if (data == nullptr) {
+            return;
+        }
+        if (impl_->mode == Mode::Ring) {
+            impl_->RingEnqueue(data->data(), data->size());
+            return;
+        }
+        impl_->totalBytes += data->size();
+        Element newElement;
+        newElement.sharedData = std::move(data);
+        impl_->elements.push_back(std::move(newElement));
+    }
+
     auto DataQueue::Dequeue(size_t numBytesRequested) -> Buffer {
         return impl_->Dequeue(numBytesRequested, true, true);
     }
@@ -165,11 +323,86 @@ namespace SystemAbstractions {
         return impl_->Dequeue(numBytesRequested, true, false);
     }
 
+    size_t DataQueue::PeekSegments(
+        std::vector< Segment >& segments,
+        size_t numBytesRequested,
+        size_t maxSegments
+    ) const {
+        segments.clear();
+        auto bytesLeftFromQueue = std::min(numBytesRequested, impl_->totalBytes);
+        size_t bytesProvided = 0;
+        if (impl_->mode == Mode::Ring) {
+            const auto& ring = impl_->ring;
+            auto offset = impl_->ringHead;
+            while (
+                (bytesLeftFromQueue > 0)
+                && (segments.size() < maxSegments)
+            ) {
+                Segment segment;
+                segment.data = ring.data() + offset;
+                segment.size = std::min(bytesLeftFromQueue, ring.size() - offset);
+                segments.push_back(segment);
+                bytesLeftFromQueue -= segment.size;
+                bytesProvided += segment.size;
+                offset = 0;
+            }
+            return bytesProvided;
+        }
+        for (
+            auto nextElement = impl_->elements.begin();
+            (bytesLeftFromQueue > 0) && (segments.size() < maxSegments);
+            ++nextElement
+        ) {
+            const auto& data = nextElement->GetData();
+            Segment segment;
+            segment.data = data.data() + nextElement->consumed;
+            segment.size = std::min(
+                bytesLeftFromQueue,
+                data.size() - nextElement->consumed
+            );
+            if (segment.size == 0) {
+                continue;
+            }
+            segments.push_back(segment);
+            bytesLeftFromQueue -= segment.size;
+            bytesProvided += segment.size;
+        }
+        return bytesProvided;
+    }
+
+    auto DataQueue::PeekContiguous() const -> Segment {
+        Segment segment;
+        segment.data = nullptr;
+        segment.size = 0;
+        if (impl_->mode == Mode::Ring) {
+            if (impl_->totalBytes > 0) {
+                segment.data = impl_->ring.data() + impl_->ringHead;
+                segment.size = std::min(
+                    impl_->totalBytes,
+                    impl_->ring.size() - impl_->ringHead
+                );
+            }
+        } else {
+            for (const auto& element: impl_->elements) {
+                const auto& data = element.GetData();
+                if (element.consumed < data.size()) {
+                    segment.data = data.data() + element.consumed;
+                    segment.size = data.size() - element.consumed;
+                    break;
+                }
+            }
+        }
+        return segment;
+    }
+
     void DataQueue::Drop(size_t numBytesRequested) {
         impl_->Dequeue(numBytesRequested, false, true);
     }
 
     size_t DataQueue::GetBuffersQueued() const noexcept {
+        if (impl_->mode == Mode::Ring) {
+            return (impl_->totalBytes == 0) ? 0 : 1;
+        }
         return impl_->elements.size();
     }
 
@@ -32,6 +32,45 @@ namespace SystemAbstractions {
          */
         typedef std::vector< uint8_t > Buffer;
 
+        /**
+         * This represents one contiguous piece of the data held
+         * in the queue, which may be accessed directly without
+         * copying it out of the queue.
+         */
+        struct Segment {
+            /**
+             * This points to the first byte of the piece.
+             */
+            const uint8_t* data;
+
+            /**
+             * This is the number of bytes in the piece.
+             */
+            size_t size;
+        };
+
+        /**
+         * These are the different ways a queue can store its data.
+         */
+        enum class Mode {
+            /**
+             * In this mode, the queue holds each buffer enqueued as
+             * a separate piece, moving or sharing it where possible
+             * rather than copying it.  This suits fewer, larger buffers.
+             */
+            Buffers,
+
+            /**
+             * In this mode, the queue copies all data enqueued into
+             * a single ring buffer, which grows as needed but is
+             * otherwise reused.  This suits many small buffers,
+             * since once the ring is large enough, no further memory
+             * is allocated, and the data is only ever split into
+             * at most two contiguous pieces.
+             */
+            Ring,
+        };
+
         // Lifecycle management
     public:
         ~DataQueue() noexcept;
@@ -44,8 +83,11 @@ namespace SystemAbstractions {
     public:
         /**
          * This is an instance constructor.
+         *
+         * @param[in] mode
+         *     This selects the way the queue stores its data.
          */
-        DataQueue();
+        explicit DataQueue(Mode mode = Mode::Buffers);
 
         /**
          * This method puts a copy of the given data onto the end
@@ -64,6 +106,18 @@ namespace SystemAbstractions {
          */
         void Enqueue(Buffer&& data);
 
+        /**
+         * This method puts the given shared data onto the end of the
+         * queue, without copying it (except in Ring mode, where all
+         * data is copied).  The data must not be modified
+         * while it's in the queue.
+         *
+         * @param[in] data
+         *     This is the data to share and store at the end of the queue.
+         *     If this is null, nothing is added to the queue.
+         */
+        void Enqueue(std::shared_ptr< const Buffer > data);
+
         /**
          * This method tries to remove the given number of bytes from
          * the queue.  Fewer bytes may be returned if there are fewer
@@ -90,6 +144,53 @@ namespace SystemAbstractions {
          */
         Buffer Peek(size_t numBytesRequested);
 
+        /**
+         * This method provides direct access to the given number of bytes
+         * at the front of the queue, as a sequence of contiguous
+         * pieces, without copying or removing them.  Fewer bytes may be
+         * provided if there are fewer bytes in the queue than requested,
+         * or if more pieces than allowed would be needed.
+         *
+         * @note
+         *     The pieces provided are only valid until the queue
+         *     is next modified.
+         *
+         * @param[out] segments
+         *     This is where to store the pieces.  Any previous contents
+         *     are replaced.
+         *
+         * @param[in] numBytesRequested
+         *     This is the number of bytes to try to provide.
+         *
+         * @param[in] maxSegments
+         *     This is the maximum number of pieces to provide.
+         *
+         * @return
+         *     The total number of bytes in the pieces provided
+         *     is returned.
+         */
+        size_t PeekSegments(
+            std::vector< Segment >& segments,
+            size_t numBytesRequested,
+            size_t maxSegments
+        ) const;
+
+        /**
+         * This method provides direct access to the bytes at the front
+         * of the queue which are stored contiguously, without copying
+         * or removing them.  Together with the Drop method, this allows
+         * data to be consumed from the queue without copying it.
+         *
+         * @note
+         *     The piece provided is only valid until the queue
+         *     is next modified.
+         *
+         * @return
+         *     The contiguous piece at the front of the queue is returned.
+         *     Its size is zero if the queue is empty.
+         */
+        Segment PeekContiguous() const;
+
         /**
          * This method tries to remove the given number of bytes from
          * the queue.  Fewer bytes may be removed if there are fewer
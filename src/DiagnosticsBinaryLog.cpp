@@ -0,0 +1,1128 @@
+/**
+ * @file DiagnosticsBinaryLog.cpp
+ *
+ * This module contains the implementation of the
+ * SystemAbstractions::DiagnosticsBinaryLogReporter and
+ * SystemAbstractions::DecodeDiagnosticsBinaryLog functions.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <algorithm>
+#include <ctype.h>
+#include <memory>
+#include <mutex>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <StringExtensions/StringExtensions.hpp>
+#include <SystemAbstractions/DiagnosticsBinaryLog.hpp>
+#include <SystemAbstractions/Time.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    /**
+     * These identify the different kinds of records in a binary log.
+     */
+    enum class RecordType : uint8_t {
+        /**
+         * This marks where a reporter began recording.  It holds
+         * the magic number, version, and byte order mark.  String
+         * identifiers defined before it are forgotten.
+         */
+        Session = 0,
+
+        /**
+         * This defines a string (sender name, context prefix,
+         * or format string) which messages refer to by identifier.
+         */
+        String = 1,
+
+        /**
+         * This holds one diagnostic message.
+         */
+        Message = 2,
+    };
+
+    /**
+     * This is the magic number found at the start of every session
+     * record in a binary log.
+     */
+    constexpr char MAGIC[4] = {'S', 'A', 'D', 'L'};
+
+    /**
+     * This is the version of the binary log format.
+     */
+    constexpr uint32_t VERSION = 2;
+
+    /**
+     * This is recorded in every session record so that a binary log
+     * recorded with a different byte order can be recognized.
+     */
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    /**
+     * This is the identifier of the empty string, which is never
+     * recorded in a binary log.
+     */
+    constexpr uint32_t EMPTY_STRING_ID = 0;
+
+    /**
+     * This is the format string used to record messages whose
+     * format strings have conversions that can't be recorded raw.
+     */
+    const char* const PREFORMATTED_MESSAGE_FORMAT = "%s";
+
+    /**
+     * This is the most strings (sender names, context prefixes, and
+     * format strings) a reporter remembers having recorded.  Once it
+     * has recorded more, it starts a new session, forgetting them all,
+     * so that neither it nor the decoder uses unbounded memory
+     * when messages have many different strings.
+     */
+    constexpr size_t MAX_RECORDED_STRINGS = 4096;
+
+    /**
+     * This is the most bytes of a string read from a binary log at
+     * a time, so that a corrupt length can't cause a huge allocation
+     * before the end of the file is found.
+     */
+    constexpr size_t MAX_STRING_READ_CHUNK = 65536;
+
+    /**
+     * These are the kinds of argument values which can be recorded
+     * for a conversion specification of a format string.
+     */
+    enum class ArgumentType {
+        /**
+         * The conversion takes no argument ("%%").
+         */
+        None,
+
+        /**
+         * The argument is recorded as a signed 64-bit integer.
+         */
+        SignedInteger,
+
+        /**
+         * The argument is recorded as an unsigned 64-bit integer.
+         */
+        UnsignedInteger,
+
+        /**
+         * The argument is recorded as a double-precision
+         * floating-point number, or as a "long double" in the
+         * native representation of the recording machine
+         * if the "L" length modifier is given.
+         */
+        FloatingPoint,
+
+        /**
+         * The argument is recorded as a length followed by
+         * the characters of the string.
+         */
+        String,
+
+        /**
+         * The argument is recorded as an unsigned 64-bit integer.
+         */
+        Pointer,
+    };
+
+    /**
+     * These are the length modifiers which may appear in a
+     * conversion specification of a format string.
+     */
+    enum class LengthModifier {
+        None,
+        hh,
+        h,
+        l,
+        ll,
+        j,
+        z,
+        t,
+        L,
+    };
+
+    /**
+     * This describes one conversion specification of a format string.
+     */
+    struct ConversionSpecification {
+        /**
+         * This is the index of the '%' starting the specification.
+         */
+        size_t start = 0;
+
+        /**
+         * This is the index of the length modifier, or of the conversion
+         * specifier if there is no length modifier.
+         */
+        size_t lengthStart = 0;
+
+        /**
+         * This is the index just past the conversion specifier.
+         */
+        size_t end = 0;
+
+        /**
+         * This is the conversion specifier.
+         */
+        char conversion = '%';
+
+        /**
+         * This is the number of asterisks given for the field width
+         * and precision, each of which takes an extra "int" argument.
+         */
+        size_t numStars = 0;
+
+        /**
+         * This is the length modifier, which selects the type
+         * of argument taken.
+         */
+        LengthModifier length = LengthModifier::None;
+
+        /**
+         * This is the kind of argument value recorded
+         * for the specification.
+         */
+        ArgumentType type = ArgumentType::None;
+    };
+
+    /**
+     * This function breaks down the given format string into its
+     * conversion specifications.
+     *
+     * @param[in] format
+     *     This is the format string to break down.
+     *
+     * @param[out] specifications
+     *     This is where to put the conversion specifications.
+     *
+     * @return
+     *     An indication of whether or not the arguments for every
+     *     conversion specification of the format string can be recorded
+     *     is returned.  Wide characters and strings, "%n", and argument
+     *     positions ("%1$d") are not supported.
+     */
+    bool ParseFormat(
+        const std::string& format,
+        std::vector< ConversionSpecification >& specifications
+    ) {
+        specifications.clear();
+        size_t i = 0;
+        while ((i = format.find('%', i)) != std::string::npos) {
+            ConversionSpecification specification;
+            specification.start = i++;
+            while (
+                (i < format.length())
+                && (strchr("-+ #0'", format[i]) != NULL)
+            ) {
+                ++i;
+            }
+            if ((i < format.length()) && (format[i] == '*')) {
+                ++specification.numStars;
+                ++i;
+            } else {
+                while ((i < format.length()) && isdigit(format[i])) {
+                    ++i;
+                }
+            }
+            if ((i < format.length()) && (format[i] == '$')) {
+                return false;
+            }
+            if ((i < format.length()) && (format[i] == '.')) {
+                ++i;
+                if ((i < format.length()) && (format[i] == '*')) {
+                    ++specification.numStars;
+                    ++i;
+                } else {
+                    while ((i < format.length()) && isdigit(format[i])) {
+                        ++i;
+                    }
+                }
+            }
+            specification.lengthStart = i;
+            if (i < format.length()) {
+                switch (format[i]) {
+                    case 'h': {
+                        if ((i + 1 < format.length()) && (format[i + 1] == 'h')) {
+                            specification.length = LengthModifier::hh;
+                            ++i;
+                        } else {
+                            specification.length = LengthModifier::h;
+                        }
+                        ++i;
+                    } break;
+
+                    case 'l': {
+                        if ((i + 1 < format.length()) && (format[i + 1] == 'l')) {
+                            specification.length = LengthModifier::ll;
+                            ++i;
+                        } else {
+                            specification.length = LengthModifier::l;
+                        }
+                        ++i;
+                    } break;
+
+                    case 'j': {
+                        specification.length = LengthModifier::j;
+                        ++i;
+                    } break;
+
+                    case 'z': {
+                        specification.length = LengthModifier::z;
+                        ++i;
+                    } break;
+
+                    case 't': {
+                        specification.length = LengthModifier::t;
+                        ++i;
+                    } break;
+
+                    case 'L': {
+                        specification.length = LengthModifier::L;
+                        ++i;
+                    } break;
+
+                    default: break;
+                }
+            }
+            if (i >= format.length()) {
+                return false;
+            }
+            specification.conversion = format[i++];
+            specification.end = i;
+            switch (specification.conversion) {
+                case '%': {
+                    specification.type = ArgumentType::None;
+                } break;
+
+                case 'd':
+                case 'i': {
+                    specification.type = ArgumentType::SignedInteger;
+                } break;
+
+                case 'c': {
+                    if (specification.length != LengthModifier::None) {
+                        return false;
+                    }
+                    specification.type = ArgumentType::SignedInteger;
+                } break;
+
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X': {
+                    specification.type = ArgumentType::UnsignedInteger;
+                } break;
+
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A': {
+                    specification.type = ArgumentType::FloatingPoint;
+                } break;
+
+                case 's': {
+                    if (specification.length != LengthModifier::None) {
+                        return false;
+                    }
+                    specification.type = ArgumentType::String;
+                } break;
+
+                case 'p': {
+                    specification.type = ArgumentType::Pointer;
+                } break;
+
+                default: return false;
+            }
+            specifications.push_back(specification);
+        }
+        return true;
+    }
+
+    /**
+     * This function appends the bytes of the given value
+     * to the given buffer.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the value.
+     *
+     * @param[in] value
+     *     This is the value to append.
+     */
+    template< typename T > void Append(std::string& buffer, T value) {
+        buffer.append((const char*)&value, sizeof(value));
+    }
+
+    /**
+     * This function appends the length and characters of the given string
+     * to the given buffer.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the string.
+     *
+     * @param[in] value
+     *     This is the string to append.
+     *
+     * @param[in] length
+     *     This is the number of characters in the string.
+     */
+    void AppendString(std::string& buffer, const char* value, size_t length) {
+        Append(buffer, (uint32_t)length);
+        buffer.append(value, length);
+    }
+
+    /**
+     * This function takes the argument for the given conversion
+     * specification from the given argument list, and appends its
+     * recorded form to the given buffer.
+     *
+     * @param[in,out] buffer
+     *     This is the buffer to which to append the argument.
+     *
+     * @param[in] specification
+     *     This describes the argument to take.
+     *
+     * @param[in,out] args
+     *     This is the list from which to take the argument.  It's taken
+     *     by reference (which requires it to be a local variable rather
+     *     than a parameter, since va_list may be an array type) so that
+     *     the next argument is taken by the next call.
+     */
+    void AppendArgument(
+        std::string& buffer,
+        const ConversionSpecification& specification,
+        va_list& args
+    ) {
+        for (size_t i = 0; i < specification.numStars; ++i) {
+            Append(buffer, (int64_t)va_arg(args, int));
+        }
+        switch (specification.type) {
+            case ArgumentType::SignedInteger: {
+                int64_t value;
+                switch (specification.length) {
+                    case LengthModifier::hh: value = (signed char)va_arg(args, int); break;
+                    case LengthModifier::h: value = (short)va_arg(args, int); break;
+                    case LengthModifier::l: value = va_arg(args, long); break;
+                    case LengthModifier::ll: value = va_arg(args, long long); break;
+                    case LengthModifier::j: value = va_arg(args, intmax_t); break;
+                    case LengthModifier::z: value = va_arg(args, std::make_signed< size_t >::type); break;
+                    case LengthModifier::t: value = va_arg(args, ptrdiff_t); break;
+                    default: value = va_arg(args, int); break;
+                }
+                Append(buffer, value);
+            } break;
+
+            case ArgumentType::UnsignedInteger: {
+                uint64_t value;
+                switch (specification.length) {
+                    case LengthModifier::hh: value = (unsigned char)va_arg(args, unsigned int); break;
+                    case LengthModifier::h: value = (unsigned short)va_arg(args, unsigned int); break;
+                    case LengthModifier::l: value = va_arg(args, unsigned long); break;
+                    case LengthModifier::ll: value = va_arg(args, unsigned long long); break;
+                    case LengthModifier::j: value = va_arg(args, uintmax_t); break;
+                    case LengthModifier::z: value = va_arg(args, size_t); break;
+                    case LengthModifier::t: value = (std::make_unsigned< ptrdiff_t >::type)va_arg(args, ptrdiff_t); break;
+                    default: value = va_arg(args, unsigned int); break;
+                }
+                Append(buffer, value);
+            } break;
+
+            case ArgumentType::FloatingPoint: {
+                if (specification.length == LengthModifier::L) {
+                    Append(buffer, va_arg(args, long double));
+                } else {
+                    Append(buffer, va_arg(args, double));
+                }
+            } break;
+
+            case ArgumentType::String: {
+                const char* value = va_arg(args, const char*);
+                if (value == NULL) {
+                    value = "(null)";
+                }
+                AppendString(buffer, value, strlen(value));
+            } break;
+
+            case ArgumentType::Pointer: {
+                Append(buffer, (uint64_t)(uintptr_t)va_arg(args, void*));
+            } break;
+
+            default: break;
+        }
+    }
+
+    /**
+     * This holds information about a format string
+     * already recorded in a binary log.
+     */
+    struct RecordedFormat {
+        /**
+         * This is the identifier under which the format string
+         * was recorded.
+         */
+        uint32_t id = EMPTY_STRING_ID;
+
+        /**
+         * This indicates whether or not the arguments for every
+         * conversion specification of the format string can be recorded.
+         */
+        bool supported = false;
+
+        /**
+         * These are the conversion specifications of the format string.
+         */
+        std::vector< ConversionSpecification > specifications;
+    };
+
+    /**
+     * This holds the state of a reporter returned by
+     * DiagnosticsBinaryLogReporter.
+     */
+    struct BinaryLogWriter {
+        // Properties
+
+        /**
+         * This is the file to which to record diagnostic messages.
+         */
+        FILE* file = NULL;
+
+        /**
+         * This is used to time-stamp messages.
+         */
+        SystemAbstractions::Time time;
+
+        /**
+         * This is the time the reporter was made.
+         */
+        double timeReference = 0.0;
+
+        /**
+         * This is the identifier to assign to the next string recorded.
+         */
+        uint32_t nextStringId = EMPTY_STRING_ID + 1;
+
+        /**
+         * These are the identifiers of the sender names and context
+         * prefixes already recorded.
+         */
+        std::unordered_map< std::string, uint32_t > stringIds;
+
+        /**
+         * These are the format strings already recorded,
+         * keyed by content.
+         */
+        std::unordered_map< std::string, RecordedFormat > formats;
+
+        /**
+         * These are the format strings most recently seen at each
+         * address, so that a format string seen before can usually
+         * be found without hashing its content.
+         */
+        std::unordered_map<
+            const char*,
+            std::unordered_map< std::string, RecordedFormat >::value_type*
+        > formatsByAddress;
+
+        /**
+         * This is where records are built before being written.
+         * Its memory is reused.
+         */
+        std::string buffer;
+
+        /**
+         * This is used to synchronize access to the state.
+         */
+        std::mutex mutex;
+
+        // Methods
+
+        /**
+         * This method appends a record starting a new session
+         * to the buffer, forgetting all strings already recorded.
+         */
+        void StartSession() {
+            Append(buffer, RecordType::Session);
+            buffer.append(MAGIC, sizeof(MAGIC));
+            Append(buffer, VERSION);
+            Append(buffer, BYTE_ORDER_MARK);
+            nextStringId = EMPTY_STRING_ID + 1;
+            stringIds.clear();
+            formats.clear();
+            formatsByAddress.clear();
+        }
+
+        /**
+         * This method appends a record defining the given string
+         * to the buffer, and returns the identifier assigned to it.
+         *
+         * @param[in] value
+         *     This is the string to define.
+         *
+         * @return
+         *     The identifier assigned to the string is returned.
+         */
+        uint32_t DefineString(const std::string& value) {
+            const auto id = nextStringId++;
+            Append(buffer, RecordType::String);
+            Append(buffer, id);
+            AppendString(buffer, value.data(), value.length());
+            return id;
+        }
+
+        /**
+         * This method returns the identifier of the given sender name
+         * or context prefix, recording it first if necessary.
+         *
+         * @param[in] value
+         *     This is the string whose identifier to return.
+         *
+         * @return
+         *     The identifier of the string is returned.
+         */
+        uint32_t GetStringId(const std::string& value) {
+            if (value.empty()) {
+                return EMPTY_STRING_ID;
+            }
+            const auto stringIdsEntry = stringIds.find(value);
+            if (stringIdsEntry != stringIds.end()) {
+                return stringIdsEntry->second;
+            }
+            const auto id = DefineString(value);
+            stringIds[value] = id;
+            return id;
+        }
+
+        /**
+         * This method returns information about the given format string,
+         * recording it first if necessary.
+         *
+         * @param[in] format
+         *     This is the format string whose information to return.
+         *
+         * @return
+         *     Information about the format string is returned.
+         */
+        const RecordedFormat& GetFormat(const char* format) {
+            auto& formatsEntry = formatsByAddress[format];
+            if (
+                (formatsEntry != nullptr)
+                && (formatsEntry->first == format)
+            ) {
+                return formatsEntry->second;
+            }
+            const std::string text(format);
+            auto formatsEntryForText = formats.find(text);
+            if (formatsEntryForText == formats.end()) {
+                formatsEntryForText = formats.insert({text, RecordedFormat()}).first;
+                auto& recordedFormat = formatsEntryForText->second;
+                recordedFormat.id = DefineString(text);
+                recordedFormat.supported = ParseFormat(
+                    text,
+                    recordedFormat.specifications
+                );
+            }
+            formatsEntry = &*formatsEntryForText;
+            return formatsEntry->second;
+        }
+
+        /**
+         * This method records the given diagnostic message.
+         *
+         * @param[in] senderName
+         *     This identifies the origin of the diagnostic information.
+         *
+         * @param[in] level
+         *     This is used to filter out less-important information.
+         *     The level is higher the more important the information is.
+         *
+         * @param[in] contextPrefix
+         *     This is the contextual information to put in front
+         *     of the message once it's formatted.
+         *
+         * @param[in] format
+         *     This is the formatting string to use as a guide to build
+         *     the message.
+         *
+         * @param[in] args
+         *     These are the arguments to use to build the message.
+         */
+        void Record(
+            const std::string& senderName,
+            size_t level,
+            const std::string& contextPrefix,
+            const char* format,
+            va_list args
+        ) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            buffer.clear();
+            // A message may record a sender name, a context prefix,
+            // its format string, and the preformatted message format.
+            if (
+                (stringIds.size() + formats.size() + 4 > MAX_RECORDED_STRINGS)
+                || (formatsByAddress.size() + 2 > MAX_RECORDED_STRINGS)
+            ) {
+                StartSession();
+            }
+            const auto messageTime = time.GetTime() - timeReference;
+            const auto senderId = GetStringId(senderName);
+            const auto contextId = GetStringId(contextPrefix);
+            const RecordedFormat* recordedFormat = &GetFormat(format);
+            const bool preformatted = !recordedFormat->supported;
+            std::string preformattedMessage;
+            if (preformatted) {
+                preformattedMessage = StringExtensions::vsprintf(format, args);
+                recordedFormat = &GetFormat(PREFORMATTED_MESSAGE_FORMAT);
+            }
+            Append(buffer, RecordType::Message);
+            Append(buffer, messageTime);
+            Append(buffer, (uint64_t)level);
+            Append(buffer, senderId);
+            Append(buffer, contextId);
+            Append(buffer, recordedFormat->id);
+            const auto argsLengthOffset = buffer.length();
+            Append(buffer, (uint32_t)0);
+            if (preformatted) {
+                AppendString(buffer, preformattedMessage.data(), preformattedMessage.length());
+            } else {
+                va_list remainingArgs;
+                va_copy(remainingArgs, args);
+                for (const auto& specification: recordedFormat->specifications) {
+                    AppendArgument(buffer, specification, remainingArgs);
+                }
+                va_end(remainingArgs);
+            }
+            const auto argsLength = (uint32_t)(buffer.length() - argsLengthOffset - sizeof(uint32_t));
+            (void)memcpy(&buffer[argsLengthOffset], &argsLength, sizeof(argsLength));
+            (void)fwrite(buffer.data(), buffer.length(), 1, file);
+        }
+    };
+
+    /**
+     * This is used to read the fields of a record of a binary log.
+     */
+    struct RecordReader {
+        // Properties
+
+        /**
+         * This is the file from which to read.
+         */
+        FILE* file = NULL;
+
+        // Methods
+
+        /**
+         * This method reads a value from the file.
+         *
+         * @param[out] value
+         *     This is where to put the value read.
+         *
+         * @return
+         *     An indication of whether or not the value
+         *     was read is returned.
+         */
+        template< typename T > bool Read(T& value) {
+            return (fread(&value, sizeof(value), 1, file) == 1);
+        }
+
+        /**
+         * This method reads a length-prefixed string from the file.
+         *
+         * @param[out] value
+         *     This is where to put the string read.
+         *
+         * @return
+         *     An indication of whether or not the string
+         *     was read is returned.
+         */
+        bool ReadString(std::string& value) {
+            uint32_t length;
+            if (!Read(length)) {
+                return false;
+            }
+            value.clear();
+            while (value.length() < length) {
+                const auto offset = value.length();
+                const auto chunkLength = std::min(
+                    (size_t)length - offset,
+                    MAX_STRING_READ_CHUNK
+                );
+                value.resize(offset + chunkLength);
+                if (fread(&value[offset], chunkLength, 1, file) != 1) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * This is used to take the recorded arguments of a message.
+     */
+    struct ArgumentReader {
+        // Properties
+
+        /**
+         * These are the recorded arguments.
+         */
+        const std::string& args;
+
+        /**
+         * This is the position of the next argument to take.
+         */
+        size_t position = 0;
+
+        // Methods
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] newArgs
+         *     These are the recorded arguments.
+         */
+        explicit ArgumentReader(const std::string& newArgs)
+            : args(newArgs)
+        {
+        }
+
+        /**
+         * This method takes the next argument.
+         *
+         * @param[out] value
+         *     This is where to put the argument.
+         *
+         * @return
+         *     An indication of whether or not the argument
+         *     was taken is returned.
+         */
+        template< typename T > bool Take(T& value) {
+            if (args.length() - position < sizeof(value)) {
+                return false;
+            }
+            (void)memcpy(&value, args.data() + position, sizeof(value));
+            position += sizeof(value);
+            return true;
+        }
+
+        /**
+         * This method takes the next argument, which is a string.
+         *
+         * @param[out] value
+         *     This is where to put the argument.
+         *
+         * @return
+         *     An indication of whether or not the argument
+         *     was taken is returned.
+         */
+        bool TakeString(std::string& value) {
+            uint32_t length;
+            if (
+                !Take(length)
+                || (args.length() - position < length)
+            ) {
+                return false;
+            }
+            value.assign(args.data() + position, length);
+            position += length;
+            return true;
+        }
+    };
+
+    /**
+     * This function formats one argument, according to the given
+     * conversion specification (with any length modifier replaced),
+     * and appends it to the given message.
+     *
+     * @param[in,out] message
+     *     This is the message to which to append the formatted argument.
+     *
+     * @param[in] specification
+     *     This is the conversion specification to use to format
+     *     the argument.
+     *
+     * @param[in] stars
+     *     These are the field width and/or precision given for
+     *     asterisks in the conversion specification.
+     *
+     * @param[in] numStars
+     *     This is the number of asterisks in the conversion specification.
+     *
+     * @param[in] value
+     *     This is the argument to format.
+     */
+    template< typename T > void AppendFormatted(
+        std::string& message,
+        const std::string& specification,
+        const int* stars,
+        size_t numStars,
+        T value
+    ) {
+        switch (numStars) {
+            case 0: {
+                message += StringExtensions::sprintf(specification.c_str(), value);
+            } break;
+
+            case 1: {
+                message += StringExtensions::sprintf(specification.c_str(), stars[0], value);
+            } break;
+
+            default: {
+                message += StringExtensions::sprintf(specification.c_str(), stars[0], stars[1], value);
+            } break;
+        }
+    }
+
+    /**
+     * This function builds a message from the given format string
+     * and recorded arguments.
+     *
+     * @param[in] format
+     *     This is the format string.
+     *
+     * @param[in] specifications
+     *     These are the conversion specifications of the format string.
+     *
+     * @param[in] args
+     *     These are the recorded arguments.
+     *
+     * @param[in,out] message
+     *     This is the message to which to append the formatted text.
+     *
+     * @return
+     *     An indication of whether or not the recorded arguments
+     *     matched the format string is returned.
+     */
+    bool FormatMessage(
+        const std::string& format,
+        const std::vector< ConversionSpecification >& specifications,
+        const std::string& args,
+        std::string& message
+    ) {
+        ArgumentReader reader(args);
+        size_t literalStart = 0;
+        for (const auto& specification: specifications) {
+            message.append(format, literalStart, specification.start - literalStart);
+            literalStart = specification.end;
+            if (specification.type == ArgumentType::None) {
+                message += '%';
+                continue;
+            }
+            int stars[2] = {0, 0};
+            for (size_t i = 0; i < specification.numStars; ++i) {
+                int64_t star;
+                if (!reader.Take(star)) {
+                    return false;
+                }
+                stars[i] = (int)star;
+            }
+            auto normalizedSpecification = format.substr(
+                specification.start,
+                specification.lengthStart - specification.start
+            );
+            switch (specification.type) {
+                case ArgumentType::SignedInteger: {
+                    int64_t value;
+                    if (!reader.Take(value)) {
+                        return false;
+                    }
+                    if (specification.conversion == 'c') {
+                        normalizedSpecification += 'c';
+                        AppendFormatted(message, normalizedSpecification, stars, specification.numStars, (int)value);
+                    } else {
+                        normalizedSpecification += "ll";
+                        normalizedSpecification += specification.conversion;
+                        AppendFormatted(message, normalizedSpecification, stars, specification.numStars, (long long)value);
+                    }
+                } break;
+
+                case ArgumentType::UnsignedInteger: {
+                    uint64_t value;
+                    if (!reader.Take(value)) {
+                        return false;
+                    }
+                    normalizedSpecification += "ll";
+                    normalizedSpecification += specification.conversion;
+                    AppendFormatted(message, normalizedSpecification, stars, specification.numStars, (unsigned long long)value);
+                } break;
+
+                case ArgumentType::FloatingPoint: {
+                    if (specification.length == LengthModifier::L) {
+                        long double value;
+                        if (!reader.Take(value)) {
+                            return false;
+                        }
+                        normalizedSpecification += 'L';
+                        normalizedSpecification += specification.conversion;
+                        AppendFormatted(message, normalizedSpecification, stars, specification.numStars, value);
+                    } else {
+                        double value;
+                        if (!reader.Take(value)) {
+                            return false;
+                        }
+                        normalizedSpecification += specification.conversion;
+                        AppendFormatted(message, normalizedSpecification, stars, specification.numStars, value);
+                    }
+                } break;
+
+                case ArgumentType::String: {
+                    std::string value;
+                    if (!reader.TakeString(value)) {
+                        return false;
+                    }
+                    normalizedSpecification += 's';
+                    AppendFormatted(message, normalizedSpecification, stars, specification.numStars, value.c_str());
+                } break;
+
+                case ArgumentType::Pointer: {
+                    uint64_t value;
+                    if (!reader.Take(value)) {
+                        return false;
+                    }
+                    normalizedSpecification += 'p';
+                    AppendFormatted(message, normalizedSpecification, stars, specification.numStars, (void*)(uintptr_t)value);
+                } break;
+
+                default: break;
+            }
+        }
+        message.append(format, literalStart, std::string::npos);
+        return (reader.position == args.length());
+    }
+
+}
+
+namespace SystemAbstractions {
+
+    DiagnosticsSender::DiagnosticRawMessageDelegate DiagnosticsBinaryLogReporter(
+        FILE* file
+    ) {
+        const auto writer = std::make_shared< BinaryLogWriter >();
+        writer->file = file;
+        writer->timeReference = writer->time.GetTime();
+        writer->StartSession();
+        (void)fwrite(writer->buffer.data(), writer->buffer.length(), 1, file);
+        return [writer](
+            const std::string& senderName,
+            size_t level,
+            const std::string& contextPrefix,
+            const char* format,
+            va_list args
+        ){
+            writer->Record(senderName, level, contextPrefix, format, args);
+        };
+    }
+
+    bool DecodeDiagnosticsBinaryLog(
+        FILE* file,
+        DiagnosticsBinaryLogMessageDelegate delegate
+    ) {
+        RecordReader reader;
+        reader.file = file;
+        bool sessionStarted = false;
+        std::unordered_map< uint32_t, std::string > strings;
+        std::unordered_map< uint32_t, std::vector< ConversionSpecification > > formats;
+        const std::string emptyString;
+        const auto lookUpString = [&strings, &emptyString](uint32_t id) -> const std::string* {
+            if (id == EMPTY_STRING_ID) {
+                return &emptyString;
+            }
+            const auto stringsEntry = strings.find(id);
+            if (stringsEntry == strings.end()) {
+                return nullptr;
+            }
+            return &stringsEntry->second;
+        };
+        std::string args;
+        std::string message;
+        for (;;) {
+            RecordType type;
+            if (!reader.Read(type)) {
+                return (feof(file) != 0);
+            }
+            switch (type) {
+                case RecordType::Session: {
+                    char magic[sizeof(MAGIC)];
+                    uint32_t version, byteOrderMark;
+                    if (
+                        (fread(magic, sizeof(magic), 1, file) != 1)
+                        || (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+                        || !reader.Read(version)
+                        || (version != VERSION)
+                        || !reader.Read(byteOrderMark)
+                        || (byteOrderMark != BYTE_ORDER_MARK)
+                    ) {
+                        return false;
+                    }
+                    strings.clear();
+                    formats.clear();
+                    sessionStarted = true;
+                } break;
+
+                case RecordType::String: {
+                    uint32_t id;
+                    if (
+                        !sessionStarted
+                        || !reader.Read(id)
+                        || !reader.ReadString(strings[id])
+                    ) {
+                        return false;
+                    }
+                    (void)formats.erase(id);
+                } break;
+
+                case RecordType::Message: {
+                    double time;
+                    uint64_t level;
+                    uint32_t senderId, contextId, formatId;
+                    if (
+                        !sessionStarted
+                        || !reader.Read(time)
+                        || !reader.Read(level)
+                        || !reader.Read(senderId)
+                        || !reader.Read(contextId)
+                        || !reader.Read(formatId)
+                        || !reader.ReadString(args)
+                    ) {
+                        return false;
+                    }
+                    const auto senderName = lookUpString(senderId);
+                    const auto contextPrefix = lookUpString(contextId);
+                    const auto format = lookUpString(formatId);
+                    if (
+                        (senderName == nullptr)
+                        || (contextPrefix == nullptr)
+                        || (format == nullptr)
+                    ) {
+                        return false;
+                    }
+                    auto formatsEntry = formats.find(formatId);
+                    if (formatsEntry == formats.end()) {
+                        std::vector< ConversionSpecification > specifications;
+                        if (!ParseFormat(*format, specifications)) {
+                            return false;
+                        }
+                        formatsEntry = formats.insert({formatId, std::move(specifications)}).first;
+                    }
+                    message = *contextPrefix;
+                    if (!FormatMessage(*format, formatsEntry->second, args, message)) {
+                        return false;
+                    }
+                    delegate(time, *senderName, (size_t)level, message);
+                } break;
+
+                default: return false;
+            }
+        }
+    }
+
+}
@@ -11,44 +11,17 @@
 
 namespace SystemAbstractions {
 
-    /**
-     * This holds the private properties of the DiagnosticsContext class.
-     */
-    struct DiagnosticsContext::Impl {
-        // Properties
-
-        /**
-         * This is the sender upon which this class is pushing a context
-         * as long as the class instance exists.
-         */
-        DiagnosticsSender& diagnosticsSender;
-
-        // Methods
-
-        /**
-         * This is the constructor.
-         *
-         * @param[in] DiagnosticsSender& newDiagnosticsSender
-         *     This is the sender upon which this class is pushing a context
-         *     as long as the class instance exists.
-         */
-        Impl(DiagnosticsSender& newDiagnosticsSender)
-            : diagnosticsSender(newDiagnosticsSender)
-        {
-        }
-    };
-
     DiagnosticsContext::DiagnosticsContext(
         DiagnosticsSender& diagnosticsSender,
         const std::string& context
     ) noexcept
-        : impl_(new Impl(diagnosticsSender))
+        : diagnosticsSender_(diagnosticsSender)
     {
-        diagnosticsSender.PushContext(context);
+        diagnosticsSender_.PushContext(context);
     }
 
     DiagnosticsContext::~DiagnosticsContext() noexcept {
-        impl_->diagnosticsSender.PopContext();
+        diagnosticsSender_.PopContext();
     }
 
 }
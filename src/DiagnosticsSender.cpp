@@ -8,12 +8,14 @@
  */
 
 #include <algorithm>
-#include <deque>
+#include <atomic>
+#include <future>
 #include <limits>
-#include <map>
 #include <mutex>
+#include <stdint.h>
 #include <StringExtensions/StringExtensions.hpp>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <vector>
 
 
 namespace {
@@ -31,12 +33,25 @@ namespace {
     struct Subscription {
         // Properties
 
+        /**
+         * This identifies the subscription, so that it can be found
+         * again when unsubscribing.
+         */
+        SubscriptionToken token = 0;
+
         /**
          * This is the function to call to deliver messages
          * to this subscriber.
          */
         SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate;
 
+        /**
+         * If not empty, this is the function to call to deliver messages
+         * to this subscriber, before they're formatted, instead of
+         * the other delegate.
+         */
+        SystemAbstractions::DiagnosticsSender::DiagnosticRawMessageDelegate rawDelegate;
+
         /**
          * This is the minimum level of message that this subscriber
          * desires to receive.
@@ -54,6 +69,9 @@ namespace {
          * This constructor is used to initialize all the properties
          * of the instance.
          *
+         * @param[in] newToken
+         *     This identifies the subscription.
+         *
          * @param[in] newDelegate
          *     This is the function to call to deliver messages
          *     to this subscriber.
@@ -63,15 +81,416 @@ namespace {
          *     desires to receive.
          */
         Subscription(
+            SubscriptionToken newToken,
             SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate newDelegate,
             size_t newMinLevel
         )
-            : delegate(newDelegate)
+            : token(newToken)
+            , delegate(newDelegate)
             , minLevel(newMinLevel)
         {
         }
+
+        /**
+         * This constructor is used to initialize all the properties
+         * of the instance, for a subscriber desiring to receive
+         * messages before they're formatted.
+         *
+         * @param[in] newToken
+         *     This identifies the subscription.
+         *
+         * @param[in] newRawDelegate
+         *     This is the function to call to deliver messages
+         *     to this subscriber.
+         *
+         * @param[in] newMinLevel
+         *     This is the minimum level of message that this subscriber
+         *     desires to receive.
+         */
+        Subscription(
+            SubscriptionToken newToken,
+            SystemAbstractions::DiagnosticsSender::DiagnosticRawMessageDelegate newRawDelegate,
+            size_t newMinLevel
+        )
+            : token(newToken)
+            , rawDelegate(newRawDelegate)
+            , minLevel(newMinLevel)
+        {
+        }
+    };
+
+    /**
+     * This holds everything a DiagnosticsSender needs in order to
+     * publish a message, other than its context.  Once made, it's never
+     * changed; instead, whenever a subscription is formed or ended,
+     * a new one is made to replace it.  This lets messages be published
+     * without taking the sender's mutex or copying any subscriptions.
+     */
+    struct Publication {
+        // Properties
+
+        /**
+         * These are the current valid subscriptions
+         * to the diagnostic messages published by the sender.
+         */
+        std::vector< Subscription > subscriptions;
+
+        /**
+         * This is fulfilled when the publication is destroyed, which
+         * happens once no message is being published with it.
+         */
+        std::promise< void > retired;
+
+        // Methods
+
+        /**
+         * This is the destructor of the structure.
+         */
+        ~Publication() {
+            retired.set_value();
+        }
+    };
+
+    /**
+     * This holds the contextual information pushed by one thread
+     * onto one DiagnosticsSender.
+     */
+    struct ContextStack {
+        /**
+         * This identifies the sender to which the contexts were pushed.
+         */
+        uint64_t senderId = 0;
+
+        /**
+         * This is the contextual information to put in front of
+         * any messages published from the sender by the thread.
+         * It's every context pushed, each followed by ": ".
+         */
+        std::string prefix;
+
+        /**
+         * These are the lengths the prefix had before each context
+         * still on the stack was pushed, so that the prefix can be
+         * cut back when the context is popped.
+         */
+        std::vector< size_t > pushedPrefixLengths;
+    };
+
+    /**
+     * This is the number of empty context stacks a thread keeps around,
+     * for reuse, before throwing them away.  Keeping them lets contexts
+     * be pushed without allocating memory, once a thread has warmed up.
+     */
+    constexpr size_t MAX_IDLE_CONTEXT_STACKS = 8;
+
+    /**
+     * This is set once the diagnostic state of the current thread
+     * has been destroyed, which happens when the thread exits.
+     * Anything run by the thread after that, such as the destructor
+     * of a static or another thread-local object, acts as if the
+     * thread has no contexts pushed and isn't publishing anything.
+     */
+    thread_local bool threadStateDestroyed = false;
+
+    /**
+     * This holds the diagnostic state of one thread.
+     */
+    struct ThreadState {
+        /**
+         * These are the contexts pushed by the thread
+         * onto each DiagnosticsSender.
+         */
+        std::vector< ContextStack > contextStacks;
+
+        /**
+         * These identify the senders from which the thread is
+         * publishing messages.  They're used to avoid waiting for a
+         * message to be published from within a subscriber receiving it.
+         */
+        std::vector< uint64_t > publicationsInProgress;
+
+        /**
+         * This is the destructor of the structure.
+         */
+        ~ThreadState() {
+            threadStateDestroyed = true;
+        }
+    };
+
+    /**
+     * This is the diagnostic state of the current thread.
+     * It must only be reached through GetThreadState.
+     */
+    thread_local ThreadState threadState;
+
+    /**
+     * This function returns the diagnostic state of the current thread,
+     * unless it has already been destroyed.
+     *
+     * @return
+     *     The diagnostic state of the current thread is returned.
+     *
+     * @retval nullptr
+     *     This is returned if the diagnostic state of the
+     *     current thread has already been destroyed.
+     */
+    ThreadState* GetThreadState() {
+        if (threadStateDestroyed) {
+            return nullptr;
+        }
+        return &threadState;
+    }
+
+    /**
+     * This is used to give each DiagnosticsSender a unique identifier,
+     * so that context stacks are never confused between senders, even
+     * one made at the same address as another one destroyed.
+     */
+    std::atomic< uint64_t > nextSenderId(1);
+
+    /**
+     * This function finds the context prefix the current thread
+     * has pushed onto the given sender.
+     *
+     * @param[in] senderId
+     *     This identifies the sender whose context prefix to find.
+     *
+     * @return
+     *     A pointer to the context prefix the current thread has
+     *     pushed onto the given sender is returned.  It's only valid
+     *     until the thread next pushes or pops a context, so it must
+     *     not be used once a message starts being delivered.
+     *
+     * @retval nullptr
+     *     This is returned if the thread has no contexts pushed
+     *     onto the sender.
+     */
+    const std::string* FindContextPrefix(uint64_t senderId) {
+        const auto state = GetThreadState();
+        if (state == nullptr) {
+            return nullptr;
+        }
+        for (const auto& contextStack: state->contextStacks) {
+            if (
+                (contextStack.senderId == senderId)
+                && !contextStack.prefix.empty()
+            ) {
+                return &contextStack.prefix;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * This function returns the stack of contexts the current thread
+     * has pushed onto the given sender, making a new one if necessary.
+     *
+     * @param[in] senderId
+     *     This identifies the sender whose context stack to return.
+     *
+     * @param[in,out] contextStacks
+     *     These are the contexts the current thread has pushed
+     *     onto each sender.
+     *
+     * @return
+     *     The stack of contexts the current thread has pushed onto
+     *     the given sender is returned.
+     */
+    ContextStack& GetContextStack(
+        std::vector< ContextStack >& contextStacks,
+        uint64_t senderId
+    ) {
+        ContextStack* idleContextStack = nullptr;
+        for (auto& contextStack: contextStacks) {
+            if (contextStack.senderId == senderId) {
+                return contextStack;
+            }
+            if (contextStack.pushedPrefixLengths.empty()) {
+                idleContextStack = &contextStack;
+            }
+        }
+        if (idleContextStack != nullptr) {
+            idleContextStack->senderId = senderId;
+            idleContextStack->prefix.clear();
+            return *idleContextStack;
+        }
+        contextStacks.emplace_back();
+        auto& contextStack = contextStacks.back();
+        contextStack.senderId = senderId;
+        return contextStack;
+    }
+
+    /**
+     * This function throws away the empty context stacks of the current
+     * thread, if it has more of them than are worth keeping around.
+     *
+     * @param[in,out] contextStacks
+     *     These are the contexts the current thread has pushed
+     *     onto each sender.
+     */
+    void TrimIdleContextStacks(std::vector< ContextStack >& contextStacks) {
+        size_t numIdleContextStacks = 0;
+        for (const auto& contextStack: contextStacks) {
+            if (contextStack.pushedPrefixLengths.empty()) {
+                ++numIdleContextStacks;
+            }
+        }
+        if (numIdleContextStacks <= MAX_IDLE_CONTEXT_STACKS) {
+            return;
+        }
+        contextStacks.erase(
+            std::remove_if(
+                contextStacks.begin(),
+                contextStacks.end(),
+                [](const ContextStack& contextStack){
+                    return contextStack.pushedPrefixLengths.empty();
+                }
+            ),
+            contextStacks.end()
+        );
+    }
+
+    /**
+     * This marks the current thread as publishing a message from
+     * a sender, for as long as the object exists.
+     */
+    struct PublicationInProgress {
+        /**
+         * This is the diagnostic state of the thread, or null if it
+         * has already been destroyed, in which case nothing is marked.
+         */
+        ThreadState* const state;
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] senderId
+         *     This identifies the sender from which the thread
+         *     is publishing a message.
+         */
+        explicit PublicationInProgress(uint64_t senderId)
+            : state(GetThreadState())
+        {
+            if (state != nullptr) {
+                state->publicationsInProgress.push_back(senderId);
+            }
+        }
+
+        /**
+         * This is the destructor of the structure.
+         */
+        ~PublicationInProgress() {
+            if (state != nullptr) {
+                state->publicationsInProgress.pop_back();
+            }
+        }
+
+        PublicationInProgress(const PublicationInProgress&) = delete;
+        PublicationInProgress& operator=(const PublicationInProgress&) = delete;
     };
 
+    /**
+     * This function determines which kinds of subscribers
+     * desire to receive a message.
+     *
+     * @param[in] publication
+     *     This holds the subscriptions to check.
+     *
+     * @param[in] level
+     *     This is the level of the message.
+     *
+     * @param[out] anyRaw
+     *     This is set if any subscriber desiring to receive messages
+     *     before they're formatted desires to receive the message.
+     *
+     * @param[out] anyFormatted
+     *     This is set if any other subscriber desires
+     *     to receive the message.
+     */
+    void FindInterestedSubscribers(
+        const Publication& publication,
+        size_t level,
+        bool& anyRaw,
+        bool& anyFormatted
+    ) {
+        anyRaw = false;
+        anyFormatted = false;
+        for (const auto& subscription: publication.subscriptions) {
+            if (level < subscription.minLevel) {
+                continue;
+            }
+            if (subscription.rawDelegate) {
+                anyRaw = true;
+            } else {
+                anyFormatted = true;
+            }
+        }
+    }
+
+    /**
+     * This function returns an indication of whether or not
+     * the current thread is publishing a message from the given sender.
+     *
+     * @param[in] senderId
+     *     This identifies the sender to check.
+     *
+     * @return
+     *     An indication of whether or not the current thread is
+     *     publishing a message from the given sender is returned.
+     */
+    bool IsPublishing(uint64_t senderId) {
+        const auto state = GetThreadState();
+        if (state == nullptr) {
+            return false;
+        }
+        return (
+            std::find(
+                state->publicationsInProgress.begin(),
+                state->publicationsInProgress.end(),
+                senderId
+            ) != state->publicationsInProgress.end()
+        );
+    }
+
+    /**
+     * This function delivers a diagnostic message to a subscriber
+     * desiring to receive messages before they're formatted.
+     *
+     * @param[in] rawDelegate
+     *     This is the function to call to deliver the message.
+     *
+     * @param[in] senderName
+     *     This identifies the origin of the diagnostic information.
+     *
+     * @param[in] level
+     *     This is used to filter out less-important information.
+     *     The level is higher the more important the information is.
+     *
+     * @param[in] contextPrefix
+     *     This is the contextual information to put in front
+     *     of the message once it's formatted.
+     *
+     * @param[in] format
+     *     This is the formatting string to use as a guide to build
+     *     the message.
+     *
+     * @param[in] ...
+     *     These are the arguments to use to build the message.
+     */
+    void DeliverRaw(
+        const SystemAbstractions::DiagnosticsSender::DiagnosticRawMessageDelegate& rawDelegate,
+        const std::string& senderName,
+        size_t level,
+        const std::string& contextPrefix,
+        const char* format,
+        ...
+    ) {
+        va_list args;
+        va_start(args, format);
+        rawDelegate(senderName, level, contextPrefix, format, args);
+        va_end(args);
+    }
+
 }
 
 namespace SystemAbstractions {
@@ -89,10 +508,30 @@ namespace SystemAbstractions {
         std::string name;
 
         /**
-         * These are the current valid subscriptions
-         * to the diagnostic messages published by this sender.
+         * This uniquely identifies the sender, in order to find
+         * the contexts pushed onto it by each thread.
          */
-        std::map< SubscriptionToken, Subscription > subscribers;
+        const uint64_t id;
+
+        /**
+         * This holds the current subscriptions.
+         * It's only accessed with std::atomic_load and
+         * std::atomic_store, so that publishers never take the mutex,
+         * and so never wait for subscriptions to be formed or ended.
+         *
+         * @note
+         *     The standard library may still use a lock of its own
+         *     to make std::atomic_load and std::atomic_store atomic,
+         *     held only long enough to copy the pointer.
+         */
+        std::shared_ptr< const Publication > publication;
+
+        /**
+         * This becomes ready once the current subscriptions
+         * have been replaced and are no longer being used to
+         * publish any message.
+         */
+        std::future< void > publicationRetired;
 
         /**
          * This is the next token to use for the next
@@ -104,20 +543,142 @@ namespace SystemAbstractions {
          * This is the minimum of all minimum desired message
          * levels for all current subscribers.
          */
-        size_t minLevel = std::numeric_limits< size_t >::max();
+        std::atomic< size_t > minLevel;
 
         /**
-         * This is used to include extra contextual information
-         * in front of any messages published from this sender.
+         * This is used to synchronize changes to this object.
          */
-        std::deque< std::string > contextStack;
+        mutable std::mutex mutex;
+
+        // Methods
 
         /**
-         * This is used to synchronize access to this object.
+         * This is the constructor of the structure.
          */
-        mutable std::mutex mutex;
+        Impl()
+            : id(nextSenderId++)
+            , minLevel(std::numeric_limits< size_t >::max())
+        {
+            const auto initialPublication = std::make_shared< Publication >();
+            publicationRetired = initialPublication->retired.get_future();
+            publication = initialPublication;
+        }
 
-        // Methods
+        /**
+         * This is the destructor of the structure.  It throws away any
+         * contexts the destroying thread left pushed onto the sender.
+         * Contexts left pushed by other threads are only thrown away
+         * when those threads exit.
+         */
+        ~Impl() noexcept {
+            const auto state = GetThreadState();
+            if (state == nullptr) {
+                return;
+            }
+            for (auto& contextStack: state->contextStacks) {
+                if (contextStack.senderId == id) {
+                    contextStack.prefix.clear();
+                    contextStack.pushedPrefixLengths.clear();
+                    TrimIdleContextStacks(state->contextStacks);
+                    break;
+                }
+            }
+        }
+
+        /**
+         * This method replaces the current subscriptions.
+         *
+         * @note
+         *     The mutex must be held while calling this method.
+         *
+         * @param[in] newPublication
+         *     This holds the new subscriptions.
+         *
+         * @return
+         *     A future is returned which becomes ready once the old
+         *     subscriptions are no longer being used to publish
+         *     any message.
+         */
+        std::future< void > Replace(
+            const std::shared_ptr< Publication >& newPublication
+        ) {
+            size_t newMinLevel = std::numeric_limits< size_t >::max();
+            for (const auto& subscription: newPublication->subscriptions) {
+                newMinLevel = std::min(newMinLevel, subscription.minLevel);
+            }
+            auto oldPublicationRetired = std::move(publicationRetired);
+            publicationRetired = newPublication->retired.get_future();
+            std::atomic_store(
+                &publication,
+                std::shared_ptr< const Publication >(newPublication)
+            );
+            minLevel = newMinLevel;
+            return oldPublicationRetired;
+        }
+
+        /**
+         * This method forms a new subscription to diagnostic messages
+         * published by the sender.
+         *
+         * @param[in] impl
+         *     This is the sender to which to subscribe.
+         *
+         * @param[in] subscription
+         *     This holds the function to call to deliver messages,
+         *     and the minimum level of message desired.  Its token
+         *     is assigned by this method.
+         *
+         * @return
+         *     A function is returned which may be called
+         *     to terminate the subscription.
+         */
+        static UnsubscribeDelegate Subscribe(
+            const std::shared_ptr< Impl >& impl,
+            Subscription subscription
+        ) {
+            std::lock_guard< std::mutex > lock(impl->mutex);
+            const auto subscriptionToken = impl->nextSubscriptionToken++;
+            subscription.token = subscriptionToken;
+            const auto newPublication = std::make_shared< Publication >();
+            newPublication->subscriptions = impl->publication->subscriptions;
+            newPublication->subscriptions.push_back(std::move(subscription));
+            (void)impl->Replace(newPublication);
+            std::weak_ptr< Impl > implWeak(impl);
+            return [implWeak, subscriptionToken]{
+                const auto impl = implWeak.lock();
+                if (impl == nullptr) {
+                    return;
+                }
+                std::future< void > oldPublicationRetired;
+                {
+                    std::lock_guard< std::mutex > lock(impl->mutex);
+                    const auto newPublication = std::make_shared< Publication >();
+                    newPublication->subscriptions = impl->publication->subscriptions;
+                    auto& subscriptions = newPublication->subscriptions;
+                    const auto subscription = std::find_if(
+                        subscriptions.begin(),
+                        subscriptions.end(),
+                        [subscriptionToken](const Subscription& subscription){
+                            return (subscription.token == subscriptionToken);
+                        }
+                    );
+                    if (subscription == subscriptions.end()) {
+                        return;
+                    }
+                    (void)subscriptions.erase(subscription);
+                    oldPublicationRetired = impl->Replace(newPublication);
+                }
+
+                // Messages being published while the subscription was
+                // ended may still be delivered to the subscriber, so wait
+                // for them, unless this is being called from a subscriber
+                // in the middle of receiving one from the same sender
+                // (which would never end).
+                if (!IsPublishing(impl->id)) {
+                    oldPublicationRetired.wait();
+                }
+            };
+        }
 
         /**
          * This method publishes a static diagnostic message.
@@ -129,21 +690,142 @@ namespace SystemAbstractions {
          * @param[in] message
          *     This is the content of the message.
          */
-        void SendDiagnosticInformationString(size_t level, std::string message) const {
+        void SendDiagnosticInformationString(size_t level, const std::string& message) const {
             if (level < minLevel) {
                 return;
             }
-            std::lock_guard< decltype(mutex) > lock(mutex);
-            if (!contextStack.empty()) {
-                std::string contextChain;
-                for (auto context: contextStack) {
-                    contextChain = contextChain + context + ": ";
+            const auto currentPublication = std::atomic_load(&publication);
+            bool anyRaw, anyFormatted;
+            FindInterestedSubscribers(*currentPublication, level, anyRaw, anyFormatted);
+            const auto contextPrefix = FindContextPrefix(id);
+            if (contextPrefix == nullptr) {
+                PublicationInProgress publicationInProgress(id);
+                Deliver(*currentPublication, level, std::string(), message, message);
+                return;
+            }
+            std::string prefixedMessage;
+            if (anyFormatted) {
+                prefixedMessage.reserve(contextPrefix->length() + message.length());
+                prefixedMessage += *contextPrefix;
+                prefixedMessage += message;
+            }
+            const auto rawContextPrefix = (anyRaw ? *contextPrefix : std::string());
+            PublicationInProgress publicationInProgress(id);
+            Deliver(*currentPublication, level, rawContextPrefix, message, prefixedMessage);
+        }
+
+        /**
+         * This method publishes a diagnostic message formatted
+         * according to the rules and capabilities of the C standard library
+         * function "sprintf".  The message is formatted at most once,
+         * and only if a subscriber (other than a raw subscriber)
+         * desires to receive it.
+         *
+         * @param[in] level
+         *     This is used to filter out less-important information.
+         *     The level is higher the more important the information is.
+         *
+         * @param[in] format
+         *     This is the formatting string to use as a guide to build
+         *     the message.
+         *
+         * @param[in] args
+         *     These are the arguments to use to build the message.
+         */
+        void SendDiagnosticInformationFormatted(
+            size_t level,
+            const char* format,
+            va_list args
+        ) const {
+            const auto currentPublication = std::atomic_load(&publication);
+            bool anyRaw, anyFormatted;
+            FindInterestedSubscribers(*currentPublication, level, anyRaw, anyFormatted);
+            const auto contextPrefix = FindContextPrefix(id);
+            std::string message;
+            if (anyFormatted) {
+                if (contextPrefix != nullptr) {
+                    message = *contextPrefix;
                 }
-                message = contextChain + message;
+                va_list argsCopy;
+                va_copy(argsCopy, args);
+                message += StringExtensions::vsprintf(format, argsCopy);
+                va_end(argsCopy);
+            }
+            std::string rawContextPrefix;
+            if (
+                anyRaw
+                && (contextPrefix != nullptr)
+            ) {
+                rawContextPrefix = *contextPrefix;
             }
-            for (auto subscriber: subscribers) {
-                if (level >= subscriber.second.minLevel) {
-                    subscriber.second.delegate(name, level, message);
+            PublicationInProgress publicationInProgress(id);
+            for (const auto& subscription: currentPublication->subscriptions) {
+                if (level < subscription.minLevel) {
+                    continue;
+                }
+                if (subscription.rawDelegate) {
+                    va_list argsCopy;
+                    va_copy(argsCopy, args);
+                    subscription.rawDelegate(
+                        name,
+                        level,
+                        rawContextPrefix,
+                        format,
+                        argsCopy
+                    );
+                    va_end(argsCopy);
+                } else {
+                    subscription.delegate(name, level, message);
+                }
+            }
+        }
+
+        /**
+         * This method delivers a diagnostic message to the subscribers
+         * that desire to receive it.
+         *
+         * @param[in] currentPublication
+         *     This holds the subscriptions to which to deliver the message.
+         *
+         * @param[in] level
+         *     This is used to filter out less-important information.
+         *     The level is higher the more important the information is.
+         *
+         * @param[in] contextPrefix
+         *     This is the contextual information to put in front
+         *     of the message, given to subscribers desiring to receive
+         *     messages before they're formatted.
+         *
+         * @param[in] message
+         *     This is the content of the message, without any
+         *     context prefix.
+         *
+         * @param[in] prefixedMessage
+         *     This is the content of the message, including any
+         *     context prefix.
+         */
+        void Deliver(
+            const Publication& currentPublication,
+            size_t level,
+            const std::string& contextPrefix,
+            const std::string& message,
+            const std::string& prefixedMessage
+        ) const {
+            for (const auto& subscription: currentPublication.subscriptions) {
+                if (level < subscription.minLevel) {
+                    continue;
+                }
+                if (subscription.rawDelegate) {
+                    DeliverRaw(
+                        subscription.rawDelegate,
+                        name,
+                        level,
+                        contextPrefix,
+                        "%s",
+                        message.c_str()
+                    );
+                } else {
+                    subscription.delegate(name, level, prefixedMessage);
                 }
             }
         }
@@ -160,30 +842,11 @@ namespace SystemAbstractions {
     }
 
     auto DiagnosticsSender::SubscribeToDiagnostics(DiagnosticMessageDelegate delegate, size_t minLevel) -> UnsubscribeDelegate {
-        std::lock_guard< std::mutex > lock(impl_->mutex);
-        const auto subscriptionToken = impl_->nextSubscriptionToken++;
-        impl_->subscribers[subscriptionToken] = { delegate, minLevel };
-        impl_->minLevel = std::min(impl_->minLevel, minLevel);
-        std::weak_ptr< Impl > implWeak(impl_);
-        return [implWeak, subscriptionToken]{
-            const auto impl = implWeak.lock();
-            if (impl == nullptr) {
-                return;
-            }
-            std::lock_guard< std::mutex > lock(impl->mutex);
-            auto subscription = impl->subscribers.find(subscriptionToken);
-            if (subscription == impl->subscribers.end()) {
-                return;
-            }
-            Subscription oldSubscription(subscription->second);
-            (void)impl->subscribers.erase(subscription);
-            if (oldSubscription.minLevel == impl->minLevel) {
-                impl->minLevel = std::numeric_limits< size_t >::max();
-                for (auto subscriber: impl->subscribers) {
-                    impl->minLevel = std::min(impl->minLevel, subscriber.second.minLevel);
-                }
-            }
-        };
+        return Impl::Subscribe(impl_, Subscription(0, delegate, minLevel));
+    }
+
+    auto DiagnosticsSender::SubscribeToRawDiagnostics(DiagnosticRawMessageDelegate delegate, size_t minLevel) -> UnsubscribeDelegate {
+        return Impl::Subscribe(impl_, Subscription(0, delegate, minLevel));
     }
 
     auto DiagnosticsSender::Chain() const -> DiagnosticMessageDelegate {
@@ -218,19 +881,35 @@ namespace SystemAbstractions {
         }
         va_list args;
         va_start(args, format);
-        const std::string message = StringExtensions::vsprintf(format, args);
+        impl_->SendDiagnosticInformationFormatted(level, format, args);
         va_end(args);
-        impl_->SendDiagnosticInformationString(level, message);
     }
 
-    void DiagnosticsSender::PushContext(std::string context) {
-        std::lock_guard< std::mutex > lock(impl_->mutex);
-        impl_->contextStack.push_back(context);
+    void DiagnosticsSender::PushContext(const std::string& context) {
+        const auto state = GetThreadState();
+        if (state == nullptr) {
+            return;
+        }
+        auto& contextStack = GetContextStack(state->contextStacks, impl_->id);
+        contextStack.pushedPrefixLengths.push_back(contextStack.prefix.length());
+        contextStack.prefix += context;
+        contextStack.prefix += ": ";
     }
 
     void DiagnosticsSender::PopContext() {
-        std::lock_guard< std::mutex > lock(impl_->mutex);
-        impl_->contextStack.pop_back();
+        const auto state = GetThreadState();
+        if (state == nullptr) {
+            return;
+        }
+        auto& contextStack = GetContextStack(state->contextStacks, impl_->id);
+        if (contextStack.pushedPrefixLengths.empty()) {
+            return;
+        }
+        contextStack.prefix.resize(contextStack.pushedPrefixLengths.back());
+        contextStack.pushedPrefixLengths.pop_back();
+        if (contextStack.pushedPrefixLengths.empty()) {
+            TrimIdleContextStacks(state->contextStacks);
+        }
     }
 
 }
@@ -7,9 +7,168 @@
  * © 2014-2018 by Richard Walters
  */
 
+#include "MpscQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <errno.h>
+#include <functional>
+#include <map>
 #include <mutex>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
 #include <SystemAbstractions/DiagnosticsStreamReporter.hpp>
 #include <SystemAbstractions/Time.hpp>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sys/uio.h>
+#include <unistd.h>
+#endif /* not _WIN32 */
+
+namespace {
+
+    /**
+     * This is the maximum number of messages the thread of an
+     * AsyncDiagnosticsStreamReporter takes from its queue and
+     * writes at a time.
+     */
+    constexpr size_t MAX_BATCH_SIZE = 64;
+
+    /**
+     * This is the longest time a thread publishing a message will wait
+     * before checking again whether or not the queue of an
+     * AsyncDiagnosticsStreamReporter has room for it.
+     */
+    constexpr auto BLOCKED_PUBLISHER_POLL_INTERVAL = std::chrono::milliseconds(1);
+
+    /**
+     * This function formats a diagnostic message into a line of text
+     * for a log file.
+     *
+     * @param[out] line
+     *     This is where to put the formatted line.  Its memory is reused.
+     *
+     * @param[in] time
+     *     This is the time the message was received, relative to
+     *     when the reporter was made.
+     *
+     * @param[in] senderName
+     *     This identifies the origin of the diagnostic information.
+     *
+     * @param[in] level
+     *     This is used to filter out less-important information.
+     *     The level is higher the more important the information is.
+     *
+     * @param[in] message
+     *     This is the content of the message.
+     *
+     * @return
+     *     An indication of whether or not the line should go to the
+     *     error file, rather than the output file, is returned.
+     */
+    bool FormatLogLine(
+        std::string& line,
+        double time,
+        const std::string& senderName,
+        size_t level,
+        const std::string& message
+    ) {
+        char buffer[64];
+        (void)snprintf(buffer, sizeof(buffer), "[%.6lf ", time);
+        line.assign(buffer);
+        line += senderName;
+        (void)snprintf(buffer, sizeof(buffer), ":%zu] ", level);
+        line += buffer;
+        bool isError = true;
+        if (level >= SystemAbstractions::DiagnosticsSender::Levels::ERROR) {
+            line += "error: ";
+        } else if (level >= SystemAbstractions::DiagnosticsSender::Levels::WARNING) {
+            line += "warning: ";
+        } else {
+            isError = false;
+        }
+        line += message;
+        line += '\n';
+        return isError;
+    }
+
+    /**
+     * This holds a diagnostic message formatted by an
+     * AsyncDiagnosticsStreamReporter, waiting to be written.
+     */
+    struct Record {
+        /**
+         * This indicates whether or not the line should go to the
+         * error file, rather than the output file.
+         */
+        bool isError = false;
+
+        /**
+         * This is the formatted line to write.
+         */
+        std::string line;
+    };
+
+    /**
+     * This keeps track of the functions which flush each
+     * AsyncDiagnosticsStreamReporter in existence, so that they can all
+     * be flushed when the program exits.
+     */
+    struct FlushRegistry {
+        /**
+         * These are the functions which flush each reporter,
+         * keyed by the reporter.
+         */
+        std::map< const void*, std::function< void() > > flushers;
+
+        /**
+         * This is used to synchronize access to the registry.
+         */
+        std::mutex mutex;
+    };
+
+    /**
+     * This function flushes every AsyncDiagnosticsStreamReporter
+     * in existence.  It's called when the program exits.
+     */
+    void FlushAllReporters();
+
+    /**
+     * This function returns the registry of functions which flush
+     * each AsyncDiagnosticsStreamReporter in existence, making it,
+     * and arranging for it to be used when the program exits,
+     * the first time it's needed.
+     *
+     * @note
+     *     The registry is never destroyed, so that it's still
+     *     usable while the program exits.
+     *
+     * @return
+     *     The registry of functions which flush each
+     *     AsyncDiagnosticsStreamReporter in existence is returned.
+     */
+    FlushRegistry& GetFlushRegistry() {
+        static FlushRegistry* registry = []{
+            const auto newRegistry = new FlushRegistry();
+            (void)atexit(FlushAllReporters);
+            return newRegistry;
+        }();
+        return *registry;
+    }
+
+    void FlushAllReporters() {
+        auto& registry = GetFlushRegistry();
+        std::lock_guard< decltype(registry.mutex) > lock(registry.mutex);
+        for (const auto& flusher: registry.flushers) {
+            flusher.second();
+        }
+    }
+
+}
 
 namespace SystemAbstractions {
 
@@ -32,27 +191,494 @@ namespace SystemAbstractions {
             std::string message
         ) {
             std::lock_guard< std::mutex > lock(*mutex);
-            FILE* destination;
-            std::string prefix;
-            if (level >= DiagnosticsSender::Levels::ERROR) {
-                destination = error;
-                prefix = "error: ";
-            } else if (level >= DiagnosticsSender::Levels::WARNING) {
-                destination = error;
-                prefix = "warning: ";
-            } else {
-                destination = output;
-            }
-            fprintf(
-                destination,
-                "[%.6lf %s:%zu] %s%s\n",
-                time->GetTime() - timeReference,
-                senderName.c_str(),
-                level,
-                prefix.c_str(),
-                message.c_str()
+            std::string line;
+            FILE* destination = (
+                FormatLogLine(
+                    line,
+                    time->GetTime() - timeReference,
+                    senderName,
+                    level,
+                    message
+                )
+                ? error
+                : output
+            );
+            (void)fwrite(line.data(), 1, line.length(), destination);
+        };
+    }
+
+    /**
+     * This holds the private properties of the
+     * AsyncDiagnosticsStreamReporter class.
+     */
+    struct AsyncDiagnosticsStreamReporter::Impl {
+        // Properties
+
+        /**
+         * This is the file to which to print messages
+         * with levels under the warning level.
+         */
+        FILE* output = NULL;
+
+        /**
+         * This is the file to which to print messages
+         * with levels at or over the warning level.
+         */
+        FILE* error = NULL;
+
+        /**
+         * This is used to time-stamp messages.
+         */
+        Time time;
+
+        /**
+         * This is the time the reporter was made.
+         */
+        double timeReference = 0.0;
+
+        /**
+         * This selects what to do with a message published
+         * while the queue is full.
+         */
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+
+        /**
+         * This holds the formatted messages waiting to be written.
+         */
+        MpscQueue< Record > queue;
+
+        /**
+         * This is the number of messages which have been completely
+         * filled in and pushed onto the queue.  It's only counted once
+         * a push is finished, so that a slot still being filled in
+         * doesn't make the writer thread think there's work to do.
+         */
+        std::atomic< uint64_t > committed;
+
+        /**
+         * This is the number of messages which have been taken
+         * out of the queue, either to be written or thrown away.
+         */
+        std::atomic< uint64_t > taken;
+
+        /**
+         * This is the number of messages thrown away because
+         * the queue was full.
+         */
+        std::atomic< size_t > dropped;
+
+        /**
+         * This is the number of messages thrown away which have
+         * already been reported by printing a warning.
+         */
+        size_t droppedReported = 0;
+
+        /**
+         * This is the number of times the Flush method has been called.
+         */
+        uint64_t flushesRequested = 0;
+
+        /**
+         * This is the number of calls to the Flush method which
+         * have been carried out.
+         */
+        uint64_t flushesCompleted = 0;
+
+        /**
+         * This is the queue position which the writer thread must
+         * reach before carrying out the most recently requested flush.
+         * Every message published before the flush was requested
+         * is at a position below it.
+         */
+        size_t flushPosition = 0;
+
+        /**
+         * This flag indicates whether or not the writer thread
+         * should stop once the queue is empty.
+         */
+        bool stop = false;
+
+        /**
+         * This is used to make sure only one thread at a time takes
+         * messages out of the queue.  Normally this is the writer thread,
+         * but publishers also do so to throw away the oldest message
+         * when the queue is full and the policy says to do so.
+         */
+        std::mutex popMutex;
+
+        /**
+         * This is used to synchronize the writer thread with
+         * publishers and callers of the Flush method.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake up the writer thread when there's
+         * something for it to do.
+         */
+        std::condition_variable writerWakeCondition;
+
+        /**
+         * This is used to wake up publishers waiting for room
+         * in the queue, and callers waiting for a flush to complete.
+         */
+        std::condition_variable progressCondition;
+
+        /**
+         * This is the thread which writes messages from the queue.
+         */
+        std::thread writer;
+
+        // Methods
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] queueCapacity
+         *     This is the minimum number of messages which can be
+         *     waiting to be printed at once.
+         */
+        explicit Impl(size_t queueCapacity)
+            : queue(queueCapacity)
+            , committed(0)
+            , taken(0)
+            , dropped(0)
+        {
+        }
+
+        /**
+         * This method formats the given diagnostic message and queues
+         * it up to be written, dealing with a full queue according
+         * to the overflow policy.
+         *
+         * @param[in] senderName
+         *     This identifies the origin of the diagnostic information.
+         *
+         * @param[in] level
+         *     This is used to filter out less-important information.
+         *     The level is higher the more important the information is.
+         *
+         * @param[in] message
+         *     This is the content of the message.
+         */
+        void Publish(
+            const std::string& senderName,
+            size_t level,
+            const std::string& message
+        ) {
+            const auto messageTime = time.GetTime() - timeReference;
+            const auto fill = [&](Record& record){
+                record.isError = FormatLogLine(
+                    record.line,
+                    messageTime,
+                    senderName,
+                    level,
+                    message
+                );
+            };
+            while (!queue.TryPush(fill)) {
+                switch (overflowPolicy) {
+                    case OverflowPolicy::Block: {
+                        std::unique_lock< decltype(mutex) > lock(mutex);
+                        if (stop) {
+                            ++dropped;
+                            return;
+                        }
+                        writerWakeCondition.notify_one();
+                        (void)progressCondition.wait_for(lock, BLOCKED_PUBLISHER_POLL_INTERVAL);
+                    } break;
+
+                    case OverflowPolicy::DropOldest: {
+                        std::lock_guard< decltype(popMutex) > lock(popMutex);
+                        if (queue.TryPop([](Record&){})) {
+                            ++taken;
+                            ++dropped;
+                        }
+                    } break;
+
+                    case OverflowPolicy::DropNewest:
+                    default: {
+                        ++dropped;
+                    } return;
+                }
+            }
+
+            // The writer thread only goes to sleep once it has taken
+            // every message committed, so it only needs waking up
+            // if that was the case before this one was committed.
+            if (committed++ <= taken) {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                writerWakeCondition.notify_one();
+            }
+        }
+
+        /**
+         * This method writes the given formatted messages,
+         * grouping together those going to the same file.
+         *
+         * @param[in] batch
+         *     These are the formatted messages to write.
+         *
+         * @param[in] batchSize
+         *     This is the number of messages to write.
+         */
+        void Write(const std::vector< Record >& batch, size_t batchSize) {
+            size_t start = 0;
+            while (start < batchSize) {
+                const auto isError = batch[start].isError;
+                auto end = start + 1;
+                while (
+                    (end < batchSize)
+                    && (batch[end].isError == isError)
+                ) {
+                    ++end;
+                }
+                const auto destination = (isError ? error : output);
+#ifdef _WIN32
+                for (size_t i = start; i < end; ++i) {
+                    (void)fwrite(batch[i].line.data(), 1, batch[i].line.length(), destination);
+                }
+                (void)fflush(destination);
+#else /* not _WIN32 */
+                // Anything written to the file through the C library
+                // must go out first, to keep lines in order.
+                (void)fflush(destination);
+                struct iovec vectors[MAX_BATCH_SIZE];
+                size_t numVectors = 0;
+                for (size_t i = start; i < end; ++i) {
+                    vectors[numVectors].iov_base = (void*)batch[i].line.data();
+                    vectors[numVectors].iov_len = batch[i].line.length();
+                    ++numVectors;
+                }
+                const auto handle = fileno(destination);
+                struct iovec* nextVector = vectors;
+                while (numVectors > 0) {
+                    auto amountWritten = writev(handle, nextVector, (int)numVectors);
+                    if (amountWritten < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        dropped += numVectors;
+                        break;
+                    }
+                    while (
+                        (numVectors > 0)
+                        && ((size_t)amountWritten >= nextVector->iov_len)
+                    ) {
+                        amountWritten -= (ssize_t)nextVector->iov_len;
+                        ++nextVector;
+                        --numVectors;
+                    }
+                    if (numVectors > 0) {
+                        nextVector->iov_base = (char*)nextVector->iov_base + amountWritten;
+                        nextVector->iov_len -= (size_t)amountWritten;
+                    }
+                }
+#endif /* _WIN32 / not _WIN32 */
+                start = end;
+            }
+        }
+
+        /**
+         * This method prints a warning if more messages have been
+         * thrown away since the last time it was called.
+         */
+        void ReportDropped() {
+            const size_t droppedNow = dropped;
+            if (droppedNow == droppedReported) {
+                return;
+            }
+            std::vector< Record > report(1);
+            report[0].isError = FormatLogLine(
+                report[0].line,
+                time.GetTime() - timeReference,
+                "AsyncDiagnosticsStreamReporter",
+                DiagnosticsSender::Levels::WARNING,
+                std::to_string(droppedNow - droppedReported)
+                + " diagnostic message(s) dropped because the queue was full"
+                " or the log file could not be written"
+            );
+            droppedReported = droppedNow;
+            Write(report, 1);
+        }
+
+        /**
+         * This is the function run by the writer thread.  It takes
+         * messages out of the queue in batches and writes them,
+         * and carries out flushes, until told to stop.
+         */
+        void Work() {
+            std::vector< Record > batch(MAX_BATCH_SIZE);
+            for (;;) {
+                size_t batchSize = 0;
+                size_t popPosition = 0;
+                {
+                    std::lock_guard< decltype(popMutex) > lock(popMutex);
+                    while (
+                        (batchSize < MAX_BATCH_SIZE)
+                        && queue.TryPop(
+                            [&batch, batchSize](Record& record){
+                                batch[batchSize].isError = record.isError;
+                                batch[batchSize].line.swap(record.line);
+                            }
+                        )
+                    ) {
+                        ++batchSize;
+                    }
+                    popPosition = queue.GetPopPosition();
+                }
+                if (batchSize > 0) {
+                    taken += batchSize;
+                    if (overflowPolicy == OverflowPolicy::Block) {
+                        std::lock_guard< decltype(mutex) > lock(mutex);
+                        progressCondition.notify_all();
+                    }
+                }
+                ReportDropped();
+                Write(batch, batchSize);
+                std::unique_lock< decltype(mutex) > lock(mutex);
+
+                // Everything below the pop position has now either been
+                // written or thrown away, so any flush requested
+                // no later than that can be carried out.
+                if (
+                    (flushesCompleted != flushesRequested)
+                    && (popPosition >= flushPosition)
+                ) {
+                    (void)fflush(output);
+                    (void)fflush(error);
+                    flushesCompleted = flushesRequested;
+                    progressCondition.notify_all();
+                }
+                if (batchSize > 0) {
+                    continue;
+                }
+                const auto behind = (
+                    (committed > taken)
+                    || (flushesCompleted != flushesRequested)
+                    || (
+                        stop
+                        && (popPosition != queue.GetPushPosition())
+                    )
+                );
+                if (behind) {
+                    // A message is still being filled in at the front
+                    // of the queue, holding up everything behind it.
+                    // Its publisher is about to finish it.
+                    lock.unlock();
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (stop) {
+                    break;
+                }
+                writerWakeCondition.wait(
+                    lock,
+                    [this]{
+                        return (
+                            stop
+                            || (committed > taken)
+                            || (flushesCompleted != flushesRequested)
+                        );
+                    }
+                );
+            }
+        }
+
+        /**
+         * This method stops the writer thread, once it has written
+         * every message queued, and takes the reporter out of the
+         * registry of reporters to flush when the program exits.
+         */
+        void Stop() {
+            {
+                auto& registry = GetFlushRegistry();
+                std::lock_guard< decltype(registry.mutex) > lock(registry.mutex);
+                (void)registry.flushers.erase(this);
+            }
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                stop = true;
+                writerWakeCondition.notify_one();
+            }
+            writer.join();
+            (void)fflush(output);
+            (void)fflush(error);
+        }
+
+        /**
+         * This method blocks until all messages published before
+         * it was called have been printed and flushed.
+         */
+        void Flush() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            const auto flushRequest = ++flushesRequested;
+            flushPosition = queue.GetPushPosition();
+            writerWakeCondition.notify_one();
+            progressCondition.wait(
+                lock,
+                [this, flushRequest]{ return (flushesCompleted >= flushRequest); }
             );
+        }
+    };
+
+    AsyncDiagnosticsStreamReporter::~AsyncDiagnosticsStreamReporter() noexcept {
+        if (impl_ == nullptr) {
+            return;
+        }
+        impl_->Stop();
+    }
+    AsyncDiagnosticsStreamReporter::AsyncDiagnosticsStreamReporter(AsyncDiagnosticsStreamReporter&&) noexcept = default;
+    AsyncDiagnosticsStreamReporter& AsyncDiagnosticsStreamReporter::operator=(AsyncDiagnosticsStreamReporter&& other) noexcept {
+        if (this != &other) {
+            if (impl_ != nullptr) {
+                impl_->Stop();
+            }
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    AsyncDiagnosticsStreamReporter::AsyncDiagnosticsStreamReporter(
+        FILE* output,
+        FILE* error,
+        size_t queueCapacity,
+        OverflowPolicy overflowPolicy
+    )
+        : impl_(std::make_shared< Impl >(queueCapacity))
+    {
+        impl_->output = output;
+        impl_->error = error;
+        impl_->timeReference = impl_->time.GetTime();
+        impl_->overflowPolicy = overflowPolicy;
+        impl_->writer = std::thread(&Impl::Work, impl_.get());
+        const auto impl = impl_.get();
+        auto& registry = GetFlushRegistry();
+        std::lock_guard< decltype(registry.mutex) > lock(registry.mutex);
+        registry.flushers[impl] = [impl]{ impl->Flush(); };
+    }
+
+    DiagnosticsSender::DiagnosticMessageDelegate AsyncDiagnosticsStreamReporter::GetDelegate() const {
+        std::weak_ptr< Impl > implWeak(impl_);
+        return [implWeak](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ) {
+            const auto impl = implWeak.lock();
+            if (impl == nullptr) {
+                return;
+            }
+            impl->Publish(senderName, level, message);
         };
     }
 
+    void AsyncDiagnosticsStreamReporter::Flush() {
+        impl_->Flush();
+    }
+
+    size_t AsyncDiagnosticsStreamReporter::GetDroppedCount() const {
+        return impl_->dropped;
+    }
+
 }
@@ -56,4 +56,17 @@ namespace SystemAbstractions {
         return File::Impl::CreatePath(directoryWithSeparator);
     }
 
+    bool File::DeleteDirectory(const std::string& directory) {
+        DirectoryOperationResult result;
+        return DeleteDirectory(directory, result);
+    }
+
+    bool File::CopyDirectory(
+        const std::string& existingDirectory,
+        const std::string& newDirectory
+    ) {
+        DirectoryOperationResult result;
+        return CopyDirectory(existingDirectory, newDirectory, result);
+    }
+
 }
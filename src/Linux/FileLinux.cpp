@@ -11,6 +11,8 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <linux/fs.h>
 #include <pwd.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -19,7 +21,10 @@
 #include <string>
 #include <string.h>
 #include <StringExtensions/StringExtensions.hpp>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <SystemAbstractions/File.hpp>
 #include <unistd.h>
@@ -27,6 +32,143 @@
 
 namespace SystemAbstractions {
 
+    bool File::Platform::CopyContents(int source, int destination) {
+#ifdef FICLONE
+        // Try to have the file system share the source file's blocks
+        // with the destination file (a "reflink"), which copies nothing.
+        if (ioctl(destination, FICLONE, source) == 0) {
+            return true;
+        }
+#endif /* FICLONE */
+        struct stat s;
+        if (fstat(source, &s) != 0) {
+            return false;
+        }
+        const auto size = (uint64_t)s.st_size;
+        uint64_t copied = 0;
+#ifdef SYS_copy_file_range
+        // Have the kernel copy the data, which some file systems can
+        // do without reading it, and all can do without passing
+        // it through user space.
+        while (copied < size) {
+            loff_t sourceOffset = (loff_t)copied;
+            loff_t destinationOffset = (loff_t)copied;
+            const auto result = syscall(
+                SYS_copy_file_range,
+                source,
+                &sourceOffset,
+                destination,
+                &destinationOffset,
+                (size_t)(size - copied),
+                0
+            );
+            if (result <= 0) {
+                break;
+            }
+            copied += (uint64_t)result;
+        }
+#endif /* SYS_copy_file_range */
+        // Older kernels can't copy between files with copy_file_range,
+        // or between different file systems, but can with sendfile.
+        if (
+            (copied < size)
+            && (lseek(destination, (off_t)copied, SEEK_SET) == (off_t)copied)
+        ) {
+            while (copied < size) {
+                off_t sourceOffset = (off_t)copied;
+                const auto result = sendfile(
+                    destination,
+                    source,
+                    &sourceOffset,
+                    (size_t)(size - copied)
+                );
+                if (result <= 0) {
+                    break;
+                }
+                copied += (uint64_t)result;
+            }
+        }
+        return CopyContentsThroughBuffer(source, destination, copied);
+    }
+
+    bool File::Platform::Preallocate(
+        int handle,
+        uint64_t position,
+        uint64_t numBytes,
+        bool changeSize
+    ) {
+        if (numBytes == 0) {
+            return true;
+        }
+        if (
+            fallocate(
+                handle,
+                (changeSize ? 0 : FALLOC_FL_KEEP_SIZE),
+                (off_t)position,
+                (off_t)numBytes
+            ) == 0
+        ) {
+            return true;
+        }
+        // posix_fallocate writes zeroes to reserve storage on file
+        // systems which can't do it any other way, but that always
+        // changes the size of the file.
+        if (
+            changeSize
+            && (errno == EOPNOTSUPP)
+        ) {
+            return (posix_fallocate(handle, (off_t)position, (off_t)numBytes) == 0);
+        }
+        return false;
+    }
+
+    bool File::Platform::PunchHole(
+        int handle,
+        uint64_t position,
+        uint64_t numBytes
+    ) {
+        if (numBytes == 0) {
+            return true;
+        }
+#ifdef FALLOC_FL_PUNCH_HOLE
+        return (
+            fallocate(
+                handle,
+                FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                (off_t)position,
+                (off_t)numBytes
+            ) == 0
+        );
+#else /* not FALLOC_FL_PUNCH_HOLE */
+        return false;
+#endif /* FALLOC_FL_PUNCH_HOLE / not FALLOC_FL_PUNCH_HOLE */
+    }
+
+    bool File::Platform::Sync(int handle, SyncMode mode) {
+        switch (mode) {
+            case SyncMode::None: {
+                return true;
+            }
+
+            case SyncMode::StartWriteback: {
+#ifdef SYNC_FILE_RANGE_WRITE
+                return (sync_file_range(handle, 0, 0, SYNC_FILE_RANGE_WRITE) == 0);
+#else /* not SYNC_FILE_RANGE_WRITE */
+                return (fdatasync(handle) == 0);
+#endif /* SYNC_FILE_RANGE_WRITE / not SYNC_FILE_RANGE_WRITE */
+            }
+
+            case SyncMode::Data: {
+                return (fdatasync(handle) == 0);
+            }
+
+            case SyncMode::Full:
+            default: {
+                return (fsync(handle) == 0);
+            }
+        }
+    }
+
     std::string File::GetExeImagePath() {
         // Path to self is always available through procfs /proc/self/exe.
         // This is a link, so use realpath to reduce the path to
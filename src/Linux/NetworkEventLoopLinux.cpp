@@ -0,0 +1,324 @@
+/**
+ * @file NetworkEventLoopLinux.cpp
+ *
+ * This module contains the Linux implementation of the
+ * SystemAbstractions::NetworkEventLoop class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "../Posix/NetworkEventLoop.hpp"
+#include "../Posix/PipeSignal.hpp"
+
+#include <errno.h>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the maximum number of events to collect from
+     * the operating system in one wait.
+     */
+    constexpr size_t MAXIMUM_EVENTS_PER_WAIT = 256;
+
+    /**
+     * This is the registration identifier used for the signal
+     * which tells a worker thread to stop.
+     */
+    constexpr uint64_t STOP_SIGNAL_ID = 0;
+
+    /**
+     * This is a helper function which computes the set of epoll events
+     * to wait for, given the desired readiness conditions.
+     *
+     * @param[in] read
+     *     This indicates whether or not to wait for readability.
+     *
+     * @param[in] write
+     *     This indicates whether or not to wait for writability.
+     *
+     * @return
+     *     The set of epoll events to wait for is returned.
+     */
+    uint32_t EpollEvents(bool read, bool write) {
+        uint32_t events = 0;
+        if (read) {
+            events |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (write) {
+            events |= EPOLLOUT;
+        }
+        return events;
+    }
+
+}
+
+namespace SystemAbstractions {
+
+    /**
+     * This holds the state of one worker thread of the event loop.
+     */
+    struct Worker {
+        // Lifecycle management
+
+        ~Worker() noexcept {
+            if (epoll >= 0) {
+                (void)close(epoll);
+            }
+        }
+
+        // Properties
+
+        /**
+         * This is the epoll instance used by the worker thread
+         * to wait for its sockets.
+         */
+        int epoll = -1;
+
+        /**
+         * This is used to tell the worker thread to stop.
+         */
+        PipeSignal stopSignal;
+
+        /**
+         * This is the worker thread itself.
+         */
+        std::thread thread;
+
+        /**
+         * This is used to synchronize access to the registrations.
+         */
+        std::mutex mutex;
+
+        /**
+         * These are the sockets registered with this worker thread,
+         * keyed by registration identifier.
+         */
+        std::unordered_map<
+            uint64_t,
+            std::shared_ptr< NetworkEventLoop::Registration >
+        > registrations;
+
+        // Methods
+
+        /**
+         * This is the main function of the worker thread.
+         *
+         * @note
+         *     The worker thread holds its own reference to the worker,
+         *     because the event loop may be destroyed from one of its
+         *     own callbacks, in which case the thread is detached
+         *     and must be able to finish up on its own.
+         */
+        void Run();
+    };
+
+    /**
+     * This represents the registration of one socket with
+     * the event loop.
+     */
+    struct NetworkEventLoop::Registration {
+        /**
+         * This is the operating system handle of the socket.
+         */
+        int handle = -1;
+
+        /**
+         * This uniquely identifies the registration, and is what
+         * epoll hands back to the worker thread when the socket
+         * becomes ready.  This is used rather than a pointer so that
+         * events already collected for a socket which has since been
+         * removed are safely ignored.
+         */
+        uint64_t id = 0;
+
+        /**
+         * This is the worker thread servicing the socket.
+         */
+        Worker* worker = nullptr;
+
+        /**
+         * This is the callback to issue whenever the socket
+         * becomes ready.
+         */
+        ReadyDelegate readyDelegate;
+    };
+
+    void Worker::Run() {
+        std::vector< struct epoll_event > events(MAXIMUM_EVENTS_PER_WAIT);
+        std::vector< std::shared_ptr< NetworkEventLoop::Registration > > ready;
+        for (;;) {
+            const int numEvents = epoll_wait(epoll, events.data(), (int)events.size(), -1);
+            if (numEvents < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            bool stop = false;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                for (int i = 0; i < numEvents; ++i) {
+                    const auto id = events[i].data.u64;
+                    if (id == STOP_SIGNAL_ID) {
+                        stop = true;
+                        continue;
+                    }
+                    const auto registration = registrations.find(id);
+                    if (registration != registrations.end()) {
+                        ready.push_back(registration->second);
+                    }
+                }
+            }
+            if (stop) {
+                break;
+            }
+            for (const auto& registration: ready) {
+                registration->readyDelegate();
+            }
+            ready.clear();
+        }
+    }
+
+    /**
+     * This contains the private properties of a NetworkEventLoop instance.
+     */
+    struct NetworkEventLoop::Impl {
+        /**
+         * These are the worker threads of the event loop.
+         */
+        std::vector< std::shared_ptr< Worker > > workers;
+
+        /**
+         * This is the index of the worker thread to which
+         * the next socket added will be assigned.
+         */
+        size_t nextWorker = 0;
+
+        /**
+         * This is the identifier to assign to the next socket added.
+         */
+        uint64_t nextId = STOP_SIGNAL_ID + 1;
+
+        /**
+         * This is a human-readable string indicating the last error that
+         * occurred in another method of the instance.
+         */
+        std::string lastError;
+
+        /**
+         * This is used to synchronize access to the object.
+         */
+        mutable std::mutex mutex;
+    };
+
+    NetworkEventLoop::~NetworkEventLoop() noexcept {
+        for (auto& worker: impl_->workers) {
+            if (worker->thread.joinable()) {
+                worker->stopSignal.Set();
+                if (std::this_thread::get_id() == worker->thread.get_id()) {
+                    worker->thread.detach();
+                } else {
+                    worker->thread.join();
+                }
+            }
+        }
+    }
+
+    NetworkEventLoop::NetworkEventLoop()
+        : impl_(new Impl())
+    {
+    }
+
+    bool NetworkEventLoop::Initialize(size_t numThreads) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (!impl_->workers.empty()) {
+            return true;
+        }
+        for (size_t i = 0; i < numThreads; ++i) {
+            const auto worker = std::make_shared< Worker >();
+            worker->epoll = epoll_create1(EPOLL_CLOEXEC);
+            if (worker->epoll < 0) {
+                impl_->lastError = strerror(errno);
+                return false;
+            }
+            if (!worker->stopSignal.Initialize()) {
+                impl_->lastError = worker->stopSignal.GetLastError();
+                return false;
+            }
+            worker->stopSignal.Clear();
+            struct epoll_event event;
+            (void)memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.u64 = STOP_SIGNAL_ID;
+            if (epoll_ctl(worker->epoll, EPOLL_CTL_ADD, worker->stopSignal.GetSelectHandle(), &event) != 0) {
+                impl_->lastError = strerror(errno);
+                return false;
+            }
+            worker->thread = std::thread([worker]{ worker->Run(); });
+            impl_->workers.push_back(worker);
+        }
+        return true;
+    }
+
+    std::string NetworkEventLoop::GetLastError() const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->lastError;
+    }
+
+    auto NetworkEventLoop::Add(
+        int handle,
+        ReadyDelegate readyDelegate
+    ) -> std::shared_ptr< Registration > {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->workers.empty()) {
+            impl_->lastError = "event loop not initialized";
+            return nullptr;
+        }
+        const auto registration = std::make_shared< Registration >();
+        registration->handle = handle;
+        registration->id = impl_->nextId++;
+        registration->worker = impl_->workers[impl_->nextWorker].get();
+        registration->readyDelegate = readyDelegate;
+        impl_->nextWorker = (impl_->nextWorker + 1) % impl_->workers.size();
+        auto& worker = *registration->worker;
+        std::lock_guard< decltype(worker.mutex) > workerLock(worker.mutex);
+        struct epoll_event event;
+        (void)memset(&event, 0, sizeof(event));
+        event.events = EpollEvents(true, false);
+        event.data.u64 = registration->id;
+        if (epoll_ctl(worker.epoll, EPOLL_CTL_ADD, handle, &event) != 0) {
+            impl_->lastError = strerror(errno);
+            return nullptr;
+        }
+        worker.registrations[registration->id] = registration;
+        return registration;
+    }
+
+    void NetworkEventLoop::SetInterest(
+        const std::shared_ptr< Registration >& registration,
+        bool read,
+        bool write
+    ) {
+        struct epoll_event event;
+        (void)memset(&event, 0, sizeof(event));
+        event.events = EpollEvents(read, write);
+        event.data.u64 = registration->id;
+        (void)epoll_ctl(registration->worker->epoll, EPOLL_CTL_MOD, registration->handle, &event);
+    }
+
+    void NetworkEventLoop::Remove(const std::shared_ptr< Registration >& registration) {
+        auto& worker = *registration->worker;
+        std::lock_guard< decltype(worker.mutex) > workerLock(worker.mutex);
+        (void)epoll_ctl(worker.epoll, EPOLL_CTL_DEL, registration->handle, NULL);
+        (void)worker.registrations.erase(registration->id);
+    }
+
+}
@@ -0,0 +1,88 @@
+/**
+ * @file PipeSignalLinux.cpp
+ *
+ * This module contains the Linux implementation of the
+ * SystemAbstractions::PipeSignal class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "../Posix/PipeSignal.hpp"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace SystemAbstractions {
+
+    /**
+     * This contains the private properties and methods of the class.
+     */
+    struct PipeSignalImpl {
+        /**
+         * This is the event object which is used to carry the state of
+         * the signal.  Its counter is nonzero while the signal is set,
+         * no matter how many times the signal was set.
+         */
+        int event = -1;
+
+        /**
+         * This is a human-readable string indicating the last error that
+         * occurred in another method of the instance.
+         */
+        std::string lastError;
+    };
+
+    PipeSignal::PipeSignal()
+        : impl_(new PipeSignalImpl())
+    {
+    }
+
+    PipeSignal::~PipeSignal() {
+        if (impl_->event >= 0) {
+            (void)close(impl_->event);
+        }
+    }
+
+    bool PipeSignal::Initialize() {
+        if (impl_->event >= 0) {
+            return true;
+        }
+        impl_->event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (impl_->event < 0) {
+            impl_->lastError = strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    std::string PipeSignal::GetLastError() const {
+        return impl_->lastError;
+    }
+
+    void PipeSignal::Set() {
+        const uint64_t increment = 1;
+        (void)write(impl_->event, &increment, sizeof(increment));
+    }
+
+    void PipeSignal::Clear() {
+        uint64_t count;
+        (void)read(impl_->event, &count, sizeof(count));
+    }
+
+    bool PipeSignal::IsSet() const {
+        struct pollfd pollfd;
+        pollfd.fd = impl_->event;
+        pollfd.events = POLLIN;
+        pollfd.revents = 0;
+        return (poll(&pollfd, 1, 0) > 0);
+    }
+
+    int PipeSignal::GetSelectHandle() const {
+        return impl_->event;
+    }
+
+}
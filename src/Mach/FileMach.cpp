@@ -9,10 +9,12 @@
 
 #include "../Posix/FilePosix.hpp"
 
+#include <copyfile.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <dirent.h>
 #include <mach-o/dyld.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -29,6 +31,99 @@
 
 namespace SystemAbstractions {
 
+    bool File::Platform::CopyContents(int source, int destination) {
+        if (fcopyfile(source, destination, NULL, COPYFILE_DATA) == 0) {
+            return true;
+        }
+        return CopyContentsThroughBuffer(source, destination, 0);
+    }
+
+    bool File::Platform::Preallocate(
+        int handle,
+        uint64_t position,
+        uint64_t numBytes,
+        bool changeSize
+    ) {
+        if (numBytes == 0) {
+            return true;
+        }
+        struct stat s;
+        if (fstat(handle, &s) != 0) {
+            return false;
+        }
+        const auto end = position + numBytes;
+        const auto allocated = (uint64_t)s.st_blocks * 512;
+        if (end > allocated) {
+            // F_PREALLOCATE reserves storage starting at the end of
+            // what's already allocated, so ask for the difference,
+            // contiguous if possible.
+            fstore_t store;
+            store.fst_flags = F_ALLOCATECONTIG | F_ALLOCATEALL;
+            store.fst_posmode = F_PEOFPOSMODE;
+            store.fst_offset = 0;
+            store.fst_length = (off_t)(end - allocated);
+            store.fst_bytesalloc = 0;
+            if (fcntl(handle, F_PREALLOCATE, &store) != 0) {
+                store.fst_flags = F_ALLOCATEALL;
+                if (fcntl(handle, F_PREALLOCATE, &store) != 0) {
+                    return false;
+                }
+            }
+        }
+        if (
+            changeSize
+            && (end > (uint64_t)s.st_size)
+        ) {
+            return (ftruncate(handle, (off_t)end) == 0);
+        }
+        return true;
+    }
+
+    bool File::Platform::PunchHole(
+        int handle,
+        uint64_t position,
+        uint64_t numBytes
+    ) {
+        if (numBytes == 0) {
+            return true;
+        }
+#ifdef F_PUNCHHOLE
+        fpunchhole_t hole;
+        hole.fp_flags = 0;
+        hole.reserved = 0;
+        hole.fp_offset = (off_t)position;
+        hole.fp_length = (off_t)numBytes;
+        return (fcntl(handle, F_PUNCHHOLE, &hole) == 0);
+#else /* not F_PUNCHHOLE */
+        return false;
+#endif /* F_PUNCHHOLE / not F_PUNCHHOLE */
+    }
+
+    bool File::Platform::Sync(int handle, SyncMode mode) {
+        switch (mode) {
+            case SyncMode::None: {
+                return true;
+            }
+
+            case SyncMode::StartWriteback:
+            case SyncMode::Data: {
+                // The data is handed to the storage device, but may
+                // still be sitting in the device's own cache.
+                return (fsync(handle) == 0);
+            }
+
+            case SyncMode::Full:
+            default: {
+                // Only F_FULLFSYNC has the storage device flush its own
+                // cache, but not all file systems support it.
+                if (fcntl(handle, F_FULLFSYNC) == 0) {
+                    return true;
+                }
+                return (fsync(handle) == 0);
+            }
+        }
+    }
+
     std::string File::GetExeImagePath() {
         // Get the path to the executable.
         std::vector< char > buffer(PATH_MAX);
@@ -0,0 +1,62 @@
+/**
+ * @file NetworkEventLoopMach.cpp
+ *
+ * This module contains the Mach implementation of the
+ * SystemAbstractions::NetworkEventLoop class.
+ *
+ * Shared event loops are not yet implemented for this platform,
+ * so network connections each use their own worker thread.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "../Posix/NetworkEventLoop.hpp"
+
+namespace SystemAbstractions {
+
+    /**
+     * This represents the registration of one socket with
+     * the event loop.
+     */
+    struct NetworkEventLoop::Registration {
+    };
+
+    /**
+     * This contains the private properties of a NetworkEventLoop instance.
+     */
+    struct NetworkEventLoop::Impl {
+    };
+
+    NetworkEventLoop::~NetworkEventLoop() noexcept = default;
+
+    NetworkEventLoop::NetworkEventLoop()
+        : impl_(new Impl())
+    {
+    }
+
+    bool NetworkEventLoop::Initialize(size_t) {
+        return false;
+    }
+
+    std::string NetworkEventLoop::GetLastError() const {
+        return "not supported on this platform";
+    }
+
+    auto NetworkEventLoop::Add(
+        int,
+        ReadyDelegate
+    ) -> std::shared_ptr< Registration > {
+        return nullptr;
+    }
+
+    void NetworkEventLoop::SetInterest(
+        const std::shared_ptr< Registration >&,
+        bool,
+        bool
+    ) {
+    }
+
+    void NetworkEventLoop::Remove(const std::shared_ptr< Registration >&) {
+    }
+
+}
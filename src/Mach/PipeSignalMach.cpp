@@ -1,13 +1,13 @@
 /**
- * @file PipeSignal.cpp
+ * @file PipeSignalMach.cpp
  *
- * This module contains the implementation of the
+ * This module contains the Mac implementation of the
  * SystemAbstractions::PipeSignal class.
  *
  * Copyright (c) 2016 by Richard Walters
  */
 
-#include "PipeSignal.hpp"
+#include "../Posix/PipeSignal.hpp"
 
 #include <errno.h>
 #include <fcntl.h>
@@ -91,8 +91,10 @@ namespace SystemAbstractions {
     }
 
     void PipeSignal::Clear() {
-        uint8_t token;
-        (void)read(impl_->pipe[0], &token, 1);
+        // Drain all tokens, in case the signal was set more than once.
+        uint8_t tokens[64];
+        while (read(impl_->pipe[0], tokens, sizeof(tokens)) == sizeof(tokens)) {
+        }
     }
 
     bool PipeSignal::IsSet() const {
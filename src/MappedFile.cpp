@@ -0,0 +1,200 @@
+/**
+ * @file MappedFile.cpp
+ *
+ * This module contains the platform-independent part of the
+ * implementation of the SystemAbstractions::MappedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "MappedFileImpl.hpp"
+
+#include <algorithm>
+#include <string.h>
+#include <SystemAbstractions/MappedFile.hpp>
+
+namespace {
+
+    /**
+     * This is the smallest number of bytes mapped when a file
+     * open for writing is first written past its end.
+     */
+    constexpr uint64_t MIN_GROWTH_CAPACITY = 65536;
+
+}
+
+namespace SystemAbstractions {
+
+    bool MappedFile::Impl::Resize(uint64_t newSize) {
+        if (!Reserve(newSize)) {
+            return false;
+        }
+        if (newSize > size) {
+            (void)memset(data + size, 0, (size_t)(newSize - size));
+        }
+        size = newSize;
+        return true;
+    }
+
+    MappedFile::~MappedFile() noexcept = default;
+    MappedFile::MappedFile(MappedFile&& other) noexcept = default;
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept = default;
+
+    MappedFile::MappedFile(std::string path)
+        : impl_(new Impl())
+    {
+        impl_->path = path;
+    }
+
+    std::string MappedFile::GetPath() const {
+        return impl_->path;
+    }
+
+    bool MappedFile::OpenReadOnly() {
+        impl_->Close();
+        return impl_->Open(false);
+    }
+
+    bool MappedFile::OpenReadWrite() {
+        impl_->Close();
+        return impl_->Open(true);
+    }
+
+    void MappedFile::Close() {
+        impl_->Close();
+    }
+
+    auto MappedFile::GetRange(uint64_t offset, size_t numBytes) const -> Range {
+        Range range;
+        if (offset >= impl_->size) {
+            range.data = nullptr;
+            range.size = 0;
+        } else {
+            range.data = impl_->data + offset;
+            range.size = (size_t)std::min((uint64_t)numBytes, impl_->size - offset);
+        }
+        return range;
+    }
+
+    uint64_t MappedFile::GetSize() const {
+        return impl_->size;
+    }
+
+    bool MappedFile::SetSize(uint64_t size) {
+        if (!impl_->writeAccess) {
+            return false;
+        }
+        return impl_->Resize(size);
+    }
+
+    uint64_t MappedFile::GetPosition() const {
+        return impl_->position;
+    }
+
+    void MappedFile::SetPosition(uint64_t position) {
+        impl_->position = position;
+    }
+
+    size_t MappedFile::Peek(Buffer& buffer, size_t numBytes, size_t offset) const {
+        if (numBytes == 0) {
+            numBytes = buffer.size() - offset;
+        }
+        if (numBytes == 0) {
+            return 0;
+        }
+        return Peek(&buffer[offset], numBytes);
+    }
+
+    size_t MappedFile::Peek(void* buffer, size_t numBytes) const {
+        return ReadAt(impl_->position, buffer, numBytes);
+    }
+
+    size_t MappedFile::Read(Buffer& buffer, size_t numBytes, size_t offset) {
+        if (numBytes == 0) {
+            numBytes = buffer.size() - offset;
+        }
+        if (numBytes == 0) {
+            return 0;
+        }
+        return Read(&buffer[offset], numBytes);
+    }
+
+    size_t MappedFile::Read(void* buffer, size_t numBytes) {
+        const auto amountRead = Peek(buffer, numBytes);
+        impl_->position += amountRead;
+        return amountRead;
+    }
+
+    size_t MappedFile::Write(const Buffer& buffer, size_t numBytes, size_t offset) {
+        if (numBytes == 0) {
+            numBytes = buffer.size() - offset;
+        }
+        if (numBytes == 0) {
+            return 0;
+        }
+        return Write(&buffer[offset], numBytes);
+    }
+
+    size_t MappedFile::Write(const void* buffer, size_t numBytes) {
+        const auto amountWritten = WriteAt(impl_->position, buffer, numBytes);
+        impl_->position += amountWritten;
+        return amountWritten;
+    }
+
+    size_t MappedFile::ReadAt(uint64_t position, void* buffer, size_t numBytes) const {
+        const auto range = GetRange(position, numBytes);
+        if (range.size > 0) {
+            (void)memcpy(buffer, range.data, range.size);
+        }
+        return range.size;
+    }
+
+    size_t MappedFile::WriteAt(uint64_t position, const void* buffer, size_t numBytes) {
+        if (
+            !impl_->writeAccess
+            || (numBytes == 0)
+        ) {
+            return 0;
+        }
+        const auto end = position + numBytes;
+        if (end > impl_->capacity) {
+            // Grow the mapping geometrically, so that appending
+            // to the file doesn't map it again every time.
+            const auto newCapacity = std::max(
+                end,
+                std::max(impl_->capacity * 2, MIN_GROWTH_CAPACITY)
+            );
+            if (
+                !impl_->Reserve(newCapacity)
+                && !impl_->Reserve(end)
+            ) {
+                return 0;
+            }
+        }
+        if (end > impl_->size) {
+            if (position > impl_->size) {
+                (void)memset(impl_->data + impl_->size, 0, (size_t)(position - impl_->size));
+            }
+            impl_->size = end;
+        }
+        (void)memcpy(impl_->data + position, buffer, numBytes);
+        return numBytes;
+    }
+
+    std::shared_ptr< IFile > MappedFile::Clone() {
+        auto clone = std::make_shared< MappedFile >(impl_->path);
+        if (impl_->isOpen) {
+            if (
+                impl_->writeAccess
+                && !impl_->Trim()
+            ) {
+                return nullptr;
+            }
+            if (!clone->impl_->Open(impl_->writeAccess)) {
+                return nullptr;
+            }
+        }
+        return clone;
+    }
+
+}
@@ -0,0 +1,153 @@
+#ifndef SYSTEM_ABSTRACTIONS_MAPPED_FILE_IMPL_HPP
+#define SYSTEM_ABSTRACTIONS_MAPPED_FILE_IMPL_HPP
+
+/**
+ * @file MappedFileImpl.hpp
+ *
+ * This module contains the platform-independent part of the
+ * implementation of the SystemAbstractions::MappedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <SystemAbstractions/MappedFile.hpp>
+
+namespace SystemAbstractions {
+
+    struct MappedFile::Impl {
+        // Properties
+
+        /**
+         * This is the path to the file in the file system.
+         */
+        std::string path;
+
+        /**
+         * This is the current position in the file.
+         */
+        uint64_t position = 0;
+
+        /**
+         * This is the size of the file, as seen through the class.
+         */
+        uint64_t size = 0;
+
+        /**
+         * This is the number of bytes mapped, which is also the size
+         * of the file on disk.  When the file is open for writing,
+         * this grows geometrically as the file is written past its end,
+         * and may be larger than the size of the file as seen through
+         * the class.  The extra bytes are cut off when the file is closed.
+         */
+        uint64_t capacity = 0;
+
+        /**
+         * This points to where the contents of the file are mapped.
+         * It's null if the file isn't open or is empty.
+         */
+        uint8_t* data = nullptr;
+
+        /**
+         * This flag indicates whether or not the file is open.
+         */
+        bool isOpen = false;
+
+        /**
+         * This flag indicates whether or not the file was
+         * opened with write access.
+         */
+        bool writeAccess = false;
+
+        /**
+         * This contains any platform-specific private properties
+         * of the class.
+         */
+        std::unique_ptr< Platform > platform;
+
+        // Lifecycle Management
+
+        ~Impl() noexcept;
+        Impl(const Impl&) = delete;
+        Impl(Impl&&) noexcept = delete;
+        Impl& operator=(const Impl&) = delete;
+        Impl& operator=(Impl&&) noexcept = delete;
+
+        // Methods
+
+        /**
+         * This is the default constructor.
+         */
+        Impl();
+
+        /**
+         * This method opens the file and maps its contents.
+         * It's implemented for each platform.
+         *
+         * @param[in] write
+         *     This flag indicates whether or not to open the file
+         *     with write access, creating it if it doesn't exist.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool Open(bool write);
+
+        /**
+         * This method unmaps and closes the file, if it's open,
+         * cutting the file on disk back to its size as seen through
+         * the class.  It's implemented for each platform.
+         */
+        void Close();
+
+        /**
+         * This method makes sure at least the given number of bytes
+         * of the file are mapped, extending the file on disk and
+         * mapping its contents again if necessary.  If this fails,
+         * the file and its mapping are left as they were.
+         * It's implemented for each platform.
+         *
+         * @param[in] newCapacity
+         *     This is the number of bytes of the file to be mapped.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool Reserve(uint64_t newCapacity);
+
+        /**
+         * This method cuts the file on disk, and its mapping, back to
+         * the size of the file as seen through the class, so that
+         * the file can be opened again elsewhere.  If this fails,
+         * the file is either left as it was, or closed if that isn't
+         * possible, so that it's never left open without its
+         * contents mapped.  It's implemented for each platform.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool Trim();
+
+        /**
+         * This method changes the size of the file as seen through
+         * the class.  Any bytes added read as zero.  If this fails,
+         * the file and its mapping are left as they were.
+         *
+         * @param[in] newSize
+         *     This is the new size of the file.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool Resize(uint64_t newSize);
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_MAPPED_FILE_IMPL_HPP */
@@ -0,0 +1,211 @@
+#ifndef SYSTEM_ABSTRACTIONS_MPSC_QUEUE_HPP
+#define SYSTEM_ABSTRACTIONS_MPSC_QUEUE_HPP
+
+/**
+ * @file MpscQueue.hpp
+ *
+ * This module declares and implements the
+ * SystemAbstractions::MpscQueue class template.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class template represents a fixed-capacity queue into which
+     * any number of threads may push items, and from which one thread
+     * at a time may pop items, without any of them taking a lock.
+     *
+     * All the slots of the queue are constructed up front and reused.
+     * Items are filled in and drained out of their slots in place,
+     * so an item which holds memory of its own (for example,
+     * a vector) can hand that memory back and forth with its producer
+     * and consumer rather than having it freed and allocated again.
+     *
+     * @note
+     *     This is a bounded queue based on sequence numbers kept
+     *     with each slot, as described by Dmitry Vyukov.
+     *
+     * @param T
+     *     This is the type of item held in the queue.  It must be
+     *     default-constructible.
+     */
+    template< typename T > class MpscQueue {
+        // Lifecycle management
+    public:
+        ~MpscQueue() noexcept = default;
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue(MpscQueue&&) noexcept = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+        MpscQueue& operator=(MpscQueue&&) noexcept = delete;
+
+        // Public methods
+    public:
+        /**
+         * This is the instance constructor.
+         *
+         * @param[in] minCapacity
+         *     This is the minimum number of items the queue must be
+         *     able to hold.  The actual capacity is this number rounded
+         *     up to the next power of two.
+         */
+        explicit MpscQueue(size_t minCapacity) {
+            size_t capacity = 1;
+            while (capacity < minCapacity) {
+                capacity <<= 1;
+            }
+            mask_ = capacity - 1;
+            slots_.reset(new Slot[capacity]);
+            for (size_t i = 0; i < capacity; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * This method returns the maximum number of items
+         * the queue can hold.
+         *
+         * @return
+         *     The maximum number of items the queue can hold is returned.
+         */
+        size_t GetCapacity() const {
+            return mask_ + 1;
+        }
+
+        /**
+         * This method returns the position of the next slot to be
+         * claimed for pushing.  Every item pushed before this is called
+         * is at a position below the one returned, even if some slots
+         * below it are still being filled in.
+         *
+         * @return
+         *     The position of the next slot to be claimed for pushing
+         *     is returned.
+         */
+        size_t GetPushPosition() const {
+            return pushPosition_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * This method returns the position of the next slot to pop.
+         * Every item at a position below this has been popped.
+         * It must only be called by the consumer.
+         *
+         * @return
+         *     The position of the next slot to pop is returned.
+         */
+        size_t GetPopPosition() const {
+            return popPosition_;
+        }
+
+        /**
+         * This method tries to claim a free slot at the back of the
+         * queue, fill it in, and make it available to the consumer.
+         * It may be called by any number of threads at once.
+         *
+         * @param[in] fill
+         *     This is the function to call to fill in the item
+         *     in the claimed slot.  It's given a reference to the item.
+         *
+         * @return
+         *     An indication of whether or not there was room to push
+         *     the item onto the queue is returned.
+         */
+        template< typename Fill > bool TryPush(Fill&& fill) {
+            auto position = pushPosition_.load(std::memory_order_relaxed);
+            Slot* slot;
+            for (;;) {
+                slot = &slots_[position & mask_];
+                const auto sequence = slot->sequence.load(std::memory_order_acquire);
+                const auto difference = (ptrdiff_t)sequence - (ptrdiff_t)position;
+                if (difference == 0) {
+                    if (
+                        pushPosition_.compare_exchange_weak(
+                            position,
+                            position + 1,
+                            std::memory_order_relaxed
+                        )
+                    ) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = pushPosition_.load(std::memory_order_relaxed);
+                }
+            }
+            fill(slot->item);
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * This method tries to drain the item at the front of the
+         * queue and free its slot.  It must only be called by one
+         * thread at a time.
+         *
+         * @param[in] drain
+         *     This is the function to call to drain the item at the
+         *     front of the queue.  It's given a reference to the item,
+         *     which stays in the slot for reuse afterwards.
+         *
+         * @return
+         *     An indication of whether or not there was an item
+         *     in the queue to pop is returned.
+         */
+        template< typename Drain > bool TryPop(Drain&& drain) {
+            const auto position = popPosition_;
+            auto& slot = slots_[position & mask_];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != position + 1) {
+                return false;
+            }
+            drain(slot.item);
+            slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+            popPosition_ = position + 1;
+            return true;
+        }
+
+        // Private properties
+    private:
+        /**
+         * This holds one item of the queue, along with the sequence
+         * number which tells producers and the consumer whether the
+         * slot is free to fill or ready to drain.
+         */
+        struct Slot {
+            std::atomic< size_t > sequence;
+            T item;
+        };
+
+        /**
+         * These are the slots which hold the items of the queue.
+         */
+        std::unique_ptr< Slot[] > slots_;
+
+        /**
+         * This is one less than the number of slots, used to wrap
+         * positions around to slot indexes.
+         */
+        size_t mask_ = 0;
+
+        /**
+         * This is the position of the next slot to claim for pushing.
+         */
+        std::atomic< size_t > pushPosition_{0};
+
+        /**
+         * This is the position of the next slot to pop.  It's only
+         * touched by the consumer.
+         */
+        size_t popPosition_ = 0;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_MPSC_QUEUE_HPP */
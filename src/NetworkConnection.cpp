@@ -39,6 +39,17 @@ namespace SystemAbstractions {
         BrokenDelegate brokenDelegate
     ) {
         impl_->messageReceivedDelegate = messageReceivedDelegate;
+        impl_->messageBufferReceivedDelegate = nullptr;
+        impl_->brokenDelegate = brokenDelegate;
+        return impl_->Process();
+    }
+
+    bool NetworkConnection::Process(
+        MessageBufferReceivedDelegate messageBufferReceivedDelegate,
+        BrokenDelegate brokenDelegate
+    ) {
+        impl_->messageReceivedDelegate = nullptr;
+        impl_->messageBufferReceivedDelegate = messageBufferReceivedDelegate;
         impl_->brokenDelegate = brokenDelegate;
         return impl_->Process();
     }
@@ -67,6 +78,17 @@ namespace SystemAbstractions {
         impl_->SendMessage(message);
     }
 
+    void NetworkConnection::SendMessage(std::vector< uint8_t >&& message) {
+        impl_->SendMessage(std::move(message));
+    }
+
+    void NetworkConnection::SendMessage(std::shared_ptr< const std::vector< uint8_t > > message) {
+        if (message == nullptr) {
+            return;
+        }
+        impl_->SendMessage(std::move(message));
+    }
+
     void NetworkConnection::Close(bool clean) {
         if (
             impl_->Close(
@@ -83,4 +105,11 @@ namespace SystemAbstractions {
         return Impl::GetAddressOfHost(host);
     }
 
+    bool NetworkConnection::SetProcessingModel(
+        ProcessingModel processingModel,
+        size_t numThreads
+    ) {
+        return Impl::SetProcessingModel(processingModel, numThreads);
+    }
+
 }
@@ -11,6 +11,8 @@
  */
 
 #include <memory>
+#include <mutex>
+#include <stddef.h>
 #include <stdint.h>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
 #include <SystemAbstractions/NetworkConnection.hpp>
@@ -69,6 +71,14 @@ namespace SystemAbstractions {
          */
         MessageReceivedDelegate messageReceivedDelegate;
 
+        /**
+         * If set, this is the callback issued instead of
+         * messageReceivedDelegate whenever more data is received
+         * from the peer of the connection, handing over the buffer
+         * holding the data.
+         */
+        MessageBufferReceivedDelegate messageBufferReceivedDelegate;
+
         /**
          * This is the callback issued whenever
          * the connection is broken.
@@ -146,6 +156,36 @@ namespace SystemAbstractions {
          */
         void Processor();
 
+        /**
+         * This method does one round of receiving and sending data,
+         * and of advancing a graceful close, without waiting.
+         * It is called with the processing lock held, either by the
+         * processor worker thread or by a shared event loop thread.
+         *
+         * @param[in,out] processingLock
+         *     This is the lock held on the object, which is released
+         *     while delegates are called.
+         *
+         * @param[out] wait
+         *     This is set to indicate whether or not nothing more can be
+         *     done until the connection's state or socket changes.
+         *
+         * @return
+         *     An indication of whether or not processing of the
+         *     connection should continue is returned.
+         */
+        bool ProcessIo(
+            std::unique_lock< std::recursive_mutex >& processingLock,
+            bool& wait
+        );
+
+        /**
+         * This method is called by a shared event loop thread,
+         * if the connection is processed by one rather than by
+         * its own worker thread, whenever the socket is ready.
+         */
+        void ProcessReady();
+
         /**
          * This method returns an indication of whether or not there
          * is a connection currently established with a peer.
@@ -167,6 +207,26 @@ namespace SystemAbstractions {
          */
         void SendMessage(const std::vector< uint8_t >& message);
 
+        /**
+         * This method appends the given data to the queue of data
+         * currently being sent to the peer, taking ownership of it.
+         * The actual sending is performed by the processor worker thread.
+         *
+         * @param[in] message
+         *     This holds the data to be appended to the send queue.
+         */
+        void SendMessage(std::vector< uint8_t >&& message);
+
+        /**
+         * This method appends the given shared data to the queue of data
+         * currently being sent to the peer, without copying it.
+         * The actual sending is performed by the processor worker thread.
+         *
+         * @param[in] message
+         *     This holds the data to be appended to the send queue.
+         */
+        void SendMessage(std::shared_ptr< const std::vector< uint8_t > > message);
+
         /**
          * This method breaks the connection to the peer.
          *
@@ -200,6 +260,28 @@ namespace SystemAbstractions {
          *     the given name could not be determined.
          */
         static uint32_t GetAddressOfHost(const std::string& host);
+
+        /**
+         * This is a helper free function which selects how network
+         * connections are processed.
+         *
+         * @param[in] processingModel
+         *     This is the way in which network connections
+         *     should be processed.
+         *
+         * @param[in] numThreads
+         *     This is the number of worker threads to use for
+         *     the shared event loop model.  If zero, the number of
+         *     hardware threads of the host machine is used.
+         *
+         * @return
+         *     An indication of whether or not the given processing model
+         *     was selected is returned.
+         */
+        static bool SetProcessingModel(
+            ProcessingModel processingModel,
+            size_t numThreads
+        );
     };
 
 }
@@ -9,6 +9,7 @@
 
 #include "NetworkEndpointImpl.hpp"
 
+#include <algorithm>
 #include <assert.h>
 #include <inttypes.h>
 #include <memory>
@@ -29,6 +30,10 @@ namespace SystemAbstractions {
         return impl_->diagnosticsSender.SubscribeToDiagnostics(delegate, minLevel);
     }
 
+    void NetworkEndpoint::SetNumListeners(size_t numListeners) {
+        impl_->numListeners = std::max(numListeners, (size_t)1);
+    }
+
     void NetworkEndpoint::SendPacket(
         uint32_t address,
         uint16_t port,
@@ -47,6 +52,46 @@ namespace SystemAbstractions {
     ) {
         impl_->newConnectionDelegate = newConnectionDelegate;
         impl_->packetReceivedDelegate = packetReceivedDelegate;
+        impl_->packetsReceivedDelegate = nullptr;
+        impl_->maxPacketsPerBatch = 1;
+        impl_->mode = mode;
+        impl_->localAddress = localAddress;
+        impl_->groupAddress = groupAddress;
+        impl_->port = port;
+        return impl_->Open();
+    }
+
+    bool NetworkEndpoint::Open(
+        NewConnectionDelegate newConnectionDelegate,
+        PacketsReceivedDelegate packetsReceivedDelegate,
+        Mode mode,
+        uint32_t localAddress,
+        uint32_t groupAddress,
+        uint16_t port,
+        size_t maxPacketsPerBatch,
+        size_t maxPacketSize
+    ) {
+        maxPacketSize = std::min(std::max(maxPacketSize, (size_t)1), (size_t)65536);
+        impl_->newConnectionDelegate = newConnectionDelegate;
+
+        // Platforms which can't receive datagrams in batches use the
+        // single-packet delegate, so provide one which delivers
+        // batches of one.
+        impl_->packetReceivedDelegate = [packetsReceivedDelegate, maxPacketSize](
+            uint32_t address,
+            uint16_t port,
+            const std::vector< uint8_t >& body
+        ){
+            std::vector< ReceivedPacket > packets(1);
+            packets[0].address = address;
+            packets[0].port = port;
+            packets[0].body = body.data();
+            packets[0].bodySize = std::min(body.size(), maxPacketSize);
+            packetsReceivedDelegate(packets);
+        };
+        impl_->packetsReceivedDelegate = packetsReceivedDelegate;
+        impl_->maxPacketsPerBatch = std::max(maxPacketsPerBatch, (size_t)1);
+        impl_->maxPacketSize = maxPacketSize;
         impl_->mode = mode;
         impl_->localAddress = localAddress;
         impl_->groupAddress = groupAddress;
@@ -11,6 +11,7 @@
  */
 
 #include <memory>
+#include <stddef.h>
 #include <stdint.h>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
 #include <SystemAbstractions/NetworkEndpoint.hpp>
@@ -43,6 +44,34 @@ namespace SystemAbstractions {
          */
         PacketReceivedDelegate packetReceivedDelegate;
 
+        /**
+         * This is the callback function to be called whenever
+         * one or more new datagram-oriented messages are received by
+         * the network endpoint, if the endpoint is configured to
+         * receive messages in batches.
+         */
+        PacketsReceivedDelegate packetsReceivedDelegate;
+
+        /**
+         * This is the maximum number of datagrams to deliver in
+         * one batch, if the endpoint is configured to receive
+         * messages in batches.
+         */
+        size_t maxPacketsPerBatch = 1;
+
+        /**
+         * This is the largest datagram, in bytes, to deliver in
+         * a batch, if the endpoint is configured to receive
+         * messages in batches.  Larger ones are cut short.
+         */
+        size_t maxPacketSize = 65536;
+
+        /**
+         * This is the number of sockets to use to listen for
+         * connections, in connection mode, where supported.
+         */
+        size_t numListeners = 1;
+
         /**
          * This is the IPv4 address of the network interface
          * bound by this endpoint.  If zero, then all network
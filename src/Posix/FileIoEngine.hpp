@@ -0,0 +1,167 @@
+#ifndef SYSTEM_ABSTRACTIONS_FILE_IO_ENGINE_HPP
+#define SYSTEM_ABSTRACTIONS_FILE_IO_ENGINE_HPP
+
+/**
+ * @file FileIoEngine.hpp
+ *
+ * This module declares the SystemAbstractions::FileIoEngine class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class carries out file reads, writes, and syncs on behalf
+     * of other threads, calling back when each one is complete, so
+     * that the threads asking for them don't block.
+     *
+     * Where the kernel supports it, the operations are handed to
+     * the kernel through an io_uring, and one thread waits for them
+     * to complete.  Otherwise, a small pool of threads carries
+     * them out with ordinary blocking system calls.
+     */
+    class FileIoEngine {
+        // Types
+    public:
+        /**
+         * This is the type of function called when an operation
+         * is complete.
+         *
+         * @param[in] success
+         *     This indicates whether or not the operation succeeded.
+         *
+         * @param[in] amount
+         *     This is the number of bytes read or written.
+         */
+        typedef std::function< void(bool success, size_t amount) > CompletionDelegate;
+
+        // Lifecycle management
+    public:
+        ~FileIoEngine() noexcept;
+        FileIoEngine(const FileIoEngine&) = delete;
+        FileIoEngine(FileIoEngine&&) noexcept = delete;
+        FileIoEngine& operator=(const FileIoEngine&) = delete;
+        FileIoEngine& operator=(FileIoEngine&&) noexcept = delete;
+
+        // Public methods
+    public:
+        /**
+         * This is the instance constructor.
+         *
+         * @param[in] useKernelQueue
+         *     This indicates whether or not to try handing operations
+         *     to the kernel through an io_uring, rather than carrying
+         *     them out in a pool of threads.
+         */
+        explicit FileIoEngine(bool useKernelQueue = true);
+
+        /**
+         * This method returns an indication of whether or not
+         * operations are being handed to the kernel through
+         * an io_uring.
+         *
+         * @return
+         *     An indication of whether or not operations are being
+         *     handed to the kernel through an io_uring is returned.
+         */
+        bool IsUsingKernelQueue() const;
+
+        /**
+         * This method starts reading a region of a file.
+         *
+         * @param[in] handle
+         *     This is the operating-system handle to the file.
+         *     It must remain open until the operation is complete.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to read.
+         *
+         * @param[out] buffer
+         *     This is where to put the bytes read from the file.
+         *     It must remain valid until the operation is complete.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to read from the file.
+         *
+         * @param[in] completionDelegate
+         *     This is the function to call, from a thread of the engine,
+         *     when the operation is complete.
+         */
+        void ReadAt(
+            int handle,
+            uint64_t position,
+            void* buffer,
+            size_t numBytes,
+            CompletionDelegate completionDelegate
+        );
+
+        /**
+         * This method starts writing a region of a file.
+         *
+         * @param[in] handle
+         *     This is the operating-system handle to the file.
+         *     It must remain open until the operation is complete.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte to write.
+         *
+         * @param[in] buffer
+         *     This is where to fetch the bytes to write to the file.
+         *     It must remain valid until the operation is complete.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes to write to the file.
+         *
+         * @param[in] completionDelegate
+         *     This is the function to call, from a thread of the engine,
+         *     when the operation is complete.
+         */
+        void WriteAt(
+            int handle,
+            uint64_t position,
+            const void* buffer,
+            size_t numBytes,
+            CompletionDelegate completionDelegate
+        );
+
+        /**
+         * This method starts flushing all data written to a file
+         * to the storage device holding it.
+         *
+         * @param[in] handle
+         *     This is the operating-system handle to the file.
+         *     It must remain open until the operation is complete.
+         *
+         * @param[in] completionDelegate
+         *     This is the function to call, from a thread of the engine,
+         *     when the operation is complete.
+         */
+        void Sync(
+            int handle,
+            CompletionDelegate completionDelegate
+        );
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_FILE_IO_ENGINE_HPP */
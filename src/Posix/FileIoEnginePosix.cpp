@@ -0,0 +1,669 @@
+/**
+ * @file FileIoEnginePosix.cpp
+ *
+ * This module contains the POSIX implementation of the
+ * SystemAbstractions::FileIoEngine class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "FileIoEngine.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <mutex>
+#include <string.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifdef SYS_io_uring_setup
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#endif /* SYS_io_uring_setup */
+
+namespace {
+
+    /**
+     * This is the number of operations which may be handed to the
+     * kernel at once, when using an io_uring.
+     */
+    constexpr unsigned KERNEL_QUEUE_DEPTH = 256;
+
+    /**
+     * This is the number of threads used to carry out operations,
+     * when not using an io_uring.
+     */
+    constexpr size_t NUM_WORKER_THREADS = 4;
+
+    /**
+     * This holds everything about one operation requested of the engine,
+     * from when it's requested until it's complete.
+     */
+    struct Operation {
+        // Types
+
+        /**
+         * These are the different kinds of operations.
+         */
+        enum class Type {
+            Read,
+            Write,
+            Sync,
+        };
+
+        // Properties
+
+        /**
+         * This is the kind of operation.
+         */
+        Type type = Type::Sync;
+
+        /**
+         * This is the operating-system handle to the file.
+         */
+        int handle = -1;
+
+        /**
+         * This is the position in the file of the first byte
+         * to read or write.
+         */
+        uint64_t position = 0;
+
+        /**
+         * This describes the buffer to read into or write from.
+         * It's kept here so that it stays valid while the kernel
+         * is working on the operation.
+         */
+        struct iovec vector;
+
+        /**
+         * This is the function to call when the operation is complete.
+         */
+        SystemAbstractions::FileIoEngine::CompletionDelegate completionDelegate;
+
+        // Methods
+
+        /**
+         * This method reports the outcome of the operation.
+         *
+         * @param[in] result
+         *     This is the number of bytes read or written, or
+         *     a negative number if the operation failed.
+         */
+        void Complete(ssize_t result) {
+            completionDelegate(
+                (result >= 0),
+                ((result < 0) ? (size_t)0 : (size_t)result)
+            );
+        }
+
+        /**
+         * This method carries out the operation, blocking the calling
+         * thread until it's done, and reports the outcome.
+         */
+        void Perform() {
+            ssize_t result;
+            switch (type) {
+                case Type::Read: {
+                    result = pread(handle, vector.iov_base, vector.iov_len, (off_t)position);
+                } break;
+
+                case Type::Write: {
+                    result = pwrite(handle, vector.iov_base, vector.iov_len, (off_t)position);
+                } break;
+
+                case Type::Sync:
+                default: {
+                    result = (ssize_t)fsync(handle);
+                } break;
+            }
+            Complete(result);
+        }
+    };
+
+}
+
+namespace SystemAbstractions {
+
+    /**
+     * This contains the private properties of a FileIoEngine instance.
+     */
+    struct FileIoEngine::Impl {
+        // Properties
+
+        /**
+         * This is used to synchronize access to the state of the engine.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake up worker threads when operations
+         * are queued or the engine is stopping.
+         */
+        std::condition_variable wakeCondition;
+
+        /**
+         * This flag is set when the engine is being destroyed,
+         * to tell its threads to stop once all operations
+         * are complete.
+         */
+        bool stop = false;
+
+        /**
+         * These are the operations requested but not yet taken up
+         * by a worker thread or handed to the kernel.
+         */
+        std::deque< std::unique_ptr< Operation > > queued;
+
+        /**
+         * These are the threads which carry out operations,
+         * when not using an io_uring.
+         */
+        std::vector< std::thread > workers;
+
+#ifdef SYS_io_uring_setup
+        /**
+         * This is the operating-system handle to the io_uring,
+         * or -1 if one isn't being used.
+         */
+        int ringHandle = -1;
+
+        /**
+         * This is where the submission queue of the io_uring is mapped.
+         */
+        void* submissionRing = MAP_FAILED;
+
+        /**
+         * This is the number of bytes mapped for the submission queue.
+         */
+        size_t submissionRingSize = 0;
+
+        /**
+         * This is where the completion queue of the io_uring is mapped.
+         */
+        void* completionRing = MAP_FAILED;
+
+        /**
+         * This is the number of bytes mapped for the completion queue.
+         */
+        size_t completionRingSize = 0;
+
+        /**
+         * These are the submission queue entries of the io_uring.
+         */
+        struct io_uring_sqe* submissionEntries = (struct io_uring_sqe*)MAP_FAILED;
+
+        /**
+         * This is the number of submission queue entries.
+         */
+        unsigned numSubmissionEntries = 0;
+
+        /**
+         * This is the number of completion queue entries, which
+         * is also the most operations which may be in the kernel's
+         * hands at once without risking lost completions.
+         */
+        unsigned numCompletionEntries = 0;
+
+        /**
+         * These point to the head index, tail index, index mask,
+         * and index array of the submission queue.
+         */
+        unsigned* submissionHead = nullptr;
+        unsigned* submissionTail = nullptr;
+        unsigned* submissionMask = nullptr;
+        unsigned* submissionArray = nullptr;
+
+        /**
+         * These point to the head index, tail index, index mask,
+         * and entries of the completion queue.
+         */
+        unsigned* completionHead = nullptr;
+        unsigned* completionTail = nullptr;
+        unsigned* completionMask = nullptr;
+        struct io_uring_cqe* completionEntries = nullptr;
+
+        /**
+         * This is the number of operations placed in the submission
+         * queue which the kernel hasn't yet been told about.
+         */
+        unsigned unsubmitted = 0;
+
+        /**
+         * This is the number of operations in the kernel's hands.
+         */
+        unsigned inFlight = 0;
+
+        /**
+         * These are the operations which the kernel refused to take,
+         * to be reported as failed once the mutex is released.
+         */
+        std::vector< std::unique_ptr< Operation > > rejected;
+
+        /**
+         * This is the thread which waits for operations handed to
+         * the kernel to complete, and reports their outcomes.
+         */
+        std::thread completionWaiter;
+#endif /* SYS_io_uring_setup */
+
+        // Methods
+
+        /**
+         * This method queues the given operation to be carried out.
+         *
+         * @param[in] operation
+         *     This is the operation to queue.
+         */
+        void Submit(std::unique_ptr< Operation > operation) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            queued.push_back(std::move(operation));
+#ifdef SYS_io_uring_setup
+            if (ringHandle >= 0) {
+                SubmitToKernel();
+                ReportRejected(lock);
+                return;
+            }
+#endif /* SYS_io_uring_setup */
+            wakeCondition.notify_one();
+        }
+
+        /**
+         * This is the body of each worker thread, which carries out
+         * queued operations, when not using an io_uring.
+         */
+        void Worker() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            for (;;) {
+                wakeCondition.wait(
+                    lock,
+                    [this]{ return stop || !queued.empty(); }
+                );
+                if (queued.empty()) {
+                    break;
+                }
+                auto operation = std::move(queued.front());
+                queued.pop_front();
+                lock.unlock();
+                operation->Perform();
+                lock.lock();
+            }
+        }
+
+#ifdef SYS_io_uring_setup
+        /**
+         * This method sets up an io_uring through which to hand
+         * operations to the kernel.
+         *
+         * @return
+         *     An indication of whether or not the io_uring
+         *     was set up successfully is returned.
+         */
+        bool SetUpKernelQueue() {
+            struct io_uring_params parameters;
+            (void)memset(&parameters, 0, sizeof(parameters));
+            ringHandle = (int)syscall(SYS_io_uring_setup, KERNEL_QUEUE_DEPTH, &parameters);
+            if (ringHandle < 0) {
+                return false;
+            }
+            submissionRingSize = (
+                parameters.sq_off.array
+                + parameters.sq_entries * sizeof(unsigned)
+            );
+            submissionRing = mmap(
+                NULL, submissionRingSize,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ringHandle, IORING_OFF_SQ_RING
+            );
+            completionRingSize = (
+                parameters.cq_off.cqes
+                + parameters.cq_entries * sizeof(struct io_uring_cqe)
+            );
+            completionRing = mmap(
+                NULL, completionRingSize,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ringHandle, IORING_OFF_CQ_RING
+            );
+            numSubmissionEntries = parameters.sq_entries;
+            numCompletionEntries = parameters.cq_entries;
+            submissionEntries = (struct io_uring_sqe*)mmap(
+                NULL, numSubmissionEntries * sizeof(struct io_uring_sqe),
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ringHandle, IORING_OFF_SQES
+            );
+            if (
+                (submissionRing == MAP_FAILED)
+                || (completionRing == MAP_FAILED)
+                || (submissionEntries == (struct io_uring_sqe*)MAP_FAILED)
+            ) {
+                TearDownKernelQueue();
+                return false;
+            }
+            const auto submissionBase = (uint8_t*)submissionRing;
+            submissionHead = (unsigned*)(submissionBase + parameters.sq_off.head);
+            submissionTail = (unsigned*)(submissionBase + parameters.sq_off.tail);
+            submissionMask = (unsigned*)(submissionBase + parameters.sq_off.ring_mask);
+            submissionArray = (unsigned*)(submissionBase + parameters.sq_off.array);
+            const auto completionBase = (uint8_t*)completionRing;
+            completionHead = (unsigned*)(completionBase + parameters.cq_off.head);
+            completionTail = (unsigned*)(completionBase + parameters.cq_off.tail);
+            completionMask = (unsigned*)(completionBase + parameters.cq_off.ring_mask);
+            completionEntries = (struct io_uring_cqe*)(completionBase + parameters.cq_off.cqes);
+            return true;
+        }
+
+        /**
+         * This method releases the io_uring, if one was set up.
+         */
+        void TearDownKernelQueue() {
+            if (submissionEntries != (struct io_uring_sqe*)MAP_FAILED) {
+                (void)munmap(submissionEntries, numSubmissionEntries * sizeof(struct io_uring_sqe));
+                submissionEntries = (struct io_uring_sqe*)MAP_FAILED;
+            }
+            if (completionRing != MAP_FAILED) {
+                (void)munmap(completionRing, completionRingSize);
+                completionRing = MAP_FAILED;
+            }
+            if (submissionRing != MAP_FAILED) {
+                (void)munmap(submissionRing, submissionRingSize);
+                submissionRing = MAP_FAILED;
+            }
+            if (ringHandle >= 0) {
+                (void)close(ringHandle);
+                ringHandle = -1;
+            }
+        }
+
+        /**
+         * This method places the given operation into the submission
+         * queue of the io_uring.  The mutex must be held, and there
+         * must be room in the submission queue.
+         *
+         * @param[in] operation
+         *     This is the operation to place in the submission queue.
+         *     A null pointer places an operation which does nothing,
+         *     used to wake up the completion waiter thread.
+         */
+        void PlaceInSubmissionQueue(Operation* operation) {
+            const auto tail = *submissionTail;
+            const auto index = tail & *submissionMask;
+            auto& entry = submissionEntries[index];
+            (void)memset(&entry, 0, sizeof(entry));
+            entry.user_data = (uint64_t)(uintptr_t)operation;
+            if (operation == nullptr) {
+                entry.opcode = IORING_OP_NOP;
+            } else {
+                entry.fd = operation->handle;
+                switch (operation->type) {
+                    case Operation::Type::Read: {
+                        entry.opcode = IORING_OP_READV;
+                        entry.off = operation->position;
+                        entry.addr = (uint64_t)(uintptr_t)&operation->vector;
+                        entry.len = 1;
+                    } break;
+
+                    case Operation::Type::Write: {
+                        entry.opcode = IORING_OP_WRITEV;
+                        entry.off = operation->position;
+                        entry.addr = (uint64_t)(uintptr_t)&operation->vector;
+                        entry.len = 1;
+                    } break;
+
+                    case Operation::Type::Sync:
+                    default: {
+                        entry.opcode = IORING_OP_FSYNC;
+                    } break;
+                }
+            }
+            submissionArray[index] = index;
+            __atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+            ++unsubmitted;
+            ++inFlight;
+        }
+
+        /**
+         * This method hands as many queued operations to the kernel
+         * as it can take.  The mutex must be held.
+         */
+        void SubmitToKernel() {
+            while (
+                !queued.empty()
+                && (inFlight < numCompletionEntries)
+                && (
+                    *submissionTail - __atomic_load_n(submissionHead, __ATOMIC_ACQUIRE)
+                    < numSubmissionEntries
+                )
+            ) {
+                PlaceInSubmissionQueue(queued.front().release());
+                queued.pop_front();
+            }
+            EnterKernel();
+        }
+
+        /**
+         * This method tells the kernel about any operations placed in
+         * the submission queue.  The mutex must be held.
+         */
+        void EnterKernel() {
+            while (unsubmitted > 0) {
+                const auto result = syscall(
+                    SYS_io_uring_enter,
+                    ringHandle, unsubmitted, 0, 0, NULL, 0
+                );
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    RejectUnsubmitted();
+                    break;
+                }
+                unsubmitted -= (unsigned)result;
+                if (result == 0) {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * This method takes back any operations placed in the
+         * submission queue which the kernel hasn't been told about,
+         * and sets them aside to be reported as failed.
+         * The mutex must be held.
+         */
+        void RejectUnsubmitted() {
+            auto tail = *submissionTail;
+            while (unsubmitted > 0) {
+                --tail;
+                --unsubmitted;
+                --inFlight;
+                const auto& entry = submissionEntries[tail & *submissionMask];
+                std::unique_ptr< Operation > operation(
+                    (Operation*)(uintptr_t)entry.user_data
+                );
+                if (operation != nullptr) {
+                    rejected.push_back(std::move(operation));
+                }
+            }
+            __atomic_store_n(submissionTail, tail, __ATOMIC_RELEASE);
+        }
+
+        /**
+         * This method reports the failure of any operations which
+         * the kernel refused to take.
+         *
+         * @param[in,out] lock
+         *     This holds the mutex, which is released while
+         *     the failures are reported.
+         */
+        void ReportRejected(std::unique_lock< decltype(mutex) >& lock) {
+            if (rejected.empty()) {
+                return;
+            }
+            decltype(rejected) operations;
+            operations.swap(rejected);
+            lock.unlock();
+            for (const auto& operation: operations) {
+                operation->Complete(-1);
+            }
+            lock.lock();
+        }
+
+        /**
+         * This is the body of the thread which waits for operations
+         * handed to the kernel to complete, and reports their outcomes.
+         */
+        void WaitForCompletions() {
+            std::vector< std::pair< Operation*, int > > completed;
+            for (;;) {
+                {
+                    std::lock_guard< decltype(mutex) > lock(mutex);
+                    if (
+                        stop
+                        && (inFlight == 0)
+                        && queued.empty()
+                    ) {
+                        break;
+                    }
+                }
+                const auto waitResult = syscall(
+                    SYS_io_uring_enter,
+                    ringHandle, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0
+                );
+                if (
+                    (waitResult < 0)
+                    && (errno != EINTR)
+                ) {
+                    break;
+                }
+                auto head = *completionHead;
+                const auto tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+                while (head != tail) {
+                    const auto& entry = completionEntries[head & *completionMask];
+                    completed.emplace_back(
+                        (Operation*)(uintptr_t)entry.user_data,
+                        entry.res
+                    );
+                    ++head;
+                }
+                __atomic_store_n(completionHead, head, __ATOMIC_RELEASE);
+                for (const auto& completion: completed) {
+                    std::unique_ptr< Operation > operation(completion.first);
+                    if (operation != nullptr) {
+                        operation->Complete((ssize_t)completion.second);
+                    }
+                }
+                std::unique_lock< decltype(mutex) > lock(mutex);
+                inFlight -= (unsigned)completed.size();
+                completed.clear();
+                SubmitToKernel();
+                ReportRejected(lock);
+            }
+        }
+#endif /* SYS_io_uring_setup */
+    };
+
+    FileIoEngine::~FileIoEngine() noexcept {
+        {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            impl_->stop = true;
+#ifdef SYS_io_uring_setup
+            if (impl_->ringHandle >= 0) {
+                if (
+                    *impl_->submissionTail - __atomic_load_n(impl_->submissionHead, __ATOMIC_ACQUIRE)
+                    < impl_->numSubmissionEntries
+                ) {
+                    impl_->PlaceInSubmissionQueue(nullptr);
+                    impl_->EnterKernel();
+                }
+            }
+#endif /* SYS_io_uring_setup */
+            impl_->wakeCondition.notify_all();
+        }
+        for (auto& worker: impl_->workers) {
+            worker.join();
+        }
+#ifdef SYS_io_uring_setup
+        if (impl_->completionWaiter.joinable()) {
+            impl_->completionWaiter.join();
+        }
+        impl_->TearDownKernelQueue();
+#endif /* SYS_io_uring_setup */
+    }
+
+    FileIoEngine::FileIoEngine(bool useKernelQueue)
+        : impl_(new Impl())
+    {
+#ifdef SYS_io_uring_setup
+        if (
+            useKernelQueue
+            && impl_->SetUpKernelQueue()
+        ) {
+            impl_->completionWaiter = std::thread(&Impl::WaitForCompletions, impl_.get());
+            return;
+        }
+#endif /* SYS_io_uring_setup */
+        for (size_t i = 0; i < NUM_WORKER_THREADS; ++i) {
+            impl_->workers.emplace_back(&Impl::Worker, impl_.get());
+        }
+    }
+
+    bool FileIoEngine::IsUsingKernelQueue() const {
+#ifdef SYS_io_uring_setup
+        return (impl_->ringHandle >= 0);
+#else /* SYS_io_uring_setup */
+        return false;
+#endif /* SYS_io_uring_setup */
+    }
+
+    void FileIoEngine::ReadAt(
+        int handle,
+        uint64_t position,
+        void* buffer,
+        size_t numBytes,
+        CompletionDelegate completionDelegate
+    ) {
+        std::unique_ptr< Operation > operation(new Operation());
+        operation->type = Operation::Type::Read;
+        operation->handle = handle;
+        operation->position = position;
+        operation->vector.iov_base = buffer;
+        operation->vector.iov_len = numBytes;
+        operation->completionDelegate = std::move(completionDelegate);
+        impl_->Submit(std::move(operation));
+    }
+
+    void FileIoEngine::WriteAt(
+        int handle,
+        uint64_t position,
+        const void* buffer,
+        size_t numBytes,
+        CompletionDelegate completionDelegate
+    ) {
+        std::unique_ptr< Operation > operation(new Operation());
+        operation->type = Operation::Type::Write;
+        operation->handle = handle;
+        operation->position = position;
+        operation->vector.iov_base = (void*)buffer;
+        operation->vector.iov_len = numBytes;
+        operation->completionDelegate = std::move(completionDelegate);
+        impl_->Submit(std::move(operation));
+    }
+
+    void FileIoEngine::Sync(
+        int handle,
+        CompletionDelegate completionDelegate
+    ) {
+        std::unique_ptr< Operation > operation(new Operation());
+        operation->type = Operation::Type::Sync;
+        operation->handle = handle;
+        operation->completionDelegate = std::move(completionDelegate);
+        impl_->Submit(std::move(operation));
+    }
+
+}
@@ -8,11 +8,19 @@
  */
 
 #include "../FileImpl.hpp"
+#include "../WorkStealingPool.hpp"
+#include "FileIoEngine.hpp"
 #include "FilePosix.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <functional>
+#include <limits.h>
+#include <memory>
+#include <mutex>
 #include <pwd.h>
 #include <regex>
 #include <stddef.h>
@@ -25,7 +33,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <SystemAbstractions/File.hpp>
+#include <thread>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -36,6 +46,718 @@ namespace {
      */
     static const size_t MAX_BLOCK_COPY_SIZE = 65536;
 
+    /**
+     * This is the maximum number of threads to use to delete or copy
+     * the contents of a directory.
+     */
+    static const size_t MAX_DIRECTORY_TRAVERSAL_THREADS = 8;
+
+    /**
+     * This function returns the engine used to carry out asynchronous
+     * file operations, creating it the first time it's needed.
+     *
+     * @return
+     *     The engine used to carry out asynchronous file operations
+     *     is returned.
+     */
+    SystemAbstractions::FileIoEngine& GetFileIoEngine() {
+        static SystemAbstractions::FileIoEngine engine;
+        return engine;
+    }
+
+    /**
+     * This is the directory entry given to the visitor by the
+     * VisitDirectory method.  It's reused for each entry in the
+     * directory, and looks up the status of an entry (with fstatat,
+     * relative to the directory) only if and when it's asked for
+     * something the directory itself doesn't provide.
+     */
+    class DirectoryEntryPosix
+        : public SystemAbstractions::File::DirectoryEntry
+    {
+        // Properties
+    public:
+        /**
+         * This is the handle to the directory containing the entry.
+         */
+        int directoryHandle = -1;
+
+        /**
+         * This is the name of the entry.
+         */
+        std::string name;
+
+        /**
+         * This is the type of the entry, if known from the directory.
+         */
+        Type type = Type::Unknown;
+
+        /**
+         * This indicates whether or not the status of the entry
+         * has been looked up.
+         */
+        mutable bool statusKnown = false;
+
+        /**
+         * This indicates whether or not the status of the entry
+         * was successfully looked up.
+         */
+        mutable bool statusValid = false;
+
+        /**
+         * This is the status of the entry, if looked up.
+         */
+        mutable struct stat status;
+
+        // Methods
+    public:
+        /**
+         * This method sets up the object to represent the given
+         * entry in the directory.
+         *
+         * @param[in] entry
+         *     This is the entry read from the directory.
+         */
+        void Reset(const struct dirent* entry) {
+            name = entry->d_name;
+            statusKnown = false;
+            statusValid = false;
+#ifdef DT_UNKNOWN
+            switch (entry->d_type) {
+                case DT_REG: type = Type::File; break;
+                case DT_DIR: type = Type::Directory; break;
+                case DT_LNK: type = Type::SymbolicLink; break;
+                case DT_UNKNOWN: type = Type::Unknown; break;
+                default: type = Type::Other; break;
+            }
+#else /* not DT_UNKNOWN */
+            type = Type::Unknown;
+#endif /* DT_UNKNOWN / not DT_UNKNOWN */
+        }
+
+        /**
+         * This method looks up the status of the entry,
+         * if it hasn't been looked up already.
+         *
+         * @return
+         *     A flag indicating whether or not the status of the
+         *     entry is known is returned.
+         */
+        bool LookUpStatus() const {
+            if (!statusKnown) {
+                statusKnown = true;
+                statusValid = (
+                    fstatat(
+                        directoryHandle,
+                        name.c_str(),
+                        &status,
+                        AT_SYMLINK_NOFOLLOW
+                    ) == 0
+                );
+            }
+            return statusValid;
+        }
+
+        // SystemAbstractions::File::DirectoryEntry
+    public:
+        virtual const std::string& GetName() const override {
+            return name;
+        }
+
+        virtual Type GetType() const override {
+            if (type != Type::Unknown) {
+                return type;
+            }
+            if (!LookUpStatus()) {
+                return Type::Unknown;
+            }
+            if (S_ISREG(status.st_mode)) {
+                return Type::File;
+            } else if (S_ISDIR(status.st_mode)) {
+                return Type::Directory;
+            } else if (S_ISLNK(status.st_mode)) {
+                return Type::SymbolicLink;
+            } else {
+                return Type::Other;
+            }
+        }
+
+        virtual uint64_t GetSize() const override {
+            if (LookUpStatus()) {
+                return (uint64_t)status.st_size;
+            } else {
+                return 0;
+            }
+        }
+
+        virtual time_t GetLastModifiedTime() const override {
+            if (LookUpStatus()) {
+                return status.st_mtime;
+            } else {
+                return 0;
+            }
+        }
+    };
+
+
+    /**
+     * This represents a directory opened as part of deleting or
+     * copying a directory tree.  Entries in the directory are accessed
+     * relative to its handle, rather than by path, and the directory
+     * is closed once nothing refers to it any more.
+     */
+    struct OpenDirectory {
+        // Properties
+
+        /**
+         * This is the directory containing this directory, or null
+         * if this is the top of the tree.
+         */
+        std::shared_ptr< OpenDirectory > parent;
+
+        /**
+         * This is the name of the directory in its parent, or
+         * its full path if this is the top of the tree.
+         */
+        std::string name;
+
+        /**
+         * This is the operating-system handle to the directory.
+         */
+        int handle = -1;
+
+        /**
+         * This is the number of things which still need to be done
+         * with the directory before it's finished with.  It's used
+         * when deleting, where a directory can't be removed until
+         * everything in it has been.
+         */
+        std::atomic< size_t > remaining;
+
+        /**
+         * This flag is set if anything in the directory
+         * couldn't be deleted.
+         */
+        std::atomic< bool > incomplete;
+
+        // Methods
+
+        /**
+         * This is the constructor of the structure.
+         *
+         * @param[in] parent
+         *     This is the directory containing this directory, or null
+         *     if this is the top of the tree.
+         *
+         * @param[in] name
+         *     This is the name of the directory in its parent, or
+         *     its full path if this is the top of the tree.
+         */
+        OpenDirectory(
+            std::shared_ptr< OpenDirectory > parent,
+            std::string name
+        )
+            : parent(parent)
+            , name(name)
+            , remaining(0)
+            , incomplete(false)
+        {
+        }
+
+        /**
+         * This is the destructor of the structure.
+         */
+        ~OpenDirectory() noexcept {
+            Close();
+        }
+
+        /**
+         * This method closes the directory, if it's open.
+         */
+        void Close() {
+            if (handle >= 0) {
+                (void)close(handle);
+                handle = -1;
+            }
+        }
+
+        /**
+         * This method returns the handle to use to access this
+         * directory relative to its parent.
+         *
+         * @return
+         *     The handle to use to access this directory relative
+         *     to its parent is returned.
+         */
+        int GetParentHandle() const {
+            if (parent == nullptr) {
+                return AT_FDCWD;
+            } else {
+                return parent->handle;
+            }
+        }
+
+        /**
+         * This method opens the directory, relative to its parent.
+         *
+         * @return
+         *     A flag indicating whether or not the directory
+         *     was opened is returned.
+         */
+        bool Open() {
+            handle = openat(
+                GetParentHandle(),
+                name.c_str(),
+                (
+                    O_RDONLY | O_DIRECTORY | O_CLOEXEC
+                    | ((parent == nullptr) ? 0 : O_NOFOLLOW)
+                )
+            );
+            return (handle >= 0);
+        }
+
+        /**
+         * This method constructs the path to the given entry in the
+         * directory.  It's only used to report failures, so that paths
+         * don't need to be built for everything in the tree.
+         *
+         * @param[in] entryName
+         *     This is the name of the entry in the directory,
+         *     or an empty string for the directory itself.
+         *
+         * @return
+         *     The path to the given entry in the directory is returned.
+         */
+        std::string GetPath(const std::string& entryName) const {
+            std::string path;
+            if (parent == nullptr) {
+                path = name;
+            } else {
+                path = parent->GetPath(name);
+            }
+            if (
+                !entryName.empty()
+                && !path.empty()
+                && (path[path.length() - 1] != '/')
+            ) {
+                path += '/';
+            }
+            return path + entryName;
+        }
+
+        /**
+         * This method calls the given function for each entry
+         * in the directory.
+         *
+         * @param[in] visitor
+         *     This is the function to call for each entry.
+         *
+         * @return
+         *     A flag indicating whether or not the directory
+         *     could be read is returned.
+         */
+        bool Visit(std::function< void(const DirectoryEntryPosix& entry) > visitor) {
+            const auto streamHandle = dup(handle);
+            if (streamHandle < 0) {
+                return false;
+            }
+            DIR* dir = fdopendir(streamHandle);
+            if (dir == NULL) {
+                (void)close(streamHandle);
+                return false;
+            }
+            DirectoryEntryPosix entry;
+            entry.directoryHandle = handle;
+            bool success = true;
+            while (true) {
+                errno = 0;
+                const auto nextEntry = readdir(dir);
+                if (nextEntry == NULL) {
+                    success = (errno == 0);
+                    break;
+                }
+                if (
+                    (strcmp(nextEntry->d_name, ".") == 0)
+                    || (strcmp(nextEntry->d_name, "..") == 0)
+                ) {
+                    continue;
+                }
+                entry.Reset(nextEntry);
+                visitor(entry);
+            }
+            (void)closedir(dir);
+            return success;
+        }
+    };
+
+    /**
+     * This holds what's shared by everything done to delete
+     * or copy one directory tree, including the pool of threads
+     * doing it.  The top directory is handled by the calling thread,
+     * and the pool is only started once there's other work to hand
+     * it, so that small trees don't pay for starting threads.
+     */
+    struct DirectoryTraversal {
+        // Properties
+
+        /**
+         * This is the number of files deleted or copied.
+         */
+        std::atomic< size_t > filesProcessed;
+
+        /**
+         * This is the number of directories deleted or copied.
+         */
+        std::atomic< size_t > directoriesProcessed;
+
+        /**
+         * This is the number of entries which couldn't be deleted or copied.
+         */
+        std::atomic< size_t > failures;
+
+        /**
+         * This is the path of the first entry which couldn't
+         * be deleted or copied.
+         */
+        std::string firstFailurePath;
+
+        /**
+         * This is used to synchronize access to the first failure path.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is the function used to copy the contents of files.
+         */
+        bool (*copyContents)(int source, int destination) = nullptr;
+
+        /**
+         * These are the threads doing the work, once started.
+         */
+        std::unique_ptr< SystemAbstractions::WorkStealingPool > pool;
+
+        // Methods
+
+        /**
+         * This is the constructor of the structure.
+         */
+        DirectoryTraversal()
+            : filesProcessed(0)
+            , directoriesProcessed(0)
+            , failures(0)
+        {
+        }
+
+        /**
+         * This method hands the given work to the pool,
+         * starting the pool first if necessary.
+         *
+         * @param[in] task
+         *     This is the work to hand to the pool.
+         */
+        void Submit(SystemAbstractions::WorkStealingPool::Task task) {
+            if (pool == nullptr) {
+                pool.reset(
+                    new SystemAbstractions::WorkStealingPool(
+                        std::min(
+                            MAX_DIRECTORY_TRAVERSAL_THREADS,
+                            (size_t)std::max(std::thread::hardware_concurrency(), 1u)
+                        )
+                    )
+                );
+            }
+            pool->Submit(std::move(task));
+        }
+
+        /**
+         * This method records that the given entry couldn't
+         * be deleted or copied.
+         *
+         * @param[in] directory
+         *     This is the directory containing the entry.
+         *
+         * @param[in] name
+         *     This is the name of the entry in the directory.
+         */
+        void Fail(const OpenDirectory& directory, const std::string& name) {
+            if (failures++ == 0) {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                firstFailurePath = directory.GetPath(name);
+            }
+        }
+
+        /**
+         * This method waits for all the work to be done,
+         * and then summarizes it.
+         *
+         * @return
+         *     A summary of the work done is returned.
+         */
+        SystemAbstractions::File::DirectoryOperationResult Finish() {
+            if (pool != nullptr) {
+                pool->Wait();
+            }
+            SystemAbstractions::File::DirectoryOperationResult result;
+            result.filesProcessed = filesProcessed;
+            result.directoriesProcessed = directoriesProcessed;
+            result.failures = failures;
+            result.firstFailurePath = firstFailurePath;
+            return result;
+        }
+
+        /**
+         * This method deletes the given directory and everything in it.
+         * Files are deleted right away, while subdirectories are handed
+         * to the pool to delete.  The directory itself is removed
+         * once everything in it has been.
+         *
+         * @param[in] directory
+         *     This is the directory to delete.
+         */
+        void Delete(std::shared_ptr< OpenDirectory > directory) {
+            if (!directory->Open()) {
+                if (
+                    (directory->parent != nullptr)
+                    || (errno != ENOENT)
+                ) {
+                    Fail(*directory, "");
+                    directory->incomplete = true;
+                    FinishDeleting(directory);
+                }
+                return;
+            }
+            directory->remaining = 1;
+            const auto readSuccess = directory->Visit(
+                [this, &directory](const DirectoryEntryPosix& entry){
+                    if (entry.GetType() == SystemAbstractions::File::DirectoryEntry::Type::Directory) {
+                        ++directory->remaining;
+                        const auto subdirectory = std::make_shared< OpenDirectory >(
+                            directory,
+                            entry.GetName()
+                        );
+                        Submit([this, subdirectory]{ Delete(subdirectory); });
+                    } else if (unlinkat(directory->handle, entry.GetName().c_str(), 0) == 0) {
+                        ++filesProcessed;
+                    } else {
+                        Fail(*directory, entry.GetName());
+                        directory->incomplete = true;
+                    }
+                }
+            );
+            if (!readSuccess) {
+                Fail(*directory, "");
+                directory->incomplete = true;
+            }
+            FinishDeleting(directory);
+        }
+
+        /**
+         * This method is called whenever something in the given
+         * directory is done being deleted, or when the directory is
+         * done being read.  When there's nothing left to do, the
+         * directory itself is removed, and its parent is told.
+         *
+         * @param[in] directory
+         *     This is the directory being deleted.
+         */
+        void FinishDeleting(std::shared_ptr< OpenDirectory > directory) {
+            if (
+                (directory->handle >= 0)
+                && (--directory->remaining != 0)
+            ) {
+                return;
+            }
+            directory->Close();
+            const auto parent = directory->parent;
+            if (directory->incomplete) {
+                if (parent != nullptr) {
+                    parent->incomplete = true;
+                }
+            } else if (
+                unlinkat(
+                    directory->GetParentHandle(),
+                    directory->name.c_str(),
+                    AT_REMOVEDIR
+                ) == 0
+            ) {
+                ++directoriesProcessed;
+            } else {
+                Fail(*directory, "");
+                if (parent != nullptr) {
+                    parent->incomplete = true;
+                }
+            }
+            if (parent != nullptr) {
+                directory.reset();
+                FinishDeleting(parent);
+            }
+        }
+
+        /**
+         * This method copies everything in the given source directory
+         * into the given destination directory, which has already been
+         * created.  Symbolic links are recreated right away, while files
+         * and subdirectories are handed to the pool to copy.
+         *
+         * @param[in] source
+         *     This is the directory to copy.
+         *
+         * @param[in] destination
+         *     This is the directory into which to copy.
+         */
+        void CopyContents(
+            std::shared_ptr< OpenDirectory > source,
+            std::shared_ptr< OpenDirectory > destination
+        ) {
+            std::vector< char > link;
+            const auto readSuccess = source->Visit(
+                [this, &source, &destination, &link](const DirectoryEntryPosix& entry){
+                    const auto& name = entry.GetName();
+                    switch (entry.GetType()) {
+                        case SystemAbstractions::File::DirectoryEntry::Type::Directory: {
+                            Submit(
+                                [this, source, destination, name]{
+                                    CopySubdirectory(source, destination, name);
+                                }
+                            );
+                        } break;
+
+                        case SystemAbstractions::File::DirectoryEntry::Type::File: {
+                            Submit(
+                                [this, source, destination, name]{
+                                    CopyFile(source, destination, name);
+                                }
+                            );
+                        } break;
+
+                        case SystemAbstractions::File::DirectoryEntry::Type::SymbolicLink: {
+                            link.resize(PATH_MAX);
+                            const auto linkLength = readlinkat(
+                                source->handle,
+                                name.c_str(),
+                                link.data(),
+                                link.size() - 1
+                            );
+                            if (linkLength < 0) {
+                                Fail(*source, name);
+                                break;
+                            }
+                            link[linkLength] = '\0';
+                            if (symlinkat(link.data(), destination->handle, name.c_str()) == 0) {
+                                ++filesProcessed;
+                            } else {
+                                Fail(*destination, name);
+                            }
+                        } break;
+
+                        default: {
+                            Fail(*source, name);
+                        } break;
+                    }
+                }
+            );
+            if (!readSuccess) {
+                Fail(*source, "");
+            }
+        }
+
+        /**
+         * This method creates a copy of the given subdirectory,
+         * and then copies everything in it.
+         *
+         * @param[in] sourceParent
+         *     This is the directory containing the subdirectory to copy.
+         *
+         * @param[in] destinationParent
+         *     This is the directory in which to create the copy.
+         *
+         * @param[in] name
+         *     This is the name of the subdirectory to copy.
+         */
+        void CopySubdirectory(
+            std::shared_ptr< OpenDirectory > sourceParent,
+            std::shared_ptr< OpenDirectory > destinationParent,
+            const std::string& name
+        ) {
+            const auto source = std::make_shared< OpenDirectory >(sourceParent, name);
+            if (!source->Open()) {
+                Fail(*sourceParent, name);
+                return;
+            }
+            struct stat s;
+            if (fstat(source->handle, &s) != 0) {
+                Fail(*sourceParent, name);
+                return;
+            }
+            if (
+                (mkdirat(destinationParent->handle, name.c_str(), (s.st_mode & 07777) | S_IRWXU) != 0)
+                && (errno != EEXIST)
+            ) {
+                Fail(*destinationParent, name);
+                return;
+            }
+            const auto destination = std::make_shared< OpenDirectory >(destinationParent, name);
+            if (!destination->Open()) {
+                Fail(*destinationParent, name);
+                return;
+            }
+            ++directoriesProcessed;
+            CopyContents(source, destination);
+        }
+
+        /**
+         * This method copies the given file.
+         *
+         * @param[in] source
+         *     This is the directory containing the file to copy.
+         *
+         * @param[in] destination
+         *     This is the directory in which to create the copy.
+         *
+         * @param[in] name
+         *     This is the name of the file to copy.
+         */
+        void CopyFile(
+            std::shared_ptr< OpenDirectory > source,
+            std::shared_ptr< OpenDirectory > destination,
+            const std::string& name
+        ) {
+            const auto sourceHandle = openat(
+                source->handle,
+                name.c_str(),
+                O_RDONLY | O_CLOEXEC | O_NOFOLLOW
+            );
+            if (sourceHandle < 0) {
+                Fail(*source, name);
+                return;
+            }
+            struct stat s;
+            if (fstat(sourceHandle, &s) != 0) {
+                (void)close(sourceHandle);
+                Fail(*source, name);
+                return;
+            }
+            const auto destinationHandle = openat(
+                destination->handle,
+                name.c_str(),
+                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                (s.st_mode & 07777) | S_IRUSR | S_IWUSR
+            );
+            if (destinationHandle < 0) {
+                (void)close(sourceHandle);
+                Fail(*destination, name);
+                return;
+            }
+            if (copyContents(sourceHandle, destinationHandle)) {
+                ++filesProcessed;
+            } else {
+                Fail(*destination, name);
+            }
+            (void)close(sourceHandle);
+            (void)close(destinationHandle);
+        }
+    };
+
 }
 
 namespace SystemAbstractions {
@@ -161,24 +883,18 @@ namespace SystemAbstractions {
             if (!OpenReadOnly()) {
                 return false;
             }
-        } else {
-            SetPosition(0);
         }
         File newFile(destination);
         if (!newFile.OpenReadWrite()) {
             return false;
         }
-        IFile::Buffer buffer(MAX_BLOCK_COPY_SIZE);
-        for (;;) {
-            const size_t amt = Read(buffer);
-            if (amt == 0) {
-                break;
-            }
-            if (newFile.Write(buffer, amt) != amt) {
-                return false;
-            }
+        if (!newFile.SetSize(0)) {
+            return false;
         }
-        return true;
+        return Platform::CopyContents(
+            impl_->platform->handle,
+            newFile.impl_->platform->handle
+        );
     }
 
     time_t File::GetLastModifiedTime() const {
@@ -218,139 +934,111 @@ namespace SystemAbstractions {
             directoryWithSeparator += '/';
         }
         list.clear();
-        DIR* dir = opendir(directory.c_str());
-        if (dir != NULL) {
-            struct dirent entry;
-            struct dirent* entryBack;
-            while (true) {
-                if (readdir_r(dir, &entry, &entryBack)) {
-                    break;
-                }
-                if (entryBack == NULL) {
-                    break;
-                }
-                std::string name(entry.d_name);
-                if (
-                    (name == ".")
-                    || (name == "..")
-                ) {
-                    continue;
-                }
-                std::string filePath(directoryWithSeparator);
-                filePath += name;
-                list.push_back(filePath);
+        (void)VisitDirectory(
+            directory,
+            [&](const DirectoryEntry& entry){
+                list.push_back(directoryWithSeparator + entry.GetName());
+                return true;
             }
-            (void)closedir(dir);
-        }
+        );
     }
 
-    bool File::DeleteDirectory(const std::string& directory) {
-        std::string directoryWithSeparator(directory);
-        if (
-            (directoryWithSeparator.length() > 0)
-            && (directoryWithSeparator[directoryWithSeparator.length() - 1] != '/')
-        ) {
-            directoryWithSeparator += '/';
-        }
+    bool File::VisitDirectory(
+        const std::string& directory,
+        DirectoryVisitor visitor
+    ) {
         DIR* dir = opendir(directory.c_str());
-        if (dir != NULL) {
-            struct dirent entry;
-            struct dirent* entryBack;
-            while (true) {
-                if (readdir_r(dir, &entry, &entryBack)) {
-                    break;
-                }
-                if (entryBack == NULL) {
-                    break;
-                }
-                std::string name(entry.d_name);
-                if (
-                    (name == ".")
-                    || (name == "..")
-                ) {
-                    continue;
-                }
-                std::string filePath(directoryWithSeparator);
-                filePath += entry.d_name;
-                if (entry.d_type == DT_DIR) {
-                    if (!DeleteDirectory(filePath.c_str())) {
-                        return false;
-                    }
-                } else {
-                    if (unlink(filePath.c_str()) != 0) {
-                        return false;
-                    }
-                }
+        if (dir == NULL) {
+            return false;
+        }
+        DirectoryEntryPosix entry;
+        entry.directoryHandle = dirfd(dir);
+        bool success = true;
+        while (true) {
+            errno = 0;
+            const auto nextEntry = readdir(dir);
+            if (nextEntry == NULL) {
+                success = (errno == 0);
+                break;
+            }
+            if (
+                (strcmp(nextEntry->d_name, ".") == 0)
+                || (strcmp(nextEntry->d_name, "..") == 0)
+            ) {
+                continue;
+            }
+            entry.Reset(nextEntry);
+            if (!visitor(entry)) {
+                break;
             }
-            (void)closedir(dir);
-            return (rmdir(directory.c_str()) == 0);
         }
-        return true;
+        (void)closedir(dir);
+        return success;
+    }
+
+    bool File::DeleteDirectory(
+        const std::string& directory,
+        DirectoryOperationResult& result
+    ) {
+        DirectoryTraversal traversal;
+        const auto top = std::make_shared< OpenDirectory >(nullptr, directory);
+        traversal.Delete(top);
+        result = traversal.Finish();
+        return (bool)result;
     }
 
     bool File::CopyDirectory(
         const std::string& existingDirectory,
-        const std::string& newDirectory
+        const std::string& newDirectory,
+        DirectoryOperationResult& result
     ) {
-        std::string existingDirectoryWithSeparator(existingDirectory);
-        if (
-            (existingDirectoryWithSeparator.length() > 0)
-            && (existingDirectoryWithSeparator[existingDirectoryWithSeparator.length() - 1] != '/')
+        DirectoryTraversal traversal;
+        traversal.copyContents = Platform::CopyContents;
+        const auto source = std::make_shared< OpenDirectory >(nullptr, existingDirectory);
+        const auto destination = std::make_shared< OpenDirectory >(nullptr, newDirectory);
+        if (!source->Open()) {
+            traversal.Fail(*source, "");
+        } else if (
+            !Impl::CreatePath(newDirectory + "/")
+            || !destination->Open()
         ) {
-            existingDirectoryWithSeparator += '/';
-        }
-        std::string newDirectoryWithSeparator(newDirectory);
-        if (
-            (newDirectoryWithSeparator.length() > 0)
-            && (newDirectoryWithSeparator[newDirectoryWithSeparator.length() - 1] != '/')
-        ) {
-            newDirectoryWithSeparator += '/';
-        }
-        if (!Impl::CreatePath(newDirectoryWithSeparator)) {
-            return false;
+            traversal.Fail(*destination, "");
+        } else {
+            ++traversal.directoriesProcessed;
+            traversal.CopyContents(source, destination);
         }
-        DIR* dir = opendir(existingDirectory.c_str());
-        if (dir != NULL) {
-            struct dirent entry;
-            struct dirent* entryBack;
-            std::vector< char > link(PATH_MAX);
-            while (true) {
-                if (readdir_r(dir, &entry, &entryBack)) {
-                    break;
-                }
-                if (entryBack == NULL) {
-                    break;
-                }
-                std::string name(entry.d_name);
-                if (
-                    (name == ".")
-                    || (name == "..")
-                ) {
-                    continue;
-                }
-                std::string filePath(existingDirectoryWithSeparator);
-                filePath += entry.d_name;
-                std::string newFilePath(newDirectoryWithSeparator);
-                newFilePath += entry.d_name;
-                if (entry.d_type == DT_DIR) {
-                    if (!CopyDirectory(filePath, newFilePath)) {
-                        return false;
-                    }
-                } else if (entry.d_type == DT_LNK) {
-                    if (readlink(filePath.c_str(), &link[0], link.size()) < 0) {
-                        return false;
-                    }
-                    if (symlink(&link[0], newFilePath.c_str()) < 0) {
-                        return false;
-                    }
-                } else {
-                    File file(filePath);
-                    if (!file.Copy(newFilePath)) {
-                        return false;
-                    }
+        result = traversal.Finish();
+        return (bool)result;
+    }
+
+    bool File::Platform::CopyContentsThroughBuffer(
+        int source,
+        int destination,
+        uint64_t offset
+    ) {
+        IFile::Buffer buffer(MAX_BLOCK_COPY_SIZE);
+        for (;;) {
+            const auto amountRead = pread(source, buffer.data(), buffer.size(), (off_t)offset);
+            if (amountRead < 0) {
+                return false;
+            }
+            if (amountRead == 0) {
+                break;
+            }
+            size_t amountWritten = 0;
+            while (amountWritten < (size_t)amountRead) {
+                const auto writeResult = pwrite(
+                    destination,
+                    buffer.data() + amountWritten,
+                    (size_t)amountRead - amountWritten,
+                    (off_t)(offset + amountWritten)
+                );
+                if (writeResult <= 0) {
+                    return false;
                 }
+                amountWritten += (size_t)writeResult;
             }
-            (void)closedir(dir);
+            offset += (uint64_t)amountRead;
         }
         return true;
     }
@@ -373,20 +1061,11 @@ namespace SystemAbstractions {
         if (impl_->platform->handle < 0) {
             return 0;
         }
-        const auto originalPosition = lseek(impl_->platform->handle, 0, SEEK_CUR);
-        if (originalPosition == (off_t)-1) {
-            return 0;
-        }
-        if (lseek(impl_->platform->handle, 0, SEEK_END) == (off_t)-1) {
-            (void)lseek(impl_->platform->handle, originalPosition, SEEK_SET);
-            return 0;
-        }
-        const auto endPosition = lseek(impl_->platform->handle, 0, SEEK_CUR);
-        (void)lseek(impl_->platform->handle, originalPosition, SEEK_SET);
-        if (endPosition == (off_t)-1) {
+        struct stat s;
+        if (fstat(impl_->platform->handle, &s) != 0) {
             return 0;
         }
-        return (uint64_t)endPosition;
+        return (uint64_t)s.st_size;
     }
 
     bool File::SetSize(uint64_t size) {
@@ -416,12 +1095,18 @@ namespace SystemAbstractions {
         if (impl_->platform->handle < 0) {
             return 0;
         }
-        const auto originalPosition = lseek(impl_->platform->handle, 0, SEEK_CUR);
-        if (originalPosition == (off_t)-1) {
+        const auto position = lseek(impl_->platform->handle, 0, SEEK_CUR);
+        if (position == (off_t)-1) {
+            return 0;
+        }
+        return ReadAt((uint64_t)position, buffer, numBytes);
+    }
+
+    size_t File::Read(void* buffer, size_t numBytes) {
+        if (impl_->platform->handle < 0) {
             return 0;
         }
         const auto readResult = read(impl_->platform->handle, buffer, numBytes);
-        (void)lseek(impl_->platform->handle, originalPosition, SEEK_SET);
         return (
             (readResult < 0)
             ? (size_t)0
@@ -429,11 +1114,23 @@ namespace SystemAbstractions {
         );
     }
 
-    size_t File::Read(void* buffer, size_t numBytes) {
+    size_t File::Write(const void* buffer, size_t numBytes) {
         if (impl_->platform->handle < 0) {
             return 0;
         }
-        const auto readResult = read(impl_->platform->handle, buffer, numBytes);
+        const auto amountWritten = write(impl_->platform->handle, buffer, numBytes);
+        return (
+            (amountWritten < 0)
+            ? (size_t)0
+            : (size_t)amountWritten
+        );
+    }
+
+    size_t File::ReadAt(uint64_t position, void* buffer, size_t numBytes) const {
+        if (impl_->platform->handle < 0) {
+            return 0;
+        }
+        const auto readResult = pread(impl_->platform->handle, buffer, numBytes, (off_t)position);
         return (
             (readResult < 0)
             ? (size_t)0
@@ -441,11 +1138,11 @@ namespace SystemAbstractions {
         );
     }
 
-    size_t File::Write(const void* buffer, size_t numBytes) {
+    size_t File::WriteAt(uint64_t position, const void* buffer, size_t numBytes) {
         if (impl_->platform->handle < 0) {
             return 0;
         }
-        const auto amountWritten = write(impl_->platform->handle, buffer, numBytes);
+        const auto amountWritten = pwrite(impl_->platform->handle, buffer, numBytes, (off_t)position);
         return (
             (amountWritten < 0)
             ? (size_t)0
@@ -453,6 +1150,89 @@ namespace SystemAbstractions {
         );
     }
 
+    void File::ReadAtAsync(
+        uint64_t position,
+        void* buffer,
+        size_t numBytes,
+        AsyncCompletionDelegate completionDelegate
+    ) {
+        if (impl_->platform->handle < 0) {
+            completionDelegate(false, 0);
+            return;
+        }
+        GetFileIoEngine().ReadAt(
+            impl_->platform->handle,
+            position,
+            buffer,
+            numBytes,
+            completionDelegate
+        );
+    }
+
+    void File::WriteAtAsync(
+        uint64_t position,
+        const void* buffer,
+        size_t numBytes,
+        AsyncCompletionDelegate completionDelegate
+    ) {
+        if (impl_->platform->handle < 0) {
+            completionDelegate(false, 0);
+            return;
+        }
+        GetFileIoEngine().WriteAt(
+            impl_->platform->handle,
+            position,
+            buffer,
+            numBytes,
+            completionDelegate
+        );
+    }
+
+    void File::SyncAsync(AsyncCompletionDelegate completionDelegate) {
+        if (impl_->platform->handle < 0) {
+            completionDelegate(false, 0);
+            return;
+        }
+        GetFileIoEngine().Sync(
+            impl_->platform->handle,
+            completionDelegate
+        );
+    }
+
+    bool File::Preallocate(
+        uint64_t position,
+        uint64_t numBytes,
+        bool changeSize
+    ) {
+        if (impl_->platform->handle < 0) {
+            return false;
+        }
+        return Platform::Preallocate(
+            impl_->platform->handle,
+            position,
+            numBytes,
+            changeSize
+        );
+    }
+
+    bool File::PunchHole(uint64_t position, uint64_t numBytes) {
+        if (impl_->platform->handle < 0) {
+            return false;
+        }
+        return Platform::PunchHole(
+            impl_->platform->handle,
+            position,
+            numBytes
+        );
+    }
+
+    bool File::Sync(SyncMode mode) {
+        if (impl_->platform->handle < 0) {
+            return false;
+        }
+        return Platform::Sync(impl_->platform->handle, mode);
+    }
+
     std::shared_ptr< IFile > File::Clone() {
         auto clone = std::make_shared< File >(impl_->path);
         clone->impl_->platform->writeAccess = impl_->platform->writeAccess;
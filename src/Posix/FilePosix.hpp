@@ -10,6 +10,7 @@
  * Copyright (c) 2016 by Richard Walters
  */
 
+#include <stdint.h>
 #include <string>
 #include <SystemAbstractions/File.hpp>
 
@@ -29,6 +30,124 @@ namespace SystemAbstractions {
          * opened with write access.
          */
         bool writeAccess = false;
+
+        // Methods
+
+        /**
+         * This function copies the entire contents of one open file
+         * to another, having the operating system kernel do the copying
+         * where possible, rather than passing the data through
+         * user space.  It's implemented for each platform.
+         *
+         * @param[in] source
+         *     This is the operating-system handle to the file to copy.
+         *
+         * @param[in] destination
+         *     This is the operating-system handle to the file
+         *     into which to copy.  It should be empty.
+         *
+         * @return
+         *     A flag indicating whether or not the function succeeded
+         *     is returned.
+         */
+        static bool CopyContents(int source, int destination);
+
+        /**
+         * This function copies the contents of one open file to another,
+         * from the given offset to the end of the source file,
+         * by reading and writing them through a buffer in user space.
+         * It's used when the kernel can't do the copying.
+         *
+         * @param[in] source
+         *     This is the operating-system handle to the file to copy.
+         *
+         * @param[in] destination
+         *     This is the operating-system handle to the file
+         *     into which to copy.
+         *
+         * @param[in] offset
+         *     This is the offset in both files at which to start copying.
+         *
+         * @return
+         *     A flag indicating whether or not the function succeeded
+         *     is returned.
+         */
+        static bool CopyContentsThroughBuffer(
+            int source,
+            int destination,
+            uint64_t offset
+        );
+
+        /**
+         * This function reserves storage for a region of an open file.
+         * It's implemented for each platform.
+         *
+         * @param[in] handle
+         *     This is the operating-system handle to the file.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte
+         *     of the region.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes in the region.
+         *
+         * @param[in] changeSize
+         *     This indicates whether or not to extend the size of
+         *     the file to include the region, if it doesn't already.
+         *
+         * @return
+         *     A flag indicating whether or not the function succeeded
+         *     is returned.
+         */
+        static bool Preallocate(
+            int handle,
+            uint64_t position,
+            uint64_t numBytes,
+            bool changeSize
+        );
+
+        /**
+         * This function releases the storage used by a region of an
+         * open file, without changing its size.  It's implemented
+         * for each platform.
+         *
+         * @param[in] handle
+         *     This is the operating-system handle to the file.
+         *
+         * @param[in] position
+         *     This is the position in the file of the first byte
+         *     of the region.
+         *
+         * @param[in] numBytes
+         *     This is the number of bytes in the region.
+         *
+         * @return
+         *     A flag indicating whether or not the function succeeded
+         *     is returned.
+         */
+        static bool PunchHole(
+            int handle,
+            uint64_t position,
+            uint64_t numBytes
+        );
+
+        /**
+         * This function makes data written to an open file durable,
+         * in the given way.  It's implemented for each platform.
+         *
+         * @param[in] handle
+         *     This is the operating-system handle to the file.
+         *
+         * @param[in] mode
+         *     This selects what is written back to storage, and
+         *     whether or not to wait for it.
+         *
+         * @return
+         *     A flag indicating whether or not the function succeeded
+         *     is returned.
+         */
+        static bool Sync(int handle, SyncMode mode);
     };
 
 }
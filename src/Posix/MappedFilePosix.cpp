@@ -0,0 +1,169 @@
+/**
+ * @file MappedFilePosix.cpp
+ *
+ * This module contains the Posix specific part of the
+ * implementation of the SystemAbstractions::MappedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "../MappedFileImpl.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <SystemAbstractions/MappedFile.hpp>
+#include <unistd.h>
+
+namespace SystemAbstractions {
+
+    /**
+     * This is the POSIX-specific state for the MappedFile class.
+     */
+    struct MappedFile::Platform {
+        /**
+         * This is the operating-system handle to the underlying file.
+         */
+        int handle = -1;
+
+        // Methods
+
+        /**
+         * This method maps the given number of bytes of the file
+         * into memory.
+         *
+         * @param[in] size
+         *     This is the number of bytes of the file to map.
+         *
+         * @param[in] write
+         *     This flag indicates whether or not the mapping
+         *     should allow writing.
+         *
+         * @return
+         *     A pointer to the mapped contents of the file is returned.
+         *     It's null if the size is zero or the mapping failed.
+         */
+        uint8_t* Map(uint64_t size, bool write) {
+            if (size == 0) {
+                return nullptr;
+            }
+            const auto data = mmap(
+                NULL,
+                (size_t)size,
+                (write ? (PROT_READ | PROT_WRITE) : PROT_READ),
+                MAP_SHARED,
+                handle,
+                0
+            );
+            if (data == MAP_FAILED) {
+                return nullptr;
+            }
+            return (uint8_t*)data;
+        }
+    };
+
+    MappedFile::Impl::~Impl() noexcept {
+        Close();
+    }
+
+    MappedFile::Impl::Impl()
+        : platform(new Platform())
+    {
+    }
+
+    bool MappedFile::Impl::Open(bool write) {
+        if (write) {
+            platform->handle = open(
+                path.c_str(),
+                O_RDWR | O_CREAT | O_CLOEXEC,
+                S_IRUSR | S_IWUSR
+            );
+        } else {
+            platform->handle = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (platform->handle < 0) {
+            return false;
+        }
+        struct stat s;
+        if (fstat(platform->handle, &s) != 0) {
+            Close();
+            return false;
+        }
+        size = (uint64_t)s.st_size;
+        capacity = size;
+        data = platform->Map(size, write);
+        if (
+            (size > 0)
+            && (data == nullptr)
+        ) {
+            Close();
+            return false;
+        }
+        position = 0;
+        writeAccess = write;
+        isOpen = true;
+        return true;
+    }
+
+    void MappedFile::Impl::Close() {
+        if (data != nullptr) {
+            (void)munmap(data, (size_t)capacity);
+            data = nullptr;
+        }
+        if (platform->handle >= 0) {
+            if (
+                writeAccess
+                && (capacity != size)
+            ) {
+                (void)ftruncate(platform->handle, (off_t)size);
+            }
+            (void)close(platform->handle);
+            platform->handle = -1;
+        }
+        size = 0;
+        capacity = 0;
+        writeAccess = false;
+        isOpen = false;
+    }
+
+    bool MappedFile::Impl::Reserve(uint64_t newCapacity) {
+        if (newCapacity <= capacity) {
+            return true;
+        }
+        if (ftruncate(platform->handle, (off_t)newCapacity) != 0) {
+            return false;
+        }
+        const auto newData = platform->Map(newCapacity, writeAccess);
+        if (newData == nullptr) {
+            (void)ftruncate(platform->handle, (off_t)capacity);
+            return false;
+        }
+        if (data != nullptr) {
+            (void)munmap(data, (size_t)capacity);
+        }
+        data = newData;
+        capacity = newCapacity;
+        return true;
+    }
+
+    bool MappedFile::Impl::Trim() {
+        if (capacity == size) {
+            return true;
+        }
+        const auto newData = platform->Map(size, writeAccess);
+        if (
+            (size > 0)
+            && (newData == nullptr)
+        ) {
+            return false;
+        }
+        if (data != nullptr) {
+            (void)munmap(data, (size_t)capacity);
+        }
+        data = newData;
+        capacity = size;
+        return (ftruncate(platform->handle, (off_t)size) == 0);
+    }
+
+}
@@ -7,6 +7,7 @@
  * Copyright (c) 2016 by Richard Walters
  */
 
+#include "../BufferPool.hpp"
 #include "../NetworkConnectionImpl.hpp"
 #include "NetworkConnectionPosix.hpp"
 
@@ -15,13 +16,16 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <mutex>
 #include <netdb.h>
 #include <string.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <string.h>
+#include <thread>
 #include <unistd.h>
 
 #ifndef MSG_NOSIGNAL
@@ -31,7 +35,53 @@
 namespace {
 
     static const size_t MAXIMUM_READ_SIZE = 65536;
-    static const size_t MAXIMUM_WRITE_SIZE = 65536;
+
+    /**
+     * This is the maximum number of separately queued pieces of data
+     * to try to hand to the operating system at once when sending.
+     */
+    static const size_t MAXIMUM_WRITE_SEGMENTS = 64;
+
+    /**
+     * This is the maximum number of rounds of receiving and sending
+     * data to do for a connection processed by a shared event loop,
+     * each time its socket is ready, before letting the event loop
+     * move on to other connections.
+     */
+    static const size_t MAXIMUM_ROUNDS_PER_READY = 16;
+
+    /**
+     * This is the maximum number of unused receive buffers to keep
+     * for reuse, across all connections.
+     */
+    static const size_t MAXIMUM_RECEIVE_BUFFERS_POOLED = 64;
+
+    /**
+     * This function returns the pool of buffers used by all connections
+     * to receive data which is handed over to their owners.
+     *
+     * @return
+     *     The pool of buffers used to receive data which is handed over
+     *     to connection owners is returned.
+     */
+    SystemAbstractions::BufferPool& GetReceiveBufferPool() {
+        static SystemAbstractions::BufferPool receiveBufferPool(
+            MAXIMUM_READ_SIZE,
+            MAXIMUM_RECEIVE_BUFFERS_POOLED
+        );
+        return receiveBufferPool;
+    }
+
+    /**
+     * This is used to synchronize access to the shared event loop.
+     */
+    std::mutex sharedEventLoopMutex;
+
+    /**
+     * If network connections are to be processed by a shared event loop,
+     * rather than each by its own worker thread, this is the event loop.
+     */
+    std::shared_ptr< SystemAbstractions::NetworkEventLoop > sharedEventLoop;
 
 }
 
@@ -62,7 +112,8 @@ namespace SystemAbstractions {
         socketAddress.sin_family = AF_INET;
         platform->sock = socket(socketAddress.sin_family, SOCK_STREAM, 0);
         if (platform->sock < 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error creating socket: %s",
                 strerror(errno)
@@ -74,7 +125,8 @@ namespace SystemAbstractions {
         linger.l_linger = 0;
         (void)setsockopt(platform->sock, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
         if (bind(platform->sock, (struct sockaddr*)&socketAddress, (socklen_t)sizeof(socketAddress)) != 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error in bind: %s",
                 strerror(errno)
@@ -87,7 +139,8 @@ namespace SystemAbstractions {
         socketAddress.sin_addr.s_addr = htonl(peerAddress);
         socketAddress.sin_port = htons(peerPort);
         if (connect(platform->sock, (const sockaddr*)&socketAddress, (socklen_t)sizeof(socketAddress)) != 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error in connect: %s",
                 strerror(errno)
@@ -108,7 +161,8 @@ namespace SystemAbstractions {
 
     bool NetworkConnection::Impl::Process() {
         if (platform->sock < 0) {
-            diagnosticsSender.SendDiagnosticInformationString(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "not connected"
             );
@@ -117,23 +171,54 @@ namespace SystemAbstractions {
 #ifdef SO_NOSIGPIPE
         int opt = 1;
         if (setsockopt(platform->sock, SOL_SOCKET, SO_NOSIGPIPE, &opt, sizeof(opt)) < 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::WARNING,
                 "error in setsockopt(SO_NOSIGPIPE): %s",
                 strerror(errno)
             );
         }
 #endif /* SO_NOSIGPIPE */
-        if (platform->processor.joinable()) {
-            diagnosticsSender.SendDiagnosticInformationString(
+        if (
+            platform->processor.joinable()
+            || (platform->eventLoopRegistration != nullptr)
+        ) {
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::WARNING,
                 "already processing"
             );
             return true;
         }
         platform->processorStop = false;
+        std::shared_ptr< NetworkEventLoop > eventLoop;
+        {
+            std::lock_guard< decltype(sharedEventLoopMutex) > lock(sharedEventLoopMutex);
+            eventLoop = sharedEventLoop;
+        }
+        if (eventLoop != nullptr) {
+            std::lock_guard< decltype(platform->processingMutex) > lock(platform->processingMutex);
+            const auto self = shared_from_this();
+            platform->eventLoopRegistration = eventLoop->Add(
+                platform->sock,
+                [self]{ self->ProcessReady(); }
+            );
+            if (platform->eventLoopRegistration == nullptr) {
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
+                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                    "error registering with event loop: %s",
+                    eventLoop->GetLastError().c_str()
+                );
+                return false;
+            }
+            platform->eventLoop = eventLoop;
+            platform->SignalStateChange();
+            return true;
+        }
         if (!platform->processorStateChangeSignal.Initialize()) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error creating processor state change event: %s",
                 platform->processorStateChangeSignal.GetLastError().c_str()
@@ -150,7 +235,6 @@ namespace SystemAbstractions {
         const int processorStateChangeSelectHandle = platform->processorStateChangeSignal.GetSelectHandle();
         const int nfds = std::max(processorStateChangeSelectHandle, platform->sock) + 1;
         fd_set readfds, writefds;
-        std::vector< uint8_t > buffer;
         std::unique_lock< std::recursive_mutex > processingLock(platform->processingMutex);
         bool wait = true;
         while (
@@ -172,100 +256,175 @@ namespace SystemAbstractions {
                     platform->processorStateChangeSignal.Clear();
                 }
             }
+            if (!ProcessIo(processingLock, wait)) {
+                break;
+            }
+        }
+    }
+
+    bool NetworkConnection::Impl::ProcessIo(
+        std::unique_lock< std::recursive_mutex >& processingLock,
+        bool& wait
+    ) {
+        wait = true;
+        if (platform->peerClosed) {
             wait = true;
-            if (platform->peerClosed) {
-                wait = true;
-            } else {
-                buffer.resize(MAXIMUM_READ_SIZE);
-                const auto amountReceived = recv(platform->sock, (char*)&buffer[0], (int)buffer.size(), MSG_NOSIGNAL);
-                if (amountReceived < 0) {
-                    if (errno == EWOULDBLOCK) {
-                        wait = true;
-                    } else {
-                        diagnosticsSender.SendDiagnosticInformationString(
-                            1,
-                            "connection closed abruptly by peer"
-                        );
-                        if (Close(CloseProcedure::ImmediateDoNotStopProcessor)) {
-                            processingLock.unlock();
-                            brokenDelegate(false);
-                            processingLock.lock();
-                        }
-                        break;
-                    }
-                } else if (amountReceived > 0) {
-                    buffer.resize((size_t)amountReceived);
-                    wait = false;
-                    processingLock.unlock();
-                    messageReceivedDelegate(buffer);
-                    processingLock.lock();
+        } else {
+            if (
+                (messageBufferReceivedDelegate != nullptr)
+                && (platform->receiveBuffer == nullptr)
+            ) {
+                platform->receiveBuffer = GetReceiveBufferPool().Acquire();
+            }
+            auto& buffer = (
+                (messageBufferReceivedDelegate == nullptr)
+                ? platform->buffer
+                : *platform->receiveBuffer
+            );
+            buffer.resize(MAXIMUM_READ_SIZE);
+            const auto amountReceived = recv(platform->sock, (char*)&buffer[0], (int)buffer.size(), MSG_NOSIGNAL);
+            if (amountReceived < 0) {
+                if (errno == EWOULDBLOCK) {
+                    // Return any receive buffer to the pool while waiting,
+                    // so that idle connections don't tie up buffers.
+                    platform->receiveBuffer = nullptr;
+                    wait = true;
                 } else {
-                    diagnosticsSender.SendDiagnosticInformationString(
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                        diagnosticsSender,
                         1,
-                        "connection closed gracefully by peer"
+                        "connection closed abruptly by peer"
                     );
-                    platform->peerClosed = true;
-                    processingLock.unlock();
-                    brokenDelegate(true);
-                    processingLock.lock();
-                }
-            }
-            if (platform->sock < 0) {
-                break;
-            }
-            const auto outputQueueLength = platform->outputQueue.GetBytesQueued();
-            if (outputQueueLength > 0) {
-                const auto writeSize = (int)std::min(outputQueueLength, MAXIMUM_WRITE_SIZE);
-                buffer = platform->outputQueue.Peek(writeSize);
-                const auto amountSent = send(platform->sock, (const char*)&buffer[0], writeSize, MSG_NOSIGNAL);
-                if (amountSent < 0) {
-                    if (errno != EWOULDBLOCK) {
-                        diagnosticsSender.SendDiagnosticInformationString(
-                            1,
-                            "connection closed abruptly by peer"
-                        );
-                        if (Close(CloseProcedure::ImmediateDoNotStopProcessor)) {
-                            processingLock.unlock();
-                            brokenDelegate(false);
-                            processingLock.lock();
-                        }
-                        break;
-                    }
-                } else if (amountSent > 0) {
-                    (void)platform->outputQueue.Drop(amountSent);
-                    if (
-                        (amountSent == writeSize)
-                        && (platform->outputQueue.GetBytesQueued() > 0)
-                    ) {
-                        wait = false;
-                    }
-                } else {
                     if (Close(CloseProcedure::ImmediateDoNotStopProcessor)) {
                         processingLock.unlock();
                         brokenDelegate(false);
                         processingLock.lock();
                     }
-                    break;
+                    return false;
                 }
-            }
-            if (
-                (platform->outputQueue.GetBytesQueued() == 0)
-                && platform->closing
-            ) {
-                if (!platform->shutdownSent) {
-                    shutdown(platform->sock, SHUT_WR);
-                    platform->shutdownSent = true;
+            } else if (amountReceived > 0) {
+                buffer.resize((size_t)amountReceived);
+                wait = false;
+                processingLock.unlock();
+                if (messageBufferReceivedDelegate == nullptr) {
+                    messageReceivedDelegate(buffer);
+                } else {
+                    messageBufferReceivedDelegate(std::move(platform->receiveBuffer));
                 }
-                if (platform->peerClosed) {
-                    CloseImmediately();
-                    if (brokenDelegate != nullptr) {
+                processingLock.lock();
+            } else {
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                    diagnosticsSender,
+                    1,
+                    "connection closed gracefully by peer"
+                );
+                platform->peerClosed = true;
+                processingLock.unlock();
+                brokenDelegate(true);
+                processingLock.lock();
+            }
+        }
+        if (platform->sock < 0) {
+            return false;
+        }
+        const auto outputQueueLength = platform->outputQueue.GetBytesQueued();
+        if (outputQueueLength > 0) {
+            const auto writeSize = platform->outputQueue.PeekSegments(
+                platform->outputSegments,
+                outputQueueLength,
+                MAXIMUM_WRITE_SEGMENTS
+            );
+            auto& outputVectors = platform->outputVectors;
+            outputVectors.resize(platform->outputSegments.size());
+            for (size_t i = 0; i < outputVectors.size(); ++i) {
+                outputVectors[i].iov_base = (void*)platform->outputSegments[i].data;
+                outputVectors[i].iov_len = platform->outputSegments[i].size;
+            }
+            struct msghdr message;
+            (void)memset(&message, 0, sizeof(message));
+            message.msg_iov = outputVectors.data();
+            message.msg_iovlen = outputVectors.size();
+            const auto amountSent = sendmsg(platform->sock, &message, MSG_NOSIGNAL);
+            if (amountSent < 0) {
+                if (errno != EWOULDBLOCK) {
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                        diagnosticsSender,
+                        1,
+                        "connection closed abruptly by peer"
+                    );
+                    if (Close(CloseProcedure::ImmediateDoNotStopProcessor)) {
                         processingLock.unlock();
                         brokenDelegate(false);
                         processingLock.lock();
                     }
+                    return false;
+                }
+            } else if (amountSent > 0) {
+                (void)platform->outputQueue.Drop(amountSent);
+                if (
+                    ((size_t)amountSent == writeSize)
+                    && (platform->outputQueue.GetBytesQueued() > 0)
+                ) {
+                    wait = false;
+                }
+            } else {
+                if (Close(CloseProcedure::ImmediateDoNotStopProcessor)) {
+                    processingLock.unlock();
+                    brokenDelegate(false);
+                    processingLock.lock();
+                }
+                return false;
+            }
+        }
+        if (
+            (platform->outputQueue.GetBytesQueued() == 0)
+            && platform->closing
+        ) {
+            if (!platform->shutdownSent) {
+                shutdown(platform->sock, SHUT_WR);
+                platform->shutdownSent = true;
+            }
+            if (platform->peerClosed) {
+                // Everything queued has been handed to the operating
+                // system, so turn off the abortive close set up for
+                // the socket, to let any data still in flight
+                // reach the peer.
+                struct linger linger;
+                linger.l_onoff = 0;
+                linger.l_linger = 0;
+                (void)setsockopt(platform->sock, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+                CloseImmediately();
+                if (brokenDelegate != nullptr) {
+                    processingLock.unlock();
+                    brokenDelegate(false);
+                    processingLock.lock();
                 }
             }
         }
+        return true;
+    }
+
+    void NetworkConnection::Impl::ProcessReady() {
+        std::unique_lock< std::recursive_mutex > processingLock(platform->processingMutex);
+        for (size_t round = 0; round < MAXIMUM_ROUNDS_PER_READY; ++round) {
+            if (platform->sock < 0) {
+                return;
+            }
+            bool wait = true;
+            if (!ProcessIo(processingLock, wait)) {
+                return;
+            }
+            if (wait) {
+                break;
+            }
+        }
+        if (platform->eventLoopRegistration != nullptr) {
+            platform->eventLoop->SetInterest(
+                platform->eventLoopRegistration,
+                !platform->peerClosed,
+                (platform->outputQueue.GetBytesQueued() > 0)
+            );
+        }
     }
 
     bool NetworkConnection::Impl::IsConnected() const {
@@ -275,7 +434,19 @@ namespace SystemAbstractions {
     void NetworkConnection::Impl::SendMessage(const std::vector< uint8_t >& message) {
         std::lock_guard< decltype(platform->processingMutex) > lock(platform->processingMutex);
         platform->outputQueue.Enqueue(message);
-        platform->processorStateChangeSignal.Set();
+        platform->SignalStateChange();
+    }
+
+    void NetworkConnection::Impl::SendMessage(std::vector< uint8_t >&& message) {
+        std::lock_guard< decltype(platform->processingMutex) > lock(platform->processingMutex);
+        platform->outputQueue.Enqueue(std::move(message));
+        platform->SignalStateChange();
+    }
+
+    void NetworkConnection::Impl::SendMessage(std::shared_ptr< const std::vector< uint8_t > > message) {
+        std::lock_guard< decltype(platform->processingMutex) > lock(platform->processingMutex);
+        platform->outputQueue.Enqueue(std::move(message));
+        platform->SignalStateChange();
     }
 
     bool NetworkConnection::Impl::Close(CloseProcedure procedure) {
@@ -290,11 +461,12 @@ namespace SystemAbstractions {
         if (platform->sock >= 0) {
             if (procedure == CloseProcedure::Graceful) {
                 platform->closing = true;
-                diagnosticsSender.SendDiagnosticInformationString(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                    diagnosticsSender,
                     1,
                     "closing connection"
                 );
-                platform->processorStateChangeSignal.Set();
+                platform->SignalStateChange();
             } else {
                 CloseImmediately();
                 return (brokenDelegate != nullptr);
@@ -305,7 +477,8 @@ namespace SystemAbstractions {
 
     void NetworkConnection::Impl::CloseImmediately() {
         platform->CloseImmediately();
-        diagnosticsSender.SendDiagnosticInformationString(
+        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+            diagnosticsSender,
             1,
             "closed connection"
         );
@@ -333,6 +506,29 @@ namespace SystemAbstractions {
         }
     }
 
+    bool NetworkConnection::Impl::SetProcessingModel(
+        ProcessingModel processingModel,
+        size_t numThreads
+    ) {
+        std::shared_ptr< NetworkEventLoop > eventLoop;
+        if (processingModel == ProcessingModel::SharedEventLoop) {
+            if (numThreads == 0) {
+                numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+            eventLoop = std::make_shared< NetworkEventLoop >();
+            if (!eventLoop->Initialize(numThreads)) {
+                eventLoop = nullptr;
+            }
+        }
+        const bool selected = (
+            (processingModel == ProcessingModel::ThreadPerConnection)
+            || (eventLoop != nullptr)
+        );
+        std::lock_guard< decltype(sharedEventLoopMutex) > lock(sharedEventLoopMutex);
+        sharedEventLoop.swap(eventLoop);
+        return selected;
+    }
+
     std::shared_ptr< NetworkConnection > NetworkConnection::Platform::MakeConnectionFromExistingSocket(
         int sock,
         uint32_t boundAddress,
@@ -349,7 +545,19 @@ namespace SystemAbstractions {
         return connection;
     }
 
+    void NetworkConnection::Platform::SignalStateChange() {
+        if (eventLoopRegistration == nullptr) {
+            processorStateChangeSignal.Set();
+        } else {
+            eventLoop->SetInterest(eventLoopRegistration, !peerClosed, true);
+        }
+    }
+
     void NetworkConnection::Platform::CloseImmediately() {
+        if (eventLoopRegistration != nullptr) {
+            eventLoop->Remove(eventLoopRegistration);
+            eventLoopRegistration = nullptr;
+        }
         (void)close(sock);
         sock = -1;
     }
@@ -11,6 +11,7 @@
  */
 
 #include "../DataQueue.hpp"
+#include "NetworkEventLoop.hpp"
 #include "PipeSignal.hpp"
 
 #include <deque>
@@ -18,7 +19,9 @@
 #include <mutex>
 #include <stdint.h>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <sys/uio.h>
 #include <thread>
+#include <vector>
 
 namespace SystemAbstractions {
 
@@ -72,6 +75,19 @@ namespace SystemAbstractions {
          */
         bool processorStop = false;
 
+        /**
+         * If the connection is processed by a shared event loop rather
+         * than its own worker thread, this is the event loop.
+         */
+        std::shared_ptr< NetworkEventLoop > eventLoop;
+
+        /**
+         * If the connection is processed by a shared event loop rather
+         * than its own worker thread, this represents the registration
+         * of the socket with the event loop.
+         */
+        std::shared_ptr< NetworkEventLoop::Registration > eventLoopRegistration;
+
         /**
          * This is used to synchronize access to the object.
          */
@@ -83,6 +99,33 @@ namespace SystemAbstractions {
          */
         DataQueue outputQueue;
 
+        /**
+         * This is used to hold data being received from the network.
+         * It's kept here so its capacity carries over from one round
+         * of processing to the next.
+         */
+        std::vector< uint8_t > buffer;
+
+        /**
+         * If received data is to be handed over to the owner of the
+         * connection, this is the buffer, obtained from a pool shared
+         * by all connections, into which the next data is received.
+         */
+        std::shared_ptr< std::vector< uint8_t > > receiveBuffer;
+
+        /**
+         * This is used to refer to the pieces of data in the output
+         * queue being sent to the network, without copying them.
+         */
+        std::vector< DataQueue::Segment > outputSegments;
+
+        /**
+         * This is used to hand the pieces of data in the output
+         * queue being sent to the network to the operating system
+         * in a single call.
+         */
+        std::vector< struct iovec > outputVectors;
+
         // Methods
 
         /**
@@ -113,6 +156,14 @@ namespace SystemAbstractions {
             uint16_t peerPort
         );
 
+        /**
+         * This method arranges for the connection to be processed
+         * again soon, in order to react to a change in its state,
+         * such as data being queued for sending, or a close being
+         * requested.
+         */
+        void SignalStateChange();
+
         /**
          * This helper method is called from various places to standardize
          * what the class does when it wants to immediately close
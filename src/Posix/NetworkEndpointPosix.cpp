@@ -27,6 +27,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <SystemAbstractions/NetworkConnection.hpp>
 #include <unistd.h>
 
@@ -38,10 +39,454 @@ namespace {
 
     static const size_t MAXIMUM_READ_SIZE = 65536;
 
+    /**
+     * This is the maximum number of packets which may be waiting to be
+     * sent in the lock-free outbox of an endpoint.  Any more wait
+     * in a slower overflow queue.
+     */
+    static const size_t MAXIMUM_PACKETS_QUEUED = 1024;
+
+    /**
+     * This is the maximum number of packets to hand to the operating
+     * system to send at once.
+     */
+    static const size_t MAXIMUM_PACKETS_PER_SEND = 64;
+
+    /**
+     * This holds the memory set aside for receiving datagrams
+     * in batches.
+     */
+    struct ReceiveBatch {
+        // Properties
+
+        /**
+         * This holds the contents of all datagrams in the batch,
+         * each one in its own slot of slotSize bytes.
+         */
+        std::vector< uint8_t > buffer;
+
+        /**
+         * This is the number of bytes set aside for each datagram.
+         */
+        size_t slotSize = 0;
+
+        /**
+         * These are the addresses of the senders of the datagrams
+         * in the batch.
+         */
+        std::vector< struct sockaddr_in > addresses;
+
+#ifdef MSG_WAITFORONE
+        /**
+         * These describe the slots of the buffer to the operating system.
+         */
+        std::vector< struct iovec > vectors;
+
+        /**
+         * These describe the datagrams to receive to the operating system.
+         */
+        std::vector< struct mmsghdr > headers;
+#endif /* MSG_WAITFORONE */
+
+        /**
+         * These are the datagrams received in the batch, as delivered
+         * to the owner of the endpoint.
+         */
+        std::vector< SystemAbstractions::NetworkEndpoint::ReceivedPacket > packets;
+
+        // Methods
+
+        /**
+         * This method sets aside the memory needed to receive
+         * batches of up to the given number of datagrams.
+         *
+         * @param[in] maxPackets
+         *     This is the maximum number of datagrams to receive
+         *     in one batch.
+         *
+         * @param[in] maxPacketSize
+         *     This is the number of bytes to set aside for each
+         *     datagram.  Larger datagrams are cut short.
+         */
+        void Allocate(size_t maxPackets, size_t maxPacketSize) {
+            slotSize = maxPacketSize;
+            buffer.resize(maxPackets * slotSize);
+            addresses.resize(maxPackets);
+#ifdef MSG_WAITFORONE
+            vectors.resize(maxPackets);
+            headers.resize(maxPackets);
+            (void)memset(headers.data(), 0, headers.size() * sizeof(struct mmsghdr));
+            for (size_t i = 0; i < maxPackets; ++i) {
+                vectors[i].iov_base = &buffer[i * slotSize];
+                vectors[i].iov_len = slotSize;
+                headers[i].msg_hdr.msg_name = &addresses[i];
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+#endif /* MSG_WAITFORONE */
+            packets.reserve(maxPackets);
+        }
+
+        /**
+         * This method receives as many datagrams as are available
+         * from the given socket, up to the capacity of the batch.
+         *
+         * @param[in] sock
+         *     This is the socket from which to receive datagrams.
+         *
+         * @return
+         *     The number of datagrams received is returned.
+         *
+         * @retval -1
+         *     This is returned if no datagrams were received, in which
+         *     case errno indicates why.
+         */
+        int Receive(int sock) {
+            packets.clear();
+            const size_t maxPackets = addresses.size();
+#ifdef MSG_WAITFORONE
+            for (auto& header: headers) {
+                header.msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            }
+            const int numReceived = recvmmsg(
+                sock,
+                headers.data(),
+                (unsigned int)maxPackets,
+                MSG_NOSIGNAL,
+                NULL
+            );
+            if (numReceived < 0) {
+                return -1;
+            }
+            for (int i = 0; i < numReceived; ++i) {
+                AddPacket((size_t)i, headers[i].msg_len);
+            }
+#else /* no recvmmsg */
+            for (size_t i = 0; i < maxPackets; ++i) {
+                socklen_t addressSize = (socklen_t)sizeof(struct sockaddr_in);
+                const ssize_t amountReceived = recvfrom(
+                    sock,
+                    &buffer[i * slotSize],
+                    slotSize,
+                    MSG_NOSIGNAL,
+                    (struct sockaddr*)&addresses[i],
+                    &addressSize
+                );
+                if (amountReceived < 0) {
+                    if (i == 0) {
+                        return -1;
+                    }
+                    break;
+                }
+                AddPacket(i, (size_t)amountReceived);
+            }
+#endif /* recvmmsg or not */
+            return (int)packets.size();
+        }
+
+        /**
+         * This method adds the datagram received into the given slot
+         * to the list of datagrams to deliver.
+         *
+         * @param[in] slot
+         *     This is the index of the slot holding the datagram.
+         *
+         * @param[in] size
+         *     This is the number of bytes in the datagram.
+         */
+        void AddPacket(size_t slot, size_t size) {
+            SystemAbstractions::NetworkEndpoint::ReceivedPacket packet;
+            packet.address = ntohl(addresses[slot].sin_addr.s_addr);
+            packet.port = ntohs(addresses[slot].sin_port);
+            packet.body = &buffer[slot * slotSize];
+            packet.bodySize = size;
+            packets.push_back(packet);
+        }
+    };
+
+    /**
+     * This holds the memory set aside for sending datagrams
+     * in batches.
+     */
+    struct SendBatch {
+        // Properties
+
+        /**
+         * These are the addresses of the recipients of the datagrams
+         * in the batch.
+         */
+        std::vector< struct sockaddr_in > addresses;
+
+        /**
+         * These describe the contents of the datagrams in the batch
+         * to the operating system.
+         */
+        std::vector< struct iovec > vectors;
+
+#ifdef MSG_WAITFORONE
+        /**
+         * These describe the datagrams to send to the operating system.
+         */
+        std::vector< struct mmsghdr > headers;
+#endif /* MSG_WAITFORONE */
+
+        /**
+         * These are the numbers of bytes actually sent for each
+         * datagram in the batch.
+         */
+        std::vector< size_t > amountsSent;
+
+        // Methods
+
+        /**
+         * This method sets aside the memory needed to send
+         * batches of up to the given number of datagrams.
+         *
+         * @param[in] maxPackets
+         *     This is the maximum number of datagrams to send
+         *     in one batch.
+         */
+        void Allocate(size_t maxPackets) {
+            addresses.resize(maxPackets);
+            vectors.resize(maxPackets);
+            amountsSent.resize(maxPackets);
+#ifdef MSG_WAITFORONE
+            headers.resize(maxPackets);
+            (void)memset(headers.data(), 0, headers.size() * sizeof(struct mmsghdr));
+            for (size_t i = 0; i < maxPackets; ++i) {
+                headers[i].msg_hdr.msg_name = &addresses[i];
+                headers[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+#endif /* MSG_WAITFORONE */
+        }
+
+        /**
+         * This method sets up one datagram in the batch.
+         *
+         * @param[in] index
+         *     This is the position of the datagram in the batch.
+         *
+         * @param[in] address
+         *     This is the IPv4 address of the recipient of the datagram.
+         *
+         * @param[in] port
+         *     This is the port of the recipient of the datagram.
+         *
+         * @param[in] body
+         *     This is the contents of the datagram.  It must stay in
+         *     place until the datagram is sent.
+         */
+        void SetPacket(
+            size_t index,
+            uint32_t address,
+            uint16_t port,
+            const std::vector< uint8_t >& body
+        ) {
+            (void)memset(&addresses[index], 0, sizeof(struct sockaddr_in));
+            addresses[index].sin_family = AF_INET;
+            addresses[index].sin_addr.s_addr = htonl(address);
+            addresses[index].sin_port = htons(port);
+            vectors[index].iov_base = (void*)body.data();
+            vectors[index].iov_len = body.size();
+        }
+
+        /**
+         * This method sends as many of the given datagrams of the batch
+         * as the operating system will take without blocking.
+         *
+         * @param[in] sock
+         *     This is the socket through which to send datagrams.
+         *
+         * @param[in] first
+         *     This is the position in the batch of the first datagram
+         *     to send.
+         *
+         * @param[in] count
+         *     This is the number of datagrams to send.
+         *
+         * @return
+         *     The number of datagrams sent is returned.
+         *
+         * @retval -1
+         *     This is returned if no datagrams were sent, in which
+         *     case errno indicates why.
+         */
+        int Send(int sock, size_t first, size_t count) {
+#ifdef MSG_WAITFORONE
+            const int numSent = sendmmsg(
+                sock,
+                &headers[first],
+                (unsigned int)count,
+                MSG_NOSIGNAL
+            );
+            for (int i = 0; i < numSent; ++i) {
+                amountsSent[first + i] = headers[first + i].msg_len;
+            }
+            return numSent;
+#else /* no sendmmsg */
+            for (size_t i = 0; i < count; ++i) {
+                const ssize_t amountSent = sendto(
+                    sock,
+                    vectors[first + i].iov_base,
+                    vectors[first + i].iov_len,
+                    MSG_NOSIGNAL,
+                    (const sockaddr*)&addresses[first + i],
+                    sizeof(struct sockaddr_in)
+                );
+                if (amountSent < 0) {
+                    if (i == 0) {
+                        return -1;
+                    }
+                    return (int)i;
+                }
+                amountsSent[first + i] = (size_t)amountSent;
+            }
+            return (int)count;
+#endif /* sendmmsg or not */
+        }
+    };
+
+    /**
+     * This function accepts connections from the given listening socket
+     * until there are none left waiting, handing each one to the
+     * given delegate.
+     *
+     * @param[in] sock
+     *     This is the socket on which to accept connections.  It must be
+     *     non-blocking, and have the socket options desired for the
+     *     connections, since they are inherited by accepted sockets.
+     *
+     * @param[in] localAddress
+     *     This is the IPv4 address bound by the listening socket,
+     *     or zero if it's bound to all network interfaces.
+     *
+     * @param[in] port
+     *     This is the port number bound by the listening socket.
+     *
+     * @param[in] newConnectionDelegate
+     *     This is the callback function to call for each new connection.
+     *
+     * @param[in] diagnosticsSender
+     *     This is used to publish diagnostic messages.
+     */
+    void AcceptConnections(
+        int sock,
+        uint32_t localAddress,
+        uint16_t port,
+        const SystemAbstractions::NetworkEndpoint::NewConnectionDelegate& newConnectionDelegate,
+        SystemAbstractions::DiagnosticsSender& diagnosticsSender
+    ) {
+        for (;;) {
+            struct sockaddr_in peerAddress;
+            socklen_t peerAddressSize = (socklen_t)sizeof(peerAddress);
+#ifdef SOCK_NONBLOCK
+            const int client = accept4(
+                sock,
+                (struct sockaddr*)&peerAddress,
+                &peerAddressSize,
+                SOCK_NONBLOCK | SOCK_CLOEXEC
+            );
+#else /* no accept4 */
+            const int client = accept(sock, (struct sockaddr*)&peerAddress, &peerAddressSize);
+            if (client >= 0) {
+                int flags = fcntl(client, F_GETFL, 0);
+                flags |= O_NONBLOCK;
+                (void)fcntl(client, F_SETFL, flags);
+            }
+#endif /* accept4 or not */
+            if (client < 0) {
+                if (
+                    (errno == EINTR)
+                    || (errno == ECONNABORTED)
+                ) {
+                    continue;
+                }
+                if (
+                    (errno != EWOULDBLOCK)
+                    && (errno != EAGAIN)
+                ) {
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
+                        SystemAbstractions::DiagnosticsSender::Levels::WARNING,
+                        "error in accept: %s",
+                        strerror(errno)
+                    );
+                }
+                return;
+            }
+
+            // The local address of the connection is only unknown if the
+            // listening socket is bound to all network interfaces.
+            uint32_t boundIpv4Address = localAddress;
+            uint16_t boundPort = port;
+            if (localAddress == 0) {
+                struct sockaddr_in boundAddress;
+                socklen_t boundAddressSize = sizeof(boundAddress);
+                if (getsockname(client, (struct sockaddr*)&boundAddress, &boundAddressSize) == 0) {
+                    boundIpv4Address = ntohl(boundAddress.sin_addr.s_addr);
+                    boundPort = ntohs(boundAddress.sin_port);
+                }
+            }
+            auto connection = SystemAbstractions::NetworkConnection::Platform::MakeConnectionFromExistingSocket(
+                client,
+                boundIpv4Address,
+                boundPort,
+                ntohl(peerAddress.sin_addr.s_addr),
+                ntohs(peerAddress.sin_port)
+            );
+            newConnectionDelegate(connection);
+        }
+    }
+
+    /**
+     * This function prepares the given socket to listen for connections.
+     * It makes the socket non-blocking, and sets the socket options
+     * which the connections accepted on it should inherit.
+     *
+     * @param[in] sock
+     *     This is the socket to prepare.
+     *
+     * @param[in] diagnosticsSender
+     *     This is used to publish diagnostic messages.
+     *
+     * @return
+     *     An indication of whether or not the method was
+     *     successful is returned.
+     */
+    bool Listen(
+        int sock,
+        SystemAbstractions::DiagnosticsSender& diagnosticsSender
+    ) {
+        struct linger linger;
+        linger.l_onoff = 1;
+        linger.l_linger = 0;
+        (void)setsockopt(sock, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+        int flags = fcntl(sock, F_GETFL, 0);
+        flags |= O_NONBLOCK;
+        (void)fcntl(sock, F_SETFL, flags);
+        if (listen(sock, SOMAXCONN) != 0) {
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
+                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                "error in listen: %s",
+                strerror(errno)
+            );
+            return false;
+        }
+        return true;
+    }
+
 }
 
 namespace SystemAbstractions {
 
+    NetworkEndpoint::Platform::Platform()
+        : outbox(MAXIMUM_PACKETS_QUEUED)
+    {
+    }
+
     NetworkEndpoint::Impl::Impl()
         : platform(new Platform())
         , diagnosticsSender("NetworkEndpoint")
@@ -64,7 +509,8 @@ namespace SystemAbstractions {
             0
         );
         if (platform->sock < 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error creating socket: %s",
                 strerror(errno)
@@ -80,7 +526,8 @@ namespace SystemAbstractions {
             struct in_addr multicastInterface;
             multicastInterface.s_addr = htonl(localAddress);
             if (setsockopt(platform->sock, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&multicastInterface, sizeof(multicastInterface)) < 0) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error setting socket option IP_MULTICAST_IF: %s",
                     strerror(errno)
@@ -95,7 +542,8 @@ namespace SystemAbstractions {
             if (mode == NetworkEndpoint::Mode::MulticastReceive) {
                 int option = 1;
                 if (setsockopt(platform->sock, SOL_SOCKET, SO_REUSEADDR, (const char*)&option, sizeof(option)) < 0) {
-                    diagnosticsSender.SendDiagnosticInformationFormatted(
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
                         SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                         "error setting socket option SO_REUSEADDR: %s",
                         strerror(errno)
@@ -107,9 +555,28 @@ namespace SystemAbstractions {
             } else {
                 peerAddress.sin_addr.s_addr = htonl(localAddress);
             }
+#ifdef SO_REUSEPORT
+            if (
+                (mode == NetworkEndpoint::Mode::Connection)
+                && (numListeners > 1)
+            ) {
+                int option = 1;
+                if (setsockopt(platform->sock, SOL_SOCKET, SO_REUSEPORT, (const char*)&option, sizeof(option)) < 0) {
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
+                        SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                        "error setting socket option SO_REUSEPORT: %s",
+                        strerror(errno)
+                    );
+                    Close(false);
+                    return false;
+                }
+            }
+#endif /* SO_REUSEPORT */
             peerAddress.sin_port = htons(port);
             if (bind(platform->sock, (struct sockaddr*)&peerAddress, sizeof(peerAddress)) != 0) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error in bind: %s",
                     strerror(errno)
@@ -123,7 +590,8 @@ namespace SystemAbstractions {
                     multicastGroup.imr_multiaddr.s_addr = htonl(groupAddress);
                     multicastGroup.imr_interface.s_addr = htonl(localAddress);
                     if (setsockopt(platform->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&multicastGroup, sizeof(multicastGroup)) < 0) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                             "error setting socket option IP_ADD_MEMBERSHIP: %s",
                             strerror(errno)
@@ -137,7 +605,8 @@ namespace SystemAbstractions {
                 if (getsockname(platform->sock, (struct sockaddr*)&peerAddress, &peerAddressLength) == 0) {
                     port = ntohs(peerAddress.sin_port);
                 } else {
-                    diagnosticsSender.SendDiagnosticInformationFormatted(
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
                         SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                         "error in getsockname: %s",
                         strerror(errno)
@@ -150,7 +619,8 @@ namespace SystemAbstractions {
 
         // Prepare events used in processing.
         if (!platform->processorStateChangeSignal.Initialize()) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error creating processor state change event (%s)",
                 platform->processorStateChangeSignal.GetLastError().c_str()
@@ -159,29 +629,104 @@ namespace SystemAbstractions {
         }
         platform->processorStateChangeSignal.Clear();
 
-        // If accepting connections, tell socket to start accepting.
+        // If accepting connections, tell socket to start accepting,
+        // along with any extra sockets sharing the same port.
         // Otherwise, make socket non-blocking.
         if (mode == NetworkEndpoint::Mode::Connection) {
-            if (listen(platform->sock, SOMAXCONN) != 0) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
-                    SystemAbstractions::DiagnosticsSender::Levels::ERROR,
-                    "error in listen: %s",
-                    strerror(errno)
-                );
+            if (!Listen(platform->sock, diagnosticsSender)) {
                 return false;
             }
+#ifdef SO_REUSEPORT
+            if (numListeners > 1) {
+                if (!platform->extraListenersStopSignal.Initialize()) {
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
+                        SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                        "error creating listener stop event (%s)",
+                        platform->extraListenersStopSignal.GetLastError().c_str()
+                    );
+                    return false;
+                }
+                platform->extraListenersStopSignal.Clear();
+            }
+            while (platform->extraListeners.size() + 1 < numListeners) {
+                const int listener = socket(AF_INET, SOCK_STREAM, 0);
+                if (listener < 0) {
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
+                        SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                        "error creating socket: %s",
+                        strerror(errno)
+                    );
+                    Close(true);
+                    return false;
+                }
+                platform->extraListeners.push_back(listener);
+                int option = 1;
+                struct sockaddr_in listenerAddress;
+                (void)memset(&listenerAddress, 0, sizeof(listenerAddress));
+                listenerAddress.sin_family = AF_INET;
+                listenerAddress.sin_addr.s_addr = htonl(localAddress);
+                listenerAddress.sin_port = htons(port);
+                if (
+                    (setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, (const char*)&option, sizeof(option)) < 0)
+                    || (bind(listener, (struct sockaddr*)&listenerAddress, sizeof(listenerAddress)) != 0)
+                ) {
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
+                        SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                        "error binding extra listener: %s",
+                        strerror(errno)
+                    );
+                    Close(true);
+                    return false;
+                }
+                if (!Listen(listener, diagnosticsSender)) {
+                    Close(true);
+                    return false;
+                }
+            }
+#endif /* SO_REUSEPORT */
         } else {
             int flags = fcntl(platform->sock, F_GETFL, 0);
             flags |= O_NONBLOCK;
             (void)fcntl(platform->sock, F_SETFL, flags);
         }
-        diagnosticsSender.SendDiagnosticInformationFormatted(
+        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+            diagnosticsSender,
             0,
             "endpoint opened for port %" PRIu16,
             port
         );
         platform->processorStop = false;
         platform->processor = std::thread(&NetworkEndpoint::Impl::Processor, this);
+        for (const auto listener: platform->extraListeners) {
+            platform->extraListenerThreads.emplace_back(
+                [this, listener]{
+                    const int stopSelectHandle = platform->extraListenersStopSignal.GetSelectHandle();
+                    const int nfds = std::max(stopSelectHandle, listener) + 1;
+                    fd_set readfds;
+                    for (;;) {
+                        FD_ZERO(&readfds);
+                        FD_SET(listener, &readfds);
+                        FD_SET(stopSelectHandle, &readfds);
+                        (void)select(nfds, &readfds, NULL, NULL, NULL);
+                        if (FD_ISSET(stopSelectHandle, &readfds) != 0) {
+                            break;
+                        }
+                        if (FD_ISSET(listener, &readfds) != 0) {
+                            AcceptConnections(
+                                listener,
+                                localAddress,
+                                port,
+                                newConnectionDelegate,
+                                diagnosticsSender
+                            );
+                        }
+                    }
+                }
+            );
+        }
         return true;
     }
 
@@ -190,6 +735,16 @@ namespace SystemAbstractions {
         const int nfds = std::max(processorStateChangeSelectHandle, platform->sock) + 1;
         fd_set readfds, writefds;
         std::vector< uint8_t > buffer;
+        ReceiveBatch receiveBatch;
+        if (packetsReceivedDelegate != nullptr) {
+            receiveBatch.Allocate(maxPacketsPerBatch, maxPacketSize);
+        }
+        std::vector< NetworkEndpoint::Platform::Packet > sending(MAXIMUM_PACKETS_PER_SEND);
+        size_t numSending = 0;
+        size_t nextToSend = 0;
+        bool sendBlocked = false;
+        SendBatch sendBatch;
+        sendBatch.Allocate(MAXIMUM_PACKETS_PER_SEND);
         std::unique_lock< std::recursive_mutex > processingLock(platform->processingMutex);
         bool wait = true;
         while (!platform->processorStop) {
@@ -197,7 +752,7 @@ namespace SystemAbstractions {
                 FD_ZERO(&readfds);
                 FD_ZERO(&writefds);
                 FD_SET(platform->sock, &readfds);
-                if (platform->outputQueue.size() > 0) {
+                if (sendBlocked) {
                     FD_SET(platform->sock, &writefds);
                 }
                 FD_SET(processorStateChangeSelectHandle, &readfds);
@@ -214,39 +769,37 @@ namespace SystemAbstractions {
             socklen_t peerAddressSize = (socklen_t)sizeof(peerAddress);
             if (FD_ISSET(platform->sock, &readfds)) {
                 if (mode == NetworkEndpoint::Mode::Connection) {
-                    const int client = accept(platform->sock, (struct sockaddr*)&peerAddress, &peerAddressSize);
-                    if (client < 0) {
+                    AcceptConnections(
+                        platform->sock,
+                        localAddress,
+                        port,
+                        newConnectionDelegate,
+                        diagnosticsSender
+                    );
+                } else if (
+                    (
+                        (mode == NetworkEndpoint::Mode::Datagram)
+                        || (mode == NetworkEndpoint::Mode::MulticastReceive)
+                    )
+                    && (packetsReceivedDelegate != nullptr)
+                ) {
+                    const int numReceived = receiveBatch.Receive(platform->sock);
+                    if (numReceived < 0) {
                         if (errno != EWOULDBLOCK) {
-                            diagnosticsSender.SendDiagnosticInformationFormatted(
-                                SystemAbstractions::DiagnosticsSender::Levels::WARNING,
-                                "error in accept: %s",
+                            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                                diagnosticsSender,
+                                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                                "error receiving datagrams: %s",
                                 strerror(errno)
                             );
+                            Close(false);
+                            break;
                         }
-                    } else {
-                        struct linger linger;
-                        linger.l_onoff = 1;
-                        linger.l_linger = 0;
-                        (void)setsockopt(client, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
-                        int flags = fcntl(client, F_GETFL, 0);
-                        flags |= O_NONBLOCK;
-                        (void)fcntl(client, F_SETFL, flags);
-                        uint32_t boundIpv4Address = 0;
-                        uint16_t boundPort = 0;
-                        struct sockaddr_in boundAddress;
-                        socklen_t boundAddressSize = sizeof(boundAddress);
-                        if (getsockname(client, (struct sockaddr*)&boundAddress, &boundAddressSize) == 0) {
-                            boundIpv4Address = ntohl(boundAddress.sin_addr.s_addr);
-                            boundPort = ntohs(boundAddress.sin_port);
+                    } else if (numReceived > 0) {
+                        packetsReceivedDelegate(receiveBatch.packets);
+                        if ((size_t)numReceived == maxPacketsPerBatch) {
+                            wait = false;
                         }
-                        auto connection = NetworkConnection::Platform::MakeConnectionFromExistingSocket(
-                            client,
-                            boundIpv4Address,
-                            boundPort,
-                            ntohl(peerAddress.sin_addr.s_addr),
-                            ntohs(peerAddress.sin_port)
-                        );
-                        newConnectionDelegate(connection);
                     }
                 } else if (
                     (mode == NetworkEndpoint::Mode::Datagram)
@@ -262,7 +815,8 @@ namespace SystemAbstractions {
                     );
                     if (amountReceived < 0) {
                         if (errno != EWOULDBLOCK) {
-                            diagnosticsSender.SendDiagnosticInformationFormatted(
+                            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                                diagnosticsSender,
                                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                                 "error in recvfrom: %s",
                                 strerror(errno)
@@ -280,41 +834,82 @@ namespace SystemAbstractions {
                     }
                 }
             }
-            if (!platform->outputQueue.empty()) {
-                NetworkEndpoint::Platform::Packet& packet = platform->outputQueue.front();
-                (void)memset(&peerAddress, 0, sizeof(peerAddress));
-                peerAddress.sin_family = AF_INET;
-                peerAddress.sin_addr.s_addr = htonl(packet.address);
-                peerAddress.sin_port = htons(packet.port);
-                const ssize_t amountSent = sendto(
+            if (nextToSend == numSending) {
+                numSending = 0;
+                nextToSend = 0;
+                platform->outboxSignaled = false;
+                while (
+                    (numSending < MAXIMUM_PACKETS_PER_SEND)
+                    && platform->outbox.TryPop(
+                        [&sending, numSending](NetworkEndpoint::Platform::Packet& packet){
+                            std::swap(sending[numSending], packet);
+                        }
+                    )
+                ) {
+                    ++numSending;
+                }
+                if (
+                    (numSending < MAXIMUM_PACKETS_PER_SEND)
+                    && platform->overflowing
+                ) {
+                    std::lock_guard< decltype(platform->overflowMutex) > overflowLock(platform->overflowMutex);
+                    while (
+                        (numSending < MAXIMUM_PACKETS_PER_SEND)
+                        && !platform->overflow.empty()
+                    ) {
+                        sending[numSending++] = std::move(platform->overflow.front());
+                        platform->overflow.pop_front();
+                    }
+                    if (platform->overflow.empty()) {
+                        platform->overflowing = false;
+                    }
+                }
+                for (size_t i = 0; i < numSending; ++i) {
+                    sendBatch.SetPacket(
+                        i,
+                        sending[i].address,
+                        sending[i].port,
+                        sending[i].body
+                    );
+                }
+            }
+            if (nextToSend < numSending) {
+                const int numSent = sendBatch.Send(
                     platform->sock,
-                    &packet.body[0],
-                    packet.body.size(),
-                    MSG_NOSIGNAL,
-                    (const sockaddr*)&peerAddress,
-                    sizeof(peerAddress)
+                    nextToSend,
+                    numSending - nextToSend
                 );
-                if (amountSent < 0) {
-                    if (errno != EWOULDBLOCK) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                if (numSent < 0) {
+                    if (errno == EWOULDBLOCK) {
+                        sendBlocked = true;
+                    } else {
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::ERROR,
-                            "error in sendto: %s",
+                            "error sending datagrams: %s",
                             strerror(errno)
                         );
                         Close(false);
                         break;
                     }
                 } else {
-                    if ((size_t)amountSent != packet.body.size()) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
-                            SystemAbstractions::DiagnosticsSender::Levels::ERROR,
-                            "send truncated (%d < %d)",
-                            (int)amountSent,
-                            (int)packet.body.size()
-                        );
+                    sendBlocked = false;
+                    for (size_t i = nextToSend; i < nextToSend + (size_t)numSent; ++i) {
+                        if (sendBatch.amountsSent[i] != sending[i].body.size()) {
+                            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                                diagnosticsSender,
+                                SystemAbstractions::DiagnosticsSender::Levels::ERROR,
+                                "send truncated (%d < %d)",
+                                (int)sendBatch.amountsSent[i],
+                                (int)sending[i].body.size()
+                            );
+                        }
                     }
-                    platform->outputQueue.pop_front();
-                    if (!platform->outputQueue.empty()) {
+                    nextToSend += (size_t)numSent;
+                    if (
+                        (nextToSend < numSending)
+                        || (numSending == MAXIMUM_PACKETS_PER_SEND)
+                    ) {
                         wait = false;
                     }
                 }
@@ -327,13 +922,24 @@ namespace SystemAbstractions {
         uint16_t port,
         const std::vector< uint8_t >& body
     ) {
-        std::unique_lock< std::recursive_mutex > processingLock(platform->processingMutex);
-        NetworkEndpoint::Platform::Packet packet;
-        packet.address = address;
-        packet.port = port;
-        packet.body = body;
-        platform->outputQueue.emplace_back(std::move(packet));
-        platform->processorStateChangeSignal.Set();
+        const auto fill = [address, port, &body](NetworkEndpoint::Platform::Packet& packet){
+            packet.address = address;
+            packet.port = port;
+            packet.body.assign(body.begin(), body.end());
+        };
+        if (
+            platform->overflowing
+            || !platform->outbox.TryPush(fill)
+        ) {
+            std::lock_guard< decltype(platform->overflowMutex) > overflowLock(platform->overflowMutex);
+            NetworkEndpoint::Platform::Packet packet;
+            fill(packet);
+            platform->overflow.push_back(std::move(packet));
+            platform->overflowing = true;
+        }
+        if (!platform->outboxSignaled.exchange(true)) {
+            platform->processorStateChangeSignal.Set();
+        }
     }
 
     void NetworkEndpoint::Impl::Close(bool stopProcessing) {
@@ -345,8 +951,22 @@ namespace SystemAbstractions {
             platform->processorStateChangeSignal.Set();
             platform->processor.join();
         }
+        if (stopProcessing) {
+            if (!platform->extraListenerThreads.empty()) {
+                platform->extraListenersStopSignal.Set();
+                for (auto& thread: platform->extraListenerThreads) {
+                    thread.join();
+                }
+                platform->extraListenerThreads.clear();
+            }
+            for (const auto listener: platform->extraListeners) {
+                (void)close(listener);
+            }
+            platform->extraListeners.clear();
+        }
         if (platform->sock >= 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 0,
                 "closing endpoint for port %" PRIu16,
                 port
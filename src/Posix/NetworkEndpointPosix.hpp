@@ -10,10 +10,13 @@
  * Copyright (c) 2016 by Richard Walters
  */
 
+#include "../MpscQueue.hpp"
 #include "PipeSignal.hpp"
 
-#include <list>
+#include <atomic>
+#include <deque>
 #include <mutex>
+#include <stddef.h>
 #include <stdint.h>
 #include <SystemAbstractions/NetworkEndpoint.hpp>
 #include <thread>
@@ -55,15 +58,69 @@ namespace SystemAbstractions {
          */
         bool processorStop = false;
 
+        /**
+         * These are the sockets used to listen for connections, in
+         * connection mode, besides the main socket.
+         */
+        std::vector< int > extraListeners;
+
+        /**
+         * These are the threads which accept connections on the
+         * extra listening sockets.
+         */
+        std::vector< std::thread > extraListenerThreads;
+
+        /**
+         * This is used to tell the threads accepting connections on the
+         * extra listening sockets to stop.  It's never cleared
+         * while they're running.
+         */
+        PipeSignal extraListenersStopSignal;
+
         /**
          * @todo Needs documentation
          */
         std::recursive_mutex processingMutex;
 
         /**
-         * @todo Needs documentation
+         * This holds packets waiting to be sent.  Senders push packets
+         * onto it without taking any lock, and the worker thread
+         * pops them off in batches to send them.
+         */
+        MpscQueue< Packet > outbox;
+
+        /**
+         * This indicates whether or not the worker thread has already
+         * been signaled about packets pushed onto the outbox, so that
+         * senders don't need to signal it for every packet.
+         */
+        std::atomic< bool > outboxSignaled{false};
+
+        /**
+         * This holds packets waiting to be sent which didn't fit in
+         * the outbox.
+         */
+        std::deque< Packet > overflow;
+
+        /**
+         * This indicates whether or not there are any packets in
+         * the overflow queue.  While this is set, all new packets
+         * are put in the overflow queue too, so that they aren't sent
+         * ahead of packets already in it.
+         */
+        std::atomic< bool > overflowing{false};
+
+        /**
+         * This is used to synchronize access to the overflow queue.
+         */
+        std::mutex overflowMutex;
+
+        // Methods
+
+        /**
+         * This is the instance constructor.
          */
-        std::list< Packet > outputQueue;
+        Platform();
     };
 
 }
@@ -0,0 +1,158 @@
+#ifndef SYSTEM_ABSTRACTIONS_NETWORK_EVENT_LOOP_HPP
+#define SYSTEM_ABSTRACTIONS_NETWORK_EVENT_LOOP_HPP
+
+/**
+ * @file NetworkEventLoop.hpp
+ *
+ * This module declares the SystemAbstractions::NetworkEventLoop class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class represents a small fixed pool of worker threads,
+     * each of which waits for any number of network sockets to become
+     * ready, and calls back a delegate registered for each socket
+     * when it does.  A socket is always serviced by the same
+     * worker thread, so callbacks for one socket never overlap.
+     *
+     * This is only implemented for operating systems which provide
+     * a scalable readiness notification facility.  On others,
+     * the Initialize method fails.
+     */
+    class NetworkEventLoop {
+        // Types
+    public:
+        /**
+         * This is the type of callback issued by a worker thread
+         * whenever a registered socket becomes ready.
+         */
+        typedef std::function< void() > ReadyDelegate;
+
+        /**
+         * This represents the registration of one socket with
+         * the event loop.  It is defined in the platform-specific
+         * part of the implementation.
+         */
+        struct Registration;
+
+        // Lifecycle management
+    public:
+        ~NetworkEventLoop() noexcept;
+        NetworkEventLoop(const NetworkEventLoop&) = delete;
+        NetworkEventLoop(NetworkEventLoop&&) noexcept = delete;
+        NetworkEventLoop& operator=(const NetworkEventLoop&) = delete;
+        NetworkEventLoop& operator=(NetworkEventLoop&&) noexcept = delete;
+
+        // Public methods
+    public:
+        /**
+         * This is the instance constructor.
+         */
+        NetworkEventLoop();
+
+        /**
+         * This method initializes the instance, starting its
+         * worker threads, and must be called before other methods
+         * besides the constructor.
+         *
+         * @param[in] numThreads
+         *     This is the number of worker threads to start.
+         *
+         * @return
+         *     A flag indicating whether or not the method succeeded
+         *     is returned.
+         */
+        bool Initialize(size_t numThreads);
+
+        /**
+         * This method returns a human-readable string indicating
+         * the last error that occurred in another method of the instance.
+         *
+         * @return
+         *     A human-readable string indicating the last error that
+         *     occurred in another method of the instance is returned.
+         */
+        std::string GetLastError() const;
+
+        /**
+         * This method registers the given socket with the event loop,
+         * initially waiting only for it to become readable.
+         *
+         * @param[in] handle
+         *     This is the operating system handle of the socket.
+         *
+         * @param[in] readyDelegate
+         *     This is the callback to issue whenever the socket
+         *     becomes ready.
+         *
+         * @return
+         *     An object representing the registration is returned.
+         *
+         * @retval nullptr
+         *     This is returned if the socket could not be registered.
+         */
+        std::shared_ptr< Registration > Add(
+            int handle,
+            ReadyDelegate readyDelegate
+        );
+
+        /**
+         * This method changes the conditions for which the event loop
+         * waits on behalf of a registered socket.
+         *
+         * @param[in] registration
+         *     This represents the registration of the socket.
+         *
+         * @param[in] read
+         *     This indicates whether or not to wait for the socket
+         *     to become readable.
+         *
+         * @param[in] write
+         *     This indicates whether or not to wait for the socket
+         *     to become writable.
+         */
+        void SetInterest(
+            const std::shared_ptr< Registration >& registration,
+            bool read,
+            bool write
+        );
+
+        /**
+         * This method removes the registration of a socket from the
+         * event loop.  It must be called before the socket is closed.
+         * The socket's delegate may still be called once more after
+         * this, by a worker thread which had already found the
+         * socket ready, so the delegate must tolerate being called
+         * for a socket that has been closed.
+         *
+         * @param[in] registration
+         *     This represents the registration of the socket.
+         */
+        void Remove(const std::shared_ptr< Registration >& registration);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_NETWORK_EVENT_LOOP_HPP */
@@ -9,8 +9,9 @@
 #include <SystemAbstractions/StringFile.hpp>
 
 #include <algorithm>
-#include <deque>
 #include <string>
+#include <string.h>
+#include <vector>
 
 namespace SystemAbstractions {
 
@@ -18,75 +19,163 @@ namespace SystemAbstractions {
      * This contains the private properties of a StringFile instance.
      */
     struct StringFile::Impl {
+        // Properties
+
+        /**
+         * This holds the contents of the file, starting at the
+         * head offset.  Any bytes before the head offset have been
+         * removed from the file, and are only kept until enough of
+         * them build up to be worth moving the rest of the
+         * contents down over them.
+         */
+        std::vector< uint8_t > value;
+
         /**
-         * This is the contents of the file.
+         * This is the offset in the value of the first byte
+         * of the file.
          */
-        std::deque< uint8_t > value;
+        size_t head = 0;
 
         /**
          * This is the current position in the file.
          */
         size_t position = 0;
+
+        // Methods
+
+        /**
+         * This method returns the number of bytes in the file.
+         *
+         * @return
+         *     The number of bytes in the file is returned.
+         */
+        size_t GetSize() const {
+            return value.size() - head;
+        }
+
+        /**
+         * This method replaces the contents of the file with
+         * the given bytes, and moves the file pointer back to the
+         * front of the file.
+         *
+         * @param[in] data
+         *     This points to the new contents of the file.
+         *
+         * @param[in] size
+         *     This is the number of bytes in the new contents of the file.
+         */
+        void Assign(const void* data, size_t size) {
+            value.assign((const uint8_t*)data, (const uint8_t*)data + size);
+            head = 0;
+            position = 0;
+        }
+
+        /**
+         * This method gets rid of any bytes removed from the front
+         * of the file, by moving the rest of the contents down
+         * over them.
+         */
+        void Compact() {
+            if (head == 0) {
+                return;
+            }
+            (void)value.erase(value.begin(), value.begin() + head);
+            head = 0;
+        }
     };
 
     StringFile::StringFile(std::string initialValue)
         : impl_(new Impl())
     {
-        impl_->value.assign(initialValue.begin(), initialValue.end());
+        impl_->Assign(initialValue.data(), initialValue.length());
     }
 
     StringFile::StringFile(std::vector< uint8_t > initialValue)
         : impl_(new Impl())
     {
-        impl_->value.assign(initialValue.begin(), initialValue.end());
+        impl_->value = std::move(initialValue);
     }
 
     StringFile::~StringFile() noexcept = default;
     StringFile::StringFile(const StringFile& other)
         : impl_(new Impl())
     {
-        *impl_ = *other.impl_;
+        *this = other;
     }
     StringFile::StringFile(StringFile&&) noexcept = default;
     StringFile& StringFile::operator=(const StringFile& other) {
         if (&other != this) {
-            *impl_ = *other.impl_;
+            impl_->Assign(
+                other.impl_->value.data() + other.impl_->head,
+                other.impl_->GetSize()
+            );
+            impl_->position = other.impl_->position;
         }
         return *this;
     }
     StringFile& StringFile::operator=(StringFile&&) noexcept = default;
 
     StringFile::operator std::string() const {
-        return std::string(impl_->value.begin(), impl_->value.end());
+        return std::string(
+            (const char*)impl_->value.data() + impl_->head,
+            impl_->GetSize()
+        );
     }
 
     StringFile::operator std::vector< uint8_t >() const {
-        return std::vector< uint8_t >(impl_->value.begin(), impl_->value.end());
+        return std::vector< uint8_t >(
+            impl_->value.begin() + impl_->head,
+            impl_->value.end()
+        );
     }
 
     StringFile& StringFile::operator=(const std::string &b) {
-        impl_->value.assign(b.begin(), b.end());
-        impl_->position = 0;
+        impl_->Assign(b.data(), b.length());
         return *this;
     }
 
     StringFile& StringFile::operator=(const std::vector< uint8_t > &b) {
-        impl_->value.assign(b.begin(), b.end());
+        impl_->Assign(b.data(), b.size());
+        return *this;
+    }
+
+    StringFile& StringFile::operator=(std::vector< uint8_t >&& b) {
+        impl_->value = std::move(b);
+        impl_->head = 0;
         impl_->position = 0;
         return *this;
     }
 
+    std::vector< uint8_t > StringFile::Release() {
+        impl_->Compact();
+        std::vector< uint8_t > value;
+        value.swap(impl_->value);
+        impl_->position = 0;
+        return value;
+    }
+
+    const uint8_t* StringFile::GetData() const {
+        return impl_->value.data() + impl_->head;
+    }
+
     void StringFile::Remove(size_t numBytes) {
-        impl_->value.erase(impl_->value.begin(), impl_->value.begin() + std::min(numBytes, impl_->value.size()));
+        numBytes = std::min(numBytes, impl_->GetSize());
+        impl_->head += numBytes;
+        if (impl_->head == impl_->value.size()) {
+            impl_->value.clear();
+            impl_->head = 0;
+        } else if (impl_->head > impl_->GetSize()) {
+            impl_->Compact();
+        }
         impl_->position = std::max(numBytes, impl_->position) - numBytes;
     }
 
     uint64_t StringFile::GetSize() const {
-        return (uint64_t)impl_->value.size();
+        return (uint64_t)impl_->GetSize();
     }
 
     bool StringFile::SetSize(uint64_t size) {
-        impl_->value.resize((size_t)size);
+        impl_->value.resize(impl_->head + (size_t)size);
         return true;
     }
 
@@ -109,11 +198,7 @@ namespace SystemAbstractions {
     }
 
     size_t StringFile::Peek(void* buffer, size_t numBytes) const {
-        const size_t amountCopied = std::min(numBytes, impl_->value.size() - std::min(impl_->value.size(), impl_->position));
-        for (size_t i = 0; i < amountCopied; ++i) {
-            ((uint8_t*)buffer)[i] = impl_->value[impl_->position + i];
-        }
-        return amountCopied;
+        return ReadAt(impl_->position, buffer, numBytes);
     }
 
     size_t StringFile::Read(Buffer& buffer, size_t numBytes, size_t offset) {
@@ -127,12 +212,9 @@ namespace SystemAbstractions {
     }
 
     size_t StringFile::Read(void* buffer, size_t numBytes) {
-        const size_t amountCopied = std::min(numBytes, impl_->value.size() - std::min(impl_->value.size(), impl_->position));
-        for (size_t i = 0; i < amountCopied; ++i) {
-            ((uint8_t*)buffer)[i] = impl_->value[impl_->position + i];
-        }
-        impl_->position += amountCopied;
-        return amountCopied;
+        const auto amountRead = ReadAt(impl_->position, buffer, numBytes);
+        impl_->position += amountRead;
+        return amountRead;
     }
 
     size_t StringFile::Write(const Buffer& buffer, size_t numBytes, size_t offset) {
@@ -142,34 +224,42 @@ namespace SystemAbstractions {
         if (numBytes == 0) {
             return 0;
         }
-        if (impl_->position + numBytes > impl_->value.size()) {
-            impl_->value.resize(impl_->position + numBytes);
-        }
-        for (size_t i = 0; i < numBytes; ++i) {
-            impl_->value[impl_->position + i] = buffer[offset + i];
-        }
-        impl_->position += numBytes;
-        return numBytes;
+        return Write(&buffer[offset], numBytes);
     }
 
     size_t StringFile::Write(const void* buffer, size_t numBytes) {
+        const auto amountWritten = WriteAt(impl_->position, buffer, numBytes);
+        impl_->position += amountWritten;
+        return amountWritten;
+    }
+
+    size_t StringFile::ReadAt(uint64_t position, void* buffer, size_t numBytes) const {
+        const auto size = impl_->GetSize();
+        if (position >= size) {
+            return 0;
+        }
+        const size_t amountCopied = std::min(numBytes, size - (size_t)position);
+        (void)memcpy(buffer, impl_->value.data() + impl_->head + (size_t)position, amountCopied);
+        return amountCopied;
+    }
+
+    size_t StringFile::WriteAt(uint64_t position, const void* buffer, size_t numBytes) {
         if (numBytes == 0) {
             return 0;
         }
-        if (impl_->position + numBytes > impl_->value.size()) {
-            impl_->value.resize(impl_->position + numBytes);
+        if (impl_->head + (size_t)position + numBytes > impl_->value.capacity()) {
+            impl_->Compact();
         }
-        for (size_t i = 0; i < numBytes; ++i) {
-            impl_->value[impl_->position + i] = ((const uint8_t*)buffer)[i];
+        const auto end = impl_->head + (size_t)position + numBytes;
+        if (end > impl_->value.size()) {
+            impl_->value.resize(end);
         }
-        impl_->position += numBytes;
+        (void)memcpy(impl_->value.data() + impl_->head + (size_t)position, buffer, numBytes);
         return numBytes;
     }
 
     std::shared_ptr< IFile > StringFile::Clone() {
-        auto clone = std::make_shared< StringFile >();
-        *clone->impl_ = *impl_;
-        return clone;
+        return std::make_shared< StringFile >(*this);
     }
 
 }
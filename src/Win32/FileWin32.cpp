@@ -17,6 +17,7 @@
 
 #include "../FileImpl.hpp"
 
+#include <functional>
 #include <io.h>
 #include <KnownFolders.h>
 #include <memory>
@@ -27,6 +28,7 @@
 #include <stdio.h>
 #include <StringExtensions/StringExtensions.hpp>
 #include <SystemAbstractions/File.hpp>
+#include <winioctl.h>
 
 // Ensure we link with Windows shell utility libraries.
 #pragma comment(lib, "Shlwapi")
@@ -34,6 +36,221 @@
 
 namespace {
 
+    /**
+     * This function is called by a thread of the Windows thread pool
+     * to carry out an asynchronous file operation.
+     *
+     * @param[in] instance
+     *     This identifies the callback instance.  It isn't used.
+     *
+     * @param[in] context
+     *     This points to the function which carries out the operation.
+     *     The function is destroyed once it's called.
+     */
+    VOID CALLBACK RunAsyncOperation(PTP_CALLBACK_INSTANCE instance, PVOID context) {
+        std::unique_ptr< std::function< void() > > operation((std::function< void() >*)context);
+        (*operation)();
+    }
+
+    /**
+     * This function hands the given asynchronous file operation to
+     * the Windows thread pool to carry out.  If the thread pool
+     * can't take it, the operation is carried out before returning.
+     *
+     * @param[in] operation
+     *     This is the function which carries out the operation.
+     */
+    void StartAsyncOperation(std::function< void() > operation) {
+        std::unique_ptr< std::function< void() > > heapOperation(
+            new std::function< void() >(std::move(operation))
+        );
+        if (TrySubmitThreadpoolCallback(RunAsyncOperation, heapOperation.get(), NULL)) {
+            (void)heapOperation.release();
+        } else {
+            (*heapOperation)();
+        }
+    }
+
+    /**
+     * This is the directory entry given to the visitor by the
+     * VisitDirectory method.  Everything it reports comes from the
+     * data returned by FindFirstFile/FindNextFile, so no further
+     * calls are made to look up the status of an entry.
+     */
+    class DirectoryEntryWin32
+        : public SystemAbstractions::File::DirectoryEntry
+    {
+        // Properties
+    public:
+        /**
+         * This is the data found for the entry.
+         */
+        WIN32_FIND_DATAA findFileData;
+
+        /**
+         * This is the name of the entry.
+         */
+        std::string name;
+
+        // SystemAbstractions::File::DirectoryEntry
+    public:
+        virtual const std::string& GetName() const override {
+            return name;
+        }
+
+        virtual Type GetType() const override {
+            if ((findFileData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) {
+                return Type::SymbolicLink;
+            } else if ((findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+                return Type::Directory;
+            } else if ((findFileData.dwFileAttributes & FILE_ATTRIBUTE_DEVICE) != 0) {
+                return Type::Other;
+            } else {
+                return Type::File;
+            }
+        }
+
+        virtual uint64_t GetSize() const override {
+            return (
+                ((uint64_t)findFileData.nFileSizeHigh << 32)
+                | (uint64_t)findFileData.nFileSizeLow
+            );
+        }
+
+        virtual time_t GetLastModifiedTime() const override {
+            // FILETIME counts 100-nanosecond intervals since 1601-01-01,
+            // whereas time_t counts seconds since 1970-01-01.
+            const uint64_t fileTime = (
+                ((uint64_t)findFileData.ftLastWriteTime.dwHighDateTime << 32)
+                | (uint64_t)findFileData.ftLastWriteTime.dwLowDateTime
+            );
+            static const uint64_t unixEpochFileTime = 116444736000000000ULL;
+            if (fileTime < unixEpochFileTime) {
+                return 0;
+            }
+            return (time_t)((fileTime - unixEpochFileTime) / 10000000);
+        }
+    };
+
+    /**
+     * This function records that the given entry couldn't be
+     * deleted or copied.
+     *
+     * @param[in,out] result
+     *     This is the summary of the operation.
+     *
+     * @param[in] path
+     *     This is the path of the entry.
+     */
+    void RecordFailure(
+        SystemAbstractions::File::DirectoryOperationResult& result,
+        const std::string& path
+    ) {
+        if (result.failures++ == 0) {
+            result.firstFailurePath = path;
+        }
+    }
+
+    /**
+     * This function deletes everything in the given directory,
+     * and then the directory itself.
+     *
+     * @param[in] directory
+     *     This is the directory to delete.
+     *
+     * @param[in,out] result
+     *     This is the summary of the operation.
+     *
+     * @return
+     *     A flag indicating whether or not the directory
+     *     was deleted is returned.
+     */
+    bool DeleteDirectoryTree(
+        const std::string& directory,
+        SystemAbstractions::File::DirectoryOperationResult& result
+    ) {
+        const auto directoryWithSeparator = directory + "\\";
+        bool complete = true;
+        if (
+            !SystemAbstractions::File::VisitDirectory(
+                directory,
+                [&](const SystemAbstractions::File::DirectoryEntry& entry){
+                    const auto filePath = directoryWithSeparator + entry.GetName();
+                    if (entry.GetType() == SystemAbstractions::File::DirectoryEntry::Type::Directory) {
+                        if (!DeleteDirectoryTree(filePath, result)) {
+                            complete = false;
+                        }
+                    } else if (DeleteFileA(filePath.c_str()) != 0) {
+                        ++result.filesProcessed;
+                    } else {
+                        RecordFailure(result, filePath);
+                        complete = false;
+                    }
+                    return true;
+                }
+            )
+        ) {
+            RecordFailure(result, directory);
+            return false;
+        }
+        if (!complete) {
+            return false;
+        }
+        if (RemoveDirectoryA(directory.c_str()) == 0) {
+            RecordFailure(result, directory);
+            return false;
+        }
+        ++result.directoriesProcessed;
+        return true;
+    }
+
+    /**
+     * This function copies everything in the given directory
+     * into another directory, which has already been created.
+     *
+     * @param[in] existingDirectory
+     *     This is the directory to copy.
+     *
+     * @param[in] newDirectory
+     *     This is the directory into which to copy.
+     *
+     * @param[in,out] result
+     *     This is the summary of the operation.
+     */
+    void CopyDirectoryTree(
+        const std::string& existingDirectory,
+        const std::string& newDirectory,
+        SystemAbstractions::File::DirectoryOperationResult& result
+    ) {
+        if (
+            !SystemAbstractions::File::VisitDirectory(
+                existingDirectory,
+                [&](const SystemAbstractions::File::DirectoryEntry& entry){
+                    const auto filePath = existingDirectory + "\\" + entry.GetName();
+                    const auto newFilePath = newDirectory + "\\" + entry.GetName();
+                    if (entry.GetType() == SystemAbstractions::File::DirectoryEntry::Type::Directory) {
+                        if (
+                            (CreateDirectoryA(newFilePath.c_str(), NULL) != 0)
+                            || (GetLastError() == ERROR_ALREADY_EXISTS)
+                        ) {
+                            ++result.directoriesProcessed;
+                            CopyDirectoryTree(filePath, newFilePath, result);
+                        } else {
+                            RecordFailure(result, newFilePath);
+                        }
+                    } else if (CopyFileA(filePath.c_str(), newFilePath.c_str(), FALSE) != 0) {
+                        ++result.filesProcessed;
+                    } else {
+                        RecordFailure(result, filePath);
+                    }
+                    return true;
+                }
+            )
+        ) {
+            RecordFailure(result, existingDirectory);
+        }
+    }
+
     /**
      * This function replaces all backslashes with forward slashes
      * in the given string.
@@ -281,79 +498,87 @@ namespace SystemAbstractions {
         ) {
             directoryWithSeparator += '\\';
         }
-        std::string listGlob(directoryWithSeparator);
-        listGlob += "*.*";
-        WIN32_FIND_DATAA findFileData;
-        const HANDLE searchHandle = FindFirstFileA(listGlob.c_str(), &findFileData);
         list.clear();
-        if (searchHandle != INVALID_HANDLE_VALUE) {
-            do {
-                std::string name(findFileData.cFileName);
-                if (
-                    (name == ".")
-                    || (name == "..")
-                ) {
-                    continue;
-                }
-                std::string filePath(directoryWithSeparator);
-                filePath += name;
-                list.push_back(FixPathDelimiters(filePath));
-            } while (FindNextFileA(searchHandle, &findFileData) == TRUE);
-            FindClose(searchHandle);
-        }
+        (void)VisitDirectory(
+            directory,
+            [&](const DirectoryEntry& entry){
+                list.push_back(FixPathDelimiters(directoryWithSeparator + entry.GetName()));
+                return true;
+            }
+        );
     }
 
-    bool File::DeleteDirectory(const std::string& directory) {
-        std::string directoryWithSeparator(directory);
+    bool File::VisitDirectory(
+        const std::string& directory,
+        DirectoryVisitor visitor
+    ) {
+        std::string listGlob(directory);
         if (
-            (directoryWithSeparator.length() > 0)
-            && (directoryWithSeparator[directoryWithSeparator.length() - 1] != '\\')
-            && (directoryWithSeparator[directoryWithSeparator.length() - 1] != '/')
+            (listGlob.length() > 0)
+            && (listGlob[listGlob.length() - 1] != '\\')
+            && (listGlob[listGlob.length() - 1] != '/')
         ) {
-            directoryWithSeparator += '\\';
+            listGlob += '\\';
         }
-        std::string listGlob(directoryWithSeparator);
         listGlob += "*.*";
-        WIN32_FIND_DATAA findFileData;
-        const HANDLE searchHandle = FindFirstFileA(listGlob.c_str(), &findFileData);
-        if (searchHandle != INVALID_HANDLE_VALUE) {
-            do {
-                std::string name(findFileData.cFileName);
-                if (
-                    (name == ".")
-                    || (name == "..")
-                ) {
-                    continue;
-                }
-                std::string filePath(directoryWithSeparator);
-                filePath += name;
-                if (PathIsDirectoryA(filePath.c_str())) {
-                    if (!DeleteDirectory(filePath.c_str())) {
-                        return false;
-                    }
-                } else {
-                    if (DeleteFileA(filePath.c_str()) == 0) {
-                        return false;
-                    }
-                }
-            } while (FindNextFileA(searchHandle, &findFileData) == TRUE);
-            FindClose(searchHandle);
+        DirectoryEntryWin32 entry;
+        const HANDLE searchHandle = FindFirstFileExA(
+            listGlob.c_str(),
+            FindExInfoBasic,
+            &entry.findFileData,
+            FindExSearchNameMatch,
+            NULL,
+            FIND_FIRST_EX_LARGE_FETCH
+        );
+        if (searchHandle == INVALID_HANDLE_VALUE) {
+            return false;
         }
-        return (RemoveDirectoryA(directory.c_str()) != 0);
+        bool success = true;
+        while (true) {
+            entry.name = entry.findFileData.cFileName;
+            if (
+                (entry.name != ".")
+                && (entry.name != "..")
+                && !visitor(entry)
+            ) {
+                break;
+            }
+            if (FindNextFileA(searchHandle, &entry.findFileData) != TRUE) {
+                success = (GetLastError() == ERROR_NO_MORE_FILES);
+                break;
+            }
+        }
+        FindClose(searchHandle);
+        return success;
     }
 
-    bool File::CopyDirectory(
-        const std::string& existingDirectory,
-        const std::string& newDirectory
+    bool File::DeleteDirectory(
+        const std::string& directory,
+        DirectoryOperationResult& result
     ) {
-        std::string existingDirectoryWithSeparator(existingDirectory);
-        if (
-            (existingDirectoryWithSeparator.length() > 0)
-            && (existingDirectoryWithSeparator[existingDirectoryWithSeparator.length() - 1] != '\\')
-            && (existingDirectoryWithSeparator[existingDirectoryWithSeparator.length() - 1] != '/')
+        result = DirectoryOperationResult();
+        std::string directoryWithoutSeparator(directory);
+        while (
+            (directoryWithoutSeparator.length() > 1)
+            && (
+                (directoryWithoutSeparator[directoryWithoutSeparator.length() - 1] == '\\')
+                || (directoryWithoutSeparator[directoryWithoutSeparator.length() - 1] == '/')
+            )
         ) {
-            existingDirectoryWithSeparator += '\\';
+            directoryWithoutSeparator.pop_back();
+        }
+        if (GetFileAttributesA(directoryWithoutSeparator.c_str()) != INVALID_FILE_ATTRIBUTES) {
+            (void)DeleteDirectoryTree(directoryWithoutSeparator, result);
         }
+        return (bool)result;
+    }
+
+    bool File::CopyDirectory(
+        const std::string& existingDirectory,
+        const std::string& newDirectory,
+        DirectoryOperationResult& result
+    ) {
+        result = DirectoryOperationResult();
         std::string newDirectoryWithSeparator(newDirectory);
         if (
             (newDirectoryWithSeparator.length() > 0)
@@ -363,38 +588,12 @@ namespace SystemAbstractions {
             newDirectoryWithSeparator += '\\';
         }
         if (!File::Impl::CreatePath(newDirectoryWithSeparator)) {
+            RecordFailure(result, newDirectory);
             return false;
         }
-        std::string listGlob(existingDirectoryWithSeparator);
-        listGlob += "*.*";
-        WIN32_FIND_DATAA findFileData;
-        const HANDLE searchHandle = FindFirstFileA(listGlob.c_str(), &findFileData);
-        if (searchHandle != INVALID_HANDLE_VALUE) {
-            do {
-                std::string name(findFileData.cFileName);
-                if (
-                    (name == ".")
-                    || (name == "..")
-                ) {
-                    continue;
-                }
-                std::string filePath(existingDirectoryWithSeparator);
-                filePath += name;
-                std::string newFilePath(newDirectoryWithSeparator);
-                newFilePath += name;
-                if (PathIsDirectoryA(filePath.c_str())) {
-                    if (!CopyDirectory(filePath, newFilePath)) {
-                        return false;
-                    }
-                } else {
-                    if (!CopyFileA(filePath.c_str(), newFilePath.c_str(), FALSE)) {
-                        return false;
-                    }
-                }
-            } while (FindNextFileA(searchHandle, &findFileData) == TRUE);
-            FindClose(searchHandle);
-        }
-        return true;
+        ++result.directoriesProcessed;
+        CopyDirectoryTree(existingDirectory, newDirectory, result);
+        return (bool)result;
     }
 
     std::vector< std::string > File::GetDirectoryRoots() {
@@ -511,6 +710,192 @@ namespace SystemAbstractions {
         return (size_t)amountWritten;
     }
 
+    size_t File::ReadAt(uint64_t position, void* buffer, size_t numBytes) const {
+        const uint64_t originalPosition = GetPosition();
+        OVERLAPPED overlapped = {0};
+        overlapped.Offset = (DWORD)(position & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(position >> 32);
+        DWORD amountRead;
+        const auto readResult = ReadFile(impl_->platform->handle, buffer, (DWORD)numBytes, &amountRead, &overlapped);
+        LARGE_INTEGER distanceToMove;
+        distanceToMove.QuadPart = originalPosition;
+        (void)SetFilePointerEx(impl_->platform->handle, distanceToMove, NULL, FILE_BEGIN);
+        if (readResult == 0) {
+            return 0;
+        }
+        return (size_t)amountRead;
+    }
+
+    size_t File::WriteAt(uint64_t position, const void* buffer, size_t numBytes) {
+        const uint64_t originalPosition = GetPosition();
+        OVERLAPPED overlapped = {0};
+        overlapped.Offset = (DWORD)(position & 0xFFFFFFFF);
+        overlapped.OffsetHigh = (DWORD)(position >> 32);
+        DWORD amountWritten;
+        const auto writeResult = WriteFile(impl_->platform->handle, buffer, (DWORD)numBytes, &amountWritten, &overlapped);
+        SetPosition(originalPosition);
+        if (writeResult == 0) {
+            return 0;
+        }
+        return (size_t)amountWritten;
+    }
+
+    void File::ReadAtAsync(
+        uint64_t position,
+        void* buffer,
+        size_t numBytes,
+        AsyncCompletionDelegate completionDelegate
+    ) {
+        const auto handle = impl_->platform->handle;
+        StartAsyncOperation(
+            [handle, position, buffer, numBytes, completionDelegate]{
+                OVERLAPPED overlapped = {0};
+                overlapped.Offset = (DWORD)(position & 0xFFFFFFFF);
+                overlapped.OffsetHigh = (DWORD)(position >> 32);
+                DWORD amountRead;
+                if (ReadFile(handle, buffer, (DWORD)numBytes, &amountRead, &overlapped) == 0) {
+                    completionDelegate(GetLastError() == ERROR_HANDLE_EOF, 0);
+                } else {
+                    completionDelegate(true, (size_t)amountRead);
+                }
+            }
+        );
+    }
+
+    void File::WriteAtAsync(
+        uint64_t position,
+        const void* buffer,
+        size_t numBytes,
+        AsyncCompletionDelegate completionDelegate
+    ) {
+        const auto handle = impl_->platform->handle;
+        StartAsyncOperation(
+            [handle, position, buffer, numBytes, completionDelegate]{
+                OVERLAPPED overlapped = {0};
+                overlapped.Offset = (DWORD)(position & 0xFFFFFFFF);
+                overlapped.OffsetHigh = (DWORD)(position >> 32);
+                DWORD amountWritten;
+                if (WriteFile(handle, buffer, (DWORD)numBytes, &amountWritten, &overlapped) == 0) {
+                    completionDelegate(false, 0);
+                } else {
+                    completionDelegate(true, (size_t)amountWritten);
+                }
+            }
+        );
+    }
+
+    void File::SyncAsync(AsyncCompletionDelegate completionDelegate) {
+        const auto handle = impl_->platform->handle;
+        StartAsyncOperation(
+            [handle, completionDelegate]{
+                completionDelegate(FlushFileBuffers(handle) != 0, 0);
+            }
+        );
+    }
+
+    bool File::Preallocate(
+        uint64_t position,
+        uint64_t numBytes,
+        bool changeSize
+    ) {
+        if (impl_->platform->handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        if (numBytes == 0) {
+            return true;
+        }
+        const auto end = position + numBytes;
+        FILE_STANDARD_INFO standardInfo;
+        if (
+            GetFileInformationByHandleEx(
+                impl_->platform->handle,
+                FileStandardInfo,
+                &standardInfo,
+                sizeof(standardInfo)
+            ) == 0
+        ) {
+            return false;
+        }
+        if (end > (uint64_t)standardInfo.AllocationSize.QuadPart) {
+            FILE_ALLOCATION_INFO allocationInfo;
+            allocationInfo.AllocationSize.QuadPart = (LONGLONG)end;
+            if (
+                SetFileInformationByHandle(
+                    impl_->platform->handle,
+                    FileAllocationInfo,
+                    &allocationInfo,
+                    sizeof(allocationInfo)
+                ) == 0
+            ) {
+                return false;
+            }
+        }
+        if (
+            changeSize
+            && (end > (uint64_t)standardInfo.EndOfFile.QuadPart)
+        ) {
+            FILE_END_OF_FILE_INFO endOfFileInfo;
+            endOfFileInfo.EndOfFile.QuadPart = (LONGLONG)end;
+            return (
+                SetFileInformationByHandle(
+                    impl_->platform->handle,
+                    FileEndOfFileInfo,
+                    &endOfFileInfo,
+                    sizeof(endOfFileInfo)
+                ) != 0
+            );
+        }
+        return true;
+    }
+
+    bool File::PunchHole(uint64_t position, uint64_t numBytes) {
+        if (impl_->platform->handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        if (numBytes == 0) {
+            return true;
+        }
+        DWORD bytesReturned;
+        if (
+            DeviceIoControl(
+                impl_->platform->handle,
+                FSCTL_SET_SPARSE,
+                NULL, 0,
+                NULL, 0,
+                &bytesReturned,
+                NULL
+            ) == 0
+        ) {
+            return false;
+        }
+        FILE_ZERO_DATA_INFORMATION zeroDataInfo;
+        zeroDataInfo.FileOffset.QuadPart = (LONGLONG)position;
+        zeroDataInfo.BeyondFinalZero.QuadPart = (LONGLONG)(position + numBytes);
+        return (
+            DeviceIoControl(
+                impl_->platform->handle,
+                FSCTL_SET_ZERO_DATA,
+                &zeroDataInfo, sizeof(zeroDataInfo),
+                NULL, 0,
+                &bytesReturned,
+                NULL
+            ) != 0
+        );
+    }
+
+    bool File::Sync(SyncMode mode) {
+        if (impl_->platform->handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        if (mode == SyncMode::None) {
+            return true;
+        }
+        // Windows has no way to start writeback without waiting,
+        // or to write back only the data, so all other modes
+        // write back everything.
+        return (FlushFileBuffers(impl_->platform->handle) != 0);
+    }
+
     std::shared_ptr< IFile > File::Clone() {
         auto clone = std::make_shared< File >(impl_->path);
         clone->impl_->platform->writeAccess = impl_->platform->writeAccess;
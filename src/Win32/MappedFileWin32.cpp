@@ -0,0 +1,222 @@
+/**
+ * @file MappedFileWin32.cpp
+ *
+ * This module contains the Win32 specific part of the
+ * implementation of the SystemAbstractions::MappedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+/**
+ * Windows.h should always be included first because other Windows header
+ * files, such as KnownFolders.h, don't always define things properly if
+ * you don't include Windows.h first.
+ */
+#include <Windows.h>
+
+#include "../MappedFileImpl.hpp"
+
+#include <SystemAbstractions/MappedFile.hpp>
+
+namespace SystemAbstractions {
+
+    /**
+     * This is the Win32-specific state for the MappedFile class.
+     */
+    struct MappedFile::Platform {
+        /**
+         * This is the operating-system handle to the file.
+         */
+        HANDLE handle = INVALID_HANDLE_VALUE;
+
+        /**
+         * This is the operating-system handle to the mapping
+         * of the file.
+         */
+        HANDLE mapping = NULL;
+
+        // Methods
+
+        /**
+         * This method maps the given number of bytes of the file
+         * into memory, extending the file if it's smaller.
+         *
+         * @param[in] size
+         *     This is the number of bytes of the file to map.
+         *
+         * @param[in] write
+         *     This flag indicates whether or not the mapping
+         *     should allow writing.
+         *
+         * @param[out] newMapping
+         *     This is where to put the operating-system handle
+         *     to the new mapping of the file.
+         *
+         * @return
+         *     A pointer to the mapped contents of the file is returned.
+         *     It's null if the size is zero or the mapping failed.
+         */
+        uint8_t* Map(uint64_t size, bool write, HANDLE& newMapping) {
+            newMapping = NULL;
+            if (size == 0) {
+                return nullptr;
+            }
+            const auto mapping = CreateFileMappingA(
+                handle,
+                NULL,
+                (write ? PAGE_READWRITE : PAGE_READONLY),
+                (DWORD)(size >> 32),
+                (DWORD)(size & 0xFFFFFFFF),
+                NULL
+            );
+            if (mapping == NULL) {
+                return nullptr;
+            }
+            const auto data = MapViewOfFile(
+                mapping,
+                (write ? FILE_MAP_WRITE : FILE_MAP_READ),
+                0,
+                0,
+                (SIZE_T)size
+            );
+            if (data == NULL) {
+                (void)CloseHandle(mapping);
+                return nullptr;
+            }
+            newMapping = mapping;
+            return (uint8_t*)data;
+        }
+
+        /**
+         * This method unmaps the contents of the file, if
+         * they're mapped.
+         *
+         * @param[in] data
+         *     This points to the mapped contents of the file.
+         */
+        void Unmap(uint8_t* data) {
+            if (data != nullptr) {
+                (void)UnmapViewOfFile(data);
+            }
+            if (mapping != NULL) {
+                (void)CloseHandle(mapping);
+                mapping = NULL;
+            }
+        }
+    };
+
+    MappedFile::Impl::~Impl() noexcept {
+        Close();
+    }
+
+    MappedFile::Impl::Impl()
+        : platform(new Platform())
+    {
+    }
+
+    bool MappedFile::Impl::Open(bool write) {
+        platform->handle = CreateFileA(
+            path.c_str(),
+            (write ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ),
+            FILE_SHARE_DELETE | FILE_SHARE_READ | FILE_SHARE_WRITE,
+            NULL,
+            (write ? OPEN_ALWAYS : OPEN_EXISTING),
+            FILE_ATTRIBUTE_NORMAL,
+            NULL
+        );
+        if (platform->handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(platform->handle, &fileSize) == 0) {
+            Close();
+            return false;
+        }
+        size = (uint64_t)fileSize.QuadPart;
+        capacity = size;
+        data = platform->Map(size, write, platform->mapping);
+        if (
+            (size > 0)
+            && (data == nullptr)
+        ) {
+            Close();
+            return false;
+        }
+        position = 0;
+        writeAccess = write;
+        isOpen = true;
+        return true;
+    }
+
+    void MappedFile::Impl::Close() {
+        platform->Unmap(data);
+        data = nullptr;
+        if (platform->handle != INVALID_HANDLE_VALUE) {
+            if (
+                writeAccess
+                && (capacity != size)
+            ) {
+                LARGE_INTEGER distanceToMove;
+                distanceToMove.QuadPart = size;
+                if (SetFilePointerEx(platform->handle, distanceToMove, NULL, FILE_BEGIN) != 0) {
+                    (void)SetEndOfFile(platform->handle);
+                }
+            }
+            (void)CloseHandle(platform->handle);
+            platform->handle = INVALID_HANDLE_VALUE;
+        }
+        size = 0;
+        capacity = 0;
+        writeAccess = false;
+        isOpen = false;
+    }
+
+    bool MappedFile::Impl::Reserve(uint64_t newCapacity) {
+        if (newCapacity <= capacity) {
+            return true;
+        }
+
+        // Making a mapping larger than the file extends the file,
+        // so the old mapping can stay in place until the new one
+        // is known to be good.
+        HANDLE newMapping;
+        const auto newData = platform->Map(newCapacity, writeAccess, newMapping);
+        if (newData == nullptr) {
+            return false;
+        }
+        platform->Unmap(data);
+        platform->mapping = newMapping;
+        data = newData;
+        capacity = newCapacity;
+        return true;
+    }
+
+    bool MappedFile::Impl::Trim() {
+        if (capacity == size) {
+            return true;
+        }
+
+        // A file can't be made smaller while it's mapped,
+        // so the contents have to be unmapped first.
+        platform->Unmap(data);
+        data = nullptr;
+        LARGE_INTEGER distanceToMove;
+        distanceToMove.QuadPart = size;
+        const auto trimmed = (
+            (SetFilePointerEx(platform->handle, distanceToMove, NULL, FILE_BEGIN) != 0)
+            && (SetEndOfFile(platform->handle) != 0)
+        );
+        const auto mappedSize = (trimmed ? size : capacity);
+        data = platform->Map(mappedSize, writeAccess, platform->mapping);
+        if (
+            (mappedSize > 0)
+            && (data == nullptr)
+        ) {
+            Close();
+            return false;
+        }
+        capacity = mappedSize;
+        return trimmed;
+    }
+
+}
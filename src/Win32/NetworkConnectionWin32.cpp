@@ -92,7 +92,8 @@ namespace SystemAbstractions {
         socketAddress.sin_family = AF_INET;
         platform->sock = socket(socketAddress.sin_family, SOCK_STREAM, 0);
         if (platform->sock == INVALID_SOCKET) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error creating socket (%d)",
                 WSAGetLastError()
@@ -104,7 +105,8 @@ namespace SystemAbstractions {
         linger.l_linger = 0;
         (void)setsockopt(platform->sock, SOL_SOCKET, SO_LINGER, (const char*)&linger, sizeof(linger));
         if (bind(platform->sock, (struct sockaddr*)&socketAddress, sizeof(socketAddress)) != 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error in bind (%d)",
                 WSAGetLastError()
@@ -117,7 +119,8 @@ namespace SystemAbstractions {
         socketAddress.sin_addr.S_un.S_addr = htonl(peerAddress);
         socketAddress.sin_port = htons(peerPort);
         if (connect(platform->sock, (const sockaddr*)&socketAddress, sizeof(socketAddress)) != 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error in connect (%d)",
                 WSAGetLastError()
@@ -135,14 +138,16 @@ namespace SystemAbstractions {
 
     bool NetworkConnection::Impl::Process() {
         if (platform->sock == INVALID_SOCKET) {
-            diagnosticsSender.SendDiagnosticInformationString(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "not connected"
             );
             return false;
         }
         if (platform->processor.joinable()) {
-            diagnosticsSender.SendDiagnosticInformationString(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::WARNING,
                 "already processing"
             );
@@ -152,7 +157,8 @@ namespace SystemAbstractions {
         if (platform->processorStateChangeEvent == NULL) {
             platform->processorStateChangeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
             if (platform->processorStateChangeEvent == NULL) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error creating processor state change event (%d)",
                     (int)GetLastError()
@@ -163,7 +169,8 @@ namespace SystemAbstractions {
         if (platform->socketEvent == NULL) {
             platform->socketEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
             if (platform->socketEvent == NULL) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error creating socket event (%d)",
                     (int)GetLastError()
@@ -172,7 +179,8 @@ namespace SystemAbstractions {
             }
         }
         if (WSAEventSelect(platform->sock, platform->socketEvent, FD_READ | FD_WRITE | FD_CLOSE) != 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error in WSAEventSelect (%d)",
                 WSAGetLastError()
@@ -194,24 +202,25 @@ namespace SystemAbstractions {
             && (platform->sock != INVALID_SOCKET)
         ) {
             if (wait) {
-                diagnosticsSender.SendDiagnosticInformationString(0, "processor going to sleep");
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor going to sleep");
                 processingLock.unlock();
                 (void)WaitForMultipleObjects(2, handles, FALSE, INFINITE);
                 processingLock.lock();
             }
-            diagnosticsSender.SendDiagnosticInformationString(0, "processor woke up");
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor woke up");
             if (platform->peerClosed) {
                 wait = true;
             } else {
                 buffer.resize(MAXIMUM_READ_SIZE);
-                diagnosticsSender.SendDiagnosticInformationString(0, "processor trying to read");
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor trying to read");
                 const int amountReceived = recv(platform->sock, (char*)&buffer[0], (int)buffer.size(), 0);
                 if (amountReceived == SOCKET_ERROR) {
                     const auto wsaLastError = WSAGetLastError();
                     if (wsaLastError == WSAEWOULDBLOCK) {
                         wait = true;
                     } else {
-                        diagnosticsSender.SendDiagnosticInformationString(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                            diagnosticsSender,
                             1,
                             "connection closed abruptly by peer"
                         );
@@ -223,14 +232,21 @@ namespace SystemAbstractions {
                         break;
                     }
                 } else if (amountReceived > 0) {
-                    diagnosticsSender.SendDiagnosticInformationString(0, "processor read something");
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor read something");
                     wait = false;
                     buffer.resize((size_t)amountReceived);
                     processingLock.unlock();
-                    messageReceivedDelegate(buffer);
+                    if (messageBufferReceivedDelegate == nullptr) {
+                        messageReceivedDelegate(buffer);
+                    } else {
+                        const auto message = std::make_shared< std::vector< uint8_t > >();
+                        message->swap(buffer);
+                        messageBufferReceivedDelegate(message);
+                    }
                     processingLock.lock();
                 } else {
-                    diagnosticsSender.SendDiagnosticInformationString(
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                        diagnosticsSender,
                         1,
                         "connection closed gracefully by peer"
                     );
@@ -245,14 +261,15 @@ namespace SystemAbstractions {
             }
             const auto outputQueueLength = platform->outputQueue.GetBytesQueued();
             if (outputQueueLength > 0) {
-                diagnosticsSender.SendDiagnosticInformationString(0, "processor trying to write");
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor trying to write");
                 const auto writeSize = (int)std::min(outputQueueLength, MAXIMUM_WRITE_SIZE);
                 buffer = platform->outputQueue.Peek(writeSize);
                 const int amountSent = send(platform->sock, (const char*)&buffer[0], writeSize, 0);
                 if (amountSent == SOCKET_ERROR) {
                     const auto wsaLastError = WSAGetLastError();
                     if (wsaLastError != WSAEWOULDBLOCK) {
-                        diagnosticsSender.SendDiagnosticInformationString(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                            diagnosticsSender,
                             1,
                             "connection closed abruptly by peer"
                         );
@@ -261,17 +278,17 @@ namespace SystemAbstractions {
                             brokenDelegate(false);
                             processingLock.lock();
                         }
-                        diagnosticsSender.SendDiagnosticInformationString(0, "processor breaking due to send error");
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor breaking due to send error");
                         break;
                     }
                 } else if (amountSent > 0) {
-                    diagnosticsSender.SendDiagnosticInformationString(0, "processor wrote something");
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor wrote something");
                     (void)platform->outputQueue.Drop(amountSent);
                     if (
                         (amountSent == writeSize)
                         && (platform->outputQueue.GetBytesQueued() > 0)
                     ) {
-                        diagnosticsSender.SendDiagnosticInformationString(0, "processor has more to write");
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor has more to write");
                         wait = false;
                     }
                 } else {
@@ -280,7 +297,7 @@ namespace SystemAbstractions {
                         brokenDelegate(false);
                         processingLock.lock();
                     }
-                    diagnosticsSender.SendDiagnosticInformationString(0, "processor breaking due to send returning 0");
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor breaking due to send returning 0");
                     break;
                 }
             }
@@ -289,12 +306,12 @@ namespace SystemAbstractions {
                 && platform->closing
             ) {
                 if (!platform->shutdownSent) {
-                    diagnosticsSender.SendDiagnosticInformationString(0, "processor closing and done sending");
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor closing and done sending");
                     shutdown(platform->sock, SD_SEND);
                     platform->shutdownSent = true;
                 }
                 if (platform->peerClosed) {
-                    diagnosticsSender.SendDiagnosticInformationString(0, "processor closing connection immediately");
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor closing connection immediately");
                     CloseImmediately();
                     if (brokenDelegate != nullptr) {
                         processingLock.unlock();
@@ -304,7 +321,7 @@ namespace SystemAbstractions {
                 }
             }
         }
-        diagnosticsSender.SendDiagnosticInformationString(0, "processor returning due to being told to stop");
+        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(diagnosticsSender, 0, "processor returning due to being told to stop");
     }
 
     bool NetworkConnection::Impl::IsConnected() const {
@@ -317,6 +334,18 @@ namespace SystemAbstractions {
         (void)SetEvent(platform->processorStateChangeEvent);
     }
 
+    void NetworkConnection::Impl::SendMessage(std::vector< uint8_t >&& message) {
+        std::unique_lock< std::recursive_mutex > processingLock(platform->processingMutex);
+        platform->outputQueue.Enqueue(std::move(message));
+        (void)SetEvent(platform->processorStateChangeEvent);
+    }
+
+    void NetworkConnection::Impl::SendMessage(std::shared_ptr< const std::vector< uint8_t > > message) {
+        std::unique_lock< std::recursive_mutex > processingLock(platform->processingMutex);
+        platform->outputQueue.Enqueue(std::move(message));
+        (void)SetEvent(platform->processorStateChangeEvent);
+    }
+
     bool NetworkConnection::Impl::Close(CloseProcedure procedure) {
         if (
             (procedure == CloseProcedure::ImmediateAndStopProcessor)
@@ -329,7 +358,8 @@ namespace SystemAbstractions {
         if (platform->sock != INVALID_SOCKET) {
             if (procedure == CloseProcedure::Graceful) {
                 platform->closing = true;
-                diagnosticsSender.SendDiagnosticInformationString(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+                    diagnosticsSender,
                     1,
                     "closing connection"
                 );
@@ -344,7 +374,8 @@ namespace SystemAbstractions {
 
     void NetworkConnection::Impl::CloseImmediately() {
         platform->CloseImmediately();
-        diagnosticsSender.SendDiagnosticInformationString(
+        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(
+            diagnosticsSender,
             1,
             "closed connection"
         );
@@ -383,6 +414,13 @@ namespace SystemAbstractions {
         }
     }
 
+    bool NetworkConnection::Impl::SetProcessingModel(
+        ProcessingModel processingModel,
+        size_t
+    ) {
+        return (processingModel == ProcessingModel::ThreadPerConnection);
+    }
+
     std::shared_ptr< NetworkConnection > NetworkConnection::Platform::MakeConnectionFromExistingSocket(
         SOCKET sock,
         uint32_t boundAddress,
@@ -86,7 +86,8 @@ namespace SystemAbstractions {
             0
         );
         if (platform->sock == INVALID_SOCKET) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error creating socket (%d)",
                 WSAGetLastError()
@@ -102,7 +103,8 @@ namespace SystemAbstractions {
             struct in_addr multicastInterface;
             multicastInterface.S_un.S_addr = htonl(localAddress);
             if (setsockopt(platform->sock, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&multicastInterface, sizeof(multicastInterface)) == SOCKET_ERROR) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error setting socket option IP_MULTICAST_IF (%d)",
                     WSAGetLastError()
@@ -117,7 +119,8 @@ namespace SystemAbstractions {
             if (mode == NetworkEndpoint::Mode::MulticastReceive) {
                 BOOL option = TRUE;
                 if (setsockopt(platform->sock, SOL_SOCKET, SO_REUSEADDR, (const char*)&option, sizeof(option)) == SOCKET_ERROR) {
-                    diagnosticsSender.SendDiagnosticInformationFormatted(
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
                         SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                         "error setting socket option SO_REUSEADDR (%d)",
                         WSAGetLastError()
@@ -131,7 +134,8 @@ namespace SystemAbstractions {
             }
             socketAddress.sin_port = htons(port);
             if (bind(platform->sock, (struct sockaddr*)&socketAddress, sizeof(socketAddress)) != 0) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error in bind (%d)",
                     WSAGetLastError()
@@ -145,7 +149,8 @@ namespace SystemAbstractions {
                     multicastGroup.imr_multiaddr.S_un.S_addr = htonl(groupAddress);
                     multicastGroup.imr_interface.S_un.S_addr = htonl(localAddress);
                     if (setsockopt(platform->sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const char*)&multicastGroup, sizeof(multicastGroup)) == SOCKET_ERROR) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                             "error setting socket option IP_ADD_MEMBERSHIP (%d) for local interface %" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8,
                             WSAGetLastError(),
@@ -163,7 +168,8 @@ namespace SystemAbstractions {
                 if (getsockname(platform->sock, (struct sockaddr*)&socketAddress, &socketAddressLength) == 0) {
                     port = ntohs(socketAddress.sin_port);
                 } else {
-                    diagnosticsSender.SendDiagnosticInformationFormatted(
+                    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                        diagnosticsSender,
                         SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                         "error in getsockname (%d)",
                         WSAGetLastError()
@@ -178,7 +184,8 @@ namespace SystemAbstractions {
         if (platform->processorStateChangeEvent == NULL) {
             platform->processorStateChangeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
             if (platform->processorStateChangeEvent == NULL) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error creating processor state change event (%d)",
                     (int)GetLastError()
@@ -193,7 +200,8 @@ namespace SystemAbstractions {
         if (platform->socketEvent == NULL) {
             platform->socketEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
             if (platform->socketEvent == NULL) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error creating incoming client event (%d)",
                     (int)GetLastError()
@@ -219,7 +227,8 @@ namespace SystemAbstractions {
             socketEvents |= FD_WRITE;
         }
         if (WSAEventSelect(platform->sock, platform->socketEvent, socketEvents) != 0) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                 "error in WSAEventSelect (%d)",
                 WSAGetLastError()
@@ -231,7 +240,8 @@ namespace SystemAbstractions {
         // If accepting connections, tell socket to start accepting.
         if (mode == NetworkEndpoint::Mode::Connection) {
             if (listen(platform->sock, SOMAXCONN) != 0) {
-                diagnosticsSender.SendDiagnosticInformationFormatted(
+                SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                    diagnosticsSender,
                     SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                     "error in listen (%d)",
                     WSAGetLastError()
@@ -240,7 +250,8 @@ namespace SystemAbstractions {
                 return false;
             }
         }
-        diagnosticsSender.SendDiagnosticInformationFormatted(
+        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+            diagnosticsSender,
             0,
             "endpoint opened for port %" PRIu16,
             port
@@ -269,7 +280,8 @@ namespace SystemAbstractions {
                 if (client == INVALID_SOCKET) {
                     const auto wsaLastError = WSAGetLastError();
                     if (wsaLastError != WSAEWOULDBLOCK) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::WARNING,
                             "error in accept (%d)",
                             WSAGetLastError()
@@ -312,7 +324,8 @@ namespace SystemAbstractions {
                 if (amountReceived == SOCKET_ERROR) {
                     const auto errorCode = WSAGetLastError();
                     if (errorCode != WSAEWOULDBLOCK) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                             "error in recvfrom (%d)",
                             WSAGetLastError()
@@ -346,7 +359,8 @@ namespace SystemAbstractions {
                 if (amountSent == SOCKET_ERROR) {
                     const auto errorCode = WSAGetLastError();
                     if (errorCode != WSAEWOULDBLOCK) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                             "error in sendto (%d)",
                             WSAGetLastError()
@@ -356,7 +370,8 @@ namespace SystemAbstractions {
                     }
                 } else {
                     if (amountSent != (int)packet.body.size()) {
-                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                        SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                            diagnosticsSender,
                             SystemAbstractions::DiagnosticsSender::Levels::ERROR,
                             "send truncated (%d < %d)",
                             amountSent,
@@ -397,7 +412,8 @@ namespace SystemAbstractions {
             platform->outputQueue.clear();
         }
         if (platform->sock != INVALID_SOCKET) {
-            diagnosticsSender.SendDiagnosticInformationFormatted(
+            SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(
+                diagnosticsSender,
                 0,
                 "closing endpoint for port %" PRIu16,
                 port
@@ -0,0 +1,239 @@
+/**
+ * @file WorkStealingPool.cpp
+ *
+ * This module contains the implementation of the
+ * SystemAbstractions::WorkStealingPool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This identifies the pool, if any, to which the current thread
+     * belongs, and which of its threads the current thread is.
+     */
+    thread_local const void* currentPool = nullptr;
+    thread_local size_t currentWorkerIndex = 0;
+
+}
+
+namespace SystemAbstractions {
+
+    /**
+     * This holds the private properties of the WorkStealingPool class.
+     */
+    struct WorkStealingPool::Impl {
+        // Types
+
+        /**
+         * This holds the state of one thread of the pool.
+         */
+        struct Worker {
+            /**
+             * This is the thread running tasks.
+             */
+            std::thread thread;
+
+            /**
+             * These are the tasks submitted to this thread.
+             * The thread itself takes from the back, while other
+             * threads steal from the front.
+             */
+            std::deque< Task > tasks;
+
+            /**
+             * This is used to synchronize access to the tasks.
+             */
+            std::mutex mutex;
+        };
+
+        // Properties
+
+        /**
+         * These are the threads of the pool.
+         */
+        std::vector< std::unique_ptr< Worker > > workers;
+
+        /**
+         * This is the number of tasks submitted but not yet taken
+         * by any thread.
+         */
+        std::atomic< size_t > queued;
+
+        /**
+         * This is the number of tasks submitted but not yet finished.
+         */
+        std::atomic< size_t > pending;
+
+        /**
+         * This is used to pick the thread to which to give the next
+         * task submitted from outside the pool.
+         */
+        std::atomic< size_t > nextWorker;
+
+        /**
+         * This flag indicates whether or not the threads
+         * should stop.
+         */
+        bool stop = false;
+
+        /**
+         * This is used to synchronize threads waiting for tasks
+         * or for all tasks to be finished.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to wake up threads waiting for tasks.
+         */
+        std::condition_variable wakeCondition;
+
+        /**
+         * This is used to wake up threads waiting for all tasks
+         * to be finished.
+         */
+        std::condition_variable doneCondition;
+
+        // Methods
+
+        /**
+         * This is the constructor of the structure.
+         */
+        Impl()
+            : queued(0)
+            , pending(0)
+            , nextWorker(0)
+        {
+        }
+
+        /**
+         * This method takes the next task for the given thread to run,
+         * from its own queue if possible, otherwise stealing one from
+         * another thread's queue.
+         *
+         * @param[in] index
+         *     This is the index of the thread taking the task.
+         *
+         * @param[out] task
+         *     This is where to put the task taken.
+         *
+         * @return
+         *     A flag indicating whether or not a task was taken
+         *     is returned.
+         */
+        bool TakeTask(size_t index, Task& task) {
+            {
+                auto& worker = *workers[index];
+                std::lock_guard< decltype(worker.mutex) > lock(worker.mutex);
+                if (!worker.tasks.empty()) {
+                    task = std::move(worker.tasks.back());
+                    worker.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (size_t i = 1; i < workers.size(); ++i) {
+                auto& victim = *workers[(index + i) % workers.size()];
+                std::lock_guard< decltype(victim.mutex) > lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * This is the function run by each thread of the pool.
+         *
+         * @param[in] index
+         *     This is the index of the thread.
+         */
+        void Work(size_t index) {
+            currentPool = this;
+            currentWorkerIndex = index;
+            for (;;) {
+                Task task;
+                if (TakeTask(index, task)) {
+                    --queued;
+                    task();
+                    task = nullptr;
+                    if (--pending == 0) {
+                        std::lock_guard< decltype(mutex) > lock(mutex);
+                        doneCondition.notify_all();
+                    }
+                    continue;
+                }
+                std::unique_lock< decltype(mutex) > lock(mutex);
+                wakeCondition.wait(
+                    lock,
+                    [this]{ return stop || (queued > 0); }
+                );
+                if (stop) {
+                    break;
+                }
+            }
+        }
+    };
+
+    WorkStealingPool::~WorkStealingPool() noexcept {
+        {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            impl_->stop = true;
+            impl_->wakeCondition.notify_all();
+        }
+        for (auto& worker: impl_->workers) {
+            worker->thread.join();
+        }
+    }
+
+    WorkStealingPool::WorkStealingPool(size_t numThreads)
+        : impl_(new Impl())
+    {
+        numThreads = std::max(numThreads, (size_t)1);
+        for (size_t i = 0; i < numThreads; ++i) {
+            impl_->workers.emplace_back(new Impl::Worker());
+        }
+        for (size_t i = 0; i < numThreads; ++i) {
+            impl_->workers[i]->thread = std::thread(&Impl::Work, impl_.get(), i);
+        }
+    }
+
+    void WorkStealingPool::Submit(Task task) {
+        size_t index;
+        if (currentPool == impl_.get()) {
+            index = currentWorkerIndex;
+        } else {
+            index = (impl_->nextWorker++ % impl_->workers.size());
+        }
+        ++impl_->pending;
+        ++impl_->queued;
+        {
+            auto& worker = *impl_->workers[index];
+            std::lock_guard< decltype(worker.mutex) > lock(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+        }
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->wakeCondition.notify_one();
+    }
+
+    void WorkStealingPool::Wait() {
+        std::unique_lock< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->doneCondition.wait(
+            lock,
+            [this]{ return (impl_->pending == 0); }
+        );
+    }
+
+}
@@ -0,0 +1,92 @@
+#ifndef SYSTEM_ABSTRACTIONS_WORK_STEALING_POOL_HPP
+#define SYSTEM_ABSTRACTIONS_WORK_STEALING_POOL_HPP
+
+/**
+ * @file WorkStealingPool.hpp
+ *
+ * This module declares the SystemAbstractions::WorkStealingPool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+
+namespace SystemAbstractions {
+
+    /**
+     * This class runs tasks in a fixed set of threads, where tasks may
+     * themselves submit more tasks, such as when walking a tree.
+     *
+     * Each thread has its own queue of tasks.  Tasks submitted from
+     * a thread of the pool go onto that thread's own queue, and it runs
+     * the most recently submitted ones first, which keeps the amount of
+     * work in progress small, like a depth-first walk.  A thread whose
+     * queue is empty steals the oldest task from another thread's queue,
+     * which tends to be the one representing the most work.
+     *
+     * All methods are thread-safe.
+     */
+    class WorkStealingPool {
+        // Types
+    public:
+        /**
+         * This is the type of function run by the pool.
+         */
+        typedef std::function< void() > Task;
+
+        // Lifecycle management
+    public:
+        ~WorkStealingPool() noexcept;
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool(WorkStealingPool&&) noexcept = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(WorkStealingPool&&) noexcept = delete;
+
+        // Public methods
+    public:
+        /**
+         * This is the instance constructor.
+         *
+         * @param[in] numThreads
+         *     This is the number of threads to run tasks.
+         *     At least one thread is always started.
+         */
+        explicit WorkStealingPool(size_t numThreads);
+
+        /**
+         * This method adds a task to be run by the pool.
+         *
+         * @param[in] task
+         *     This is the task to run.
+         */
+        void Submit(Task task);
+
+        /**
+         * This method blocks until all tasks submitted to the pool,
+         * including any submitted by other tasks, have been run.
+         *
+         * @note
+         *     This must not be called from a task.
+         */
+        void Wait();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* SYSTEM_ABSTRACTIONS_WORK_STEALING_POOL_HPP */
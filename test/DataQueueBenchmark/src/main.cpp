@@ -0,0 +1,245 @@
+/**
+ * @file main.cpp
+ *
+ * This module contains a program which measures the throughput and
+ * memory allocations of the SystemAbstractions::DataQueue class, for
+ * various patterns of usage.
+ *
+ * Usage: DataQueueBenchmark [SCALE]
+ *
+ * SCALE multiplies the amount of data put through each scenario
+ * (default 1).
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <DataQueue.hpp>
+#include <functional>
+#include <inttypes.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    /**
+     * This counts the number of times memory has been allocated
+     * through the global allocation operators.
+     */
+    std::atomic< uint64_t > allocations(0);
+
+    /**
+     * This is the largest size of message the connection send path
+     * hands to the operating system at once.
+     */
+    constexpr size_t MAXIMUM_WRITE_SIZE = 65536;
+
+    /**
+     * This is the largest number of segments the connection send path
+     * hands to the operating system at once.
+     */
+    constexpr size_t MAXIMUM_WRITE_SEGMENTS = 64;
+
+    /**
+     * This is the function type of one benchmark scenario.
+     *
+     * @param[in] q
+     *     This is the queue to exercise.
+     *
+     * @param[in] scale
+     *     This multiplies the amount of data put through the scenario.
+     *
+     * @return
+     *     The number of bytes put through the queue is returned.
+     */
+    typedef std::function< size_t(SystemAbstractions::DataQueue& q, size_t scale) > Scenario;
+
+    /**
+     * This scenario enqueues many tiny buffers, and dequeues them
+     * in medium-sized pieces which span many buffers, and which
+     * mostly end partway through a buffer.
+     */
+    size_t TinyWrites(SystemAbstractions::DataQueue& q, size_t scale) {
+        const SystemAbstractions::DataQueue::Buffer message(16, 'X');
+        size_t bytes = 0;
+        for (size_t round = 0; round < 1000 * scale; ++round) {
+            for (size_t i = 0; i < 256; ++i) {
+                q.Enqueue(message);
+            }
+            while (q.GetBytesQueued() > 0) {
+                bytes += q.Dequeue(1000).size();
+            }
+        }
+        return bytes;
+    }
+
+    /**
+     * This scenario moves large buffers into the queue, and dequeues
+     * each of them whole.
+     */
+    size_t LargeWrites(SystemAbstractions::DataQueue& q, size_t scale) {
+        size_t bytes = 0;
+        SystemAbstractions::DataQueue::Buffer message(MAXIMUM_WRITE_SIZE, 'X');
+        for (size_t round = 0; round < 2000 * scale; ++round) {
+            q.Enqueue(std::move(message));
+            message = q.Dequeue(MAXIMUM_WRITE_SIZE);
+            bytes += message.size();
+        }
+        return bytes;
+    }
+
+    /**
+     * This scenario imitates the connection send path, which peeks
+     * at segments of the queue to write them, and then drops
+     * whatever was actually written, which is not always everything.
+     */
+    size_t PeekThenDrop(SystemAbstractions::DataQueue& q, size_t scale) {
+        const SystemAbstractions::DataQueue::Buffer message(1000, 'X');
+        std::vector< SystemAbstractions::DataQueue::Segment > segments;
+        size_t bytes = 0;
+        for (size_t round = 0; round < 2000 * scale; ++round) {
+            for (size_t i = 0; i < 100; ++i) {
+                q.Enqueue(message);
+            }
+            while (q.GetBytesQueued() > 0) {
+                const auto bytesPeeked = q.PeekSegments(
+                    segments,
+                    MAXIMUM_WRITE_SIZE,
+                    MAXIMUM_WRITE_SEGMENTS
+                );
+                const auto bytesWritten = (bytesPeeked * 3 + 3) / 4;
+                q.Drop(bytesWritten);
+                bytes += bytesWritten;
+            }
+        }
+        return bytes;
+    }
+
+    /**
+     * This scenario drops part of each buffer, as the connection send
+     * path does after a short write, and then dequeues pieces which
+     * start partway through one buffer and end partway through the next.
+     */
+    size_t DropThenDequeue(SystemAbstractions::DataQueue& q, size_t scale) {
+        const SystemAbstractions::DataQueue::Buffer message(1000, 'X');
+        size_t bytes = 0;
+        for (size_t round = 0; round < 2000 * scale; ++round) {
+            for (size_t i = 0; i < 100; ++i) {
+                q.Enqueue(message);
+            }
+            while (q.GetBytesQueued() > 0) {
+                const auto bytesDropped = std::min(q.GetBytesQueued(), (size_t)300);
+                q.Drop(bytesDropped);
+                bytes += bytesDropped;
+                bytes += q.Dequeue(1000).size();
+            }
+        }
+        return bytes;
+    }
+
+    /**
+     * This scenario enqueues a large number of small buffers, and
+     * dequeues all of them at once.
+     */
+    size_t BatchedDequeue(SystemAbstractions::DataQueue& q, size_t scale) {
+        const SystemAbstractions::DataQueue::Buffer message(1000, 'X');
+        size_t bytes = 0;
+        for (size_t round = 0; round < 200 * scale; ++round) {
+            for (size_t i = 0; i < 1000; ++i) {
+                q.Enqueue(message);
+            }
+            bytes += q.Dequeue(q.GetBytesQueued()).size();
+        }
+        return bytes;
+    }
+
+    /**
+     * This runs one benchmark scenario against a queue in the given mode,
+     * and reports the results.
+     *
+     * @param[in] name
+     *     This is the name of the scenario to report.
+     *
+     * @param[in] scenario
+     *     This is the scenario to run.
+     *
+     * @param[in] mode
+     *     This is the mode of the queue to exercise.
+     *
+     * @param[in] scale
+     *     This multiplies the amount of data put through the scenario.
+     */
+    void Run(
+        const std::string& name,
+        Scenario scenario,
+        SystemAbstractions::DataQueue::Mode mode,
+        size_t scale
+    ) {
+        SystemAbstractions::DataQueue q(mode);
+        const auto allocationsBefore = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        const auto bytes = scenario(q, scale);
+        const auto end = std::chrono::steady_clock::now();
+        const auto allocationsDuring = allocations.load() - allocationsBefore;
+        const auto seconds = std::chrono::duration< double >(end - start).count();
+        (void)printf(
+            "%-16s %-8s %10.1f MiB/s %12" PRIu64 " allocations %10.2f allocations/KiB\n",
+            name.c_str(),
+            (mode == SystemAbstractions::DataQueue::Mode::Ring) ? "Ring" : "Buffers",
+            (double)bytes / 1048576.0 / seconds,
+            allocationsDuring,
+            (double)allocationsDuring * 1024.0 / (double)bytes
+        );
+    }
+
+}
+
+void* operator new(size_t size) {
+    ++allocations;
+    const auto memory = malloc(size ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+int main(int argc, char* argv[]) {
+    size_t scale = 1;
+    if (argc >= 2) {
+        scale = (size_t)strtoul(argv[1], NULL, 10);
+        if (scale == 0) {
+            (void)fprintf(stderr, "usage: DataQueueBenchmark [SCALE]\n");
+            return EXIT_FAILURE;
+        }
+    }
+    const std::vector< std::pair< std::string, Scenario > > scenarios{
+        {"TinyWrites", TinyWrites},
+        {"LargeWrites", LargeWrites},
+        {"PeekThenDrop", PeekThenDrop},
+        {"DropThenDequeue", DropThenDequeue},
+        {"BatchedDequeue", BatchedDequeue},
+    };
+    for (const auto& scenario: scenarios) {
+        for (const auto mode: {
+            SystemAbstractions::DataQueue::Mode::Buffers,
+            SystemAbstractions::DataQueue::Mode::Ring,
+        }) {
+            Run(scenario.first, scenario.second, mode, scale);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file BufferPoolTests.cpp
+ *
+ * This module contains the unit tests of the
+ * SystemAbstractions::BufferPool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <BufferPool.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+TEST(BufferPoolTests, AcquireNewBuffer) {
+    // Arrange
+    SystemAbstractions::BufferPool pool(1000, 2);
+
+    // Act
+    const auto buffer = pool.Acquire();
+
+    // Assert
+    ASSERT_FALSE(buffer == nullptr);
+    EXPECT_GE(buffer->capacity(), 1000);
+    EXPECT_EQ(0, pool.GetBuffersPooled());
+}
+
+TEST(BufferPoolTests, ReleasedBufferIsReused) {
+    // Arrange
+    SystemAbstractions::BufferPool pool(1000, 2);
+    auto buffer = pool.Acquire();
+    buffer->assign(10, 'X');
+    const auto bufferMemory = buffer->data();
+
+    // Act
+    buffer = nullptr;
+    const auto poolSizeAfterRelease = pool.GetBuffersPooled();
+    buffer = pool.Acquire();
+
+    // Assert
+    EXPECT_EQ(1, poolSizeAfterRelease);
+    EXPECT_EQ(0, pool.GetBuffersPooled());
+    EXPECT_EQ(bufferMemory, buffer->data());
+}
+
+TEST(BufferPoolTests, PoolSizeIsLimited) {
+    // Arrange
+    SystemAbstractions::BufferPool pool(1000, 2);
+    std::vector< std::shared_ptr< SystemAbstractions::BufferPool::Buffer > > buffers;
+    for (size_t i = 0; i < 3; ++i) {
+        buffers.push_back(pool.Acquire());
+    }
+
+    // Act
+    buffers.clear();
+
+    // Assert
+    EXPECT_EQ(2, pool.GetBuffersPooled());
+}
+
+TEST(BufferPoolTests, ReleaseFromAnotherThreadAfterPoolDestroyed) {
+    // Arrange
+    std::shared_ptr< SystemAbstractions::BufferPool::Buffer > buffer;
+    {
+        SystemAbstractions::BufferPool pool(1000, 2);
+        buffer = pool.Acquire();
+    }
+
+    // Act
+    std::thread releaser(
+        [&buffer]{
+            buffer = nullptr;
+        }
+    );
+    releaser.join();
+
+    // Assert
+    EXPECT_TRUE(buffer == nullptr);
+}
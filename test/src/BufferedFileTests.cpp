@@ -0,0 +1,272 @@
+/**
+ * @file BufferedFileTests.cpp
+ *
+ * This module contains the unit tests of the
+ * SystemAbstractions::BufferedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <SystemAbstractions/BufferedFile.hpp>
+#include <SystemAbstractions/StringFile.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is a file which wraps a StringFile, counting the number of
+     * times data is read from or written to it.
+     */
+    struct CountingFile
+        : public SystemAbstractions::IFile
+    {
+        // Properties
+
+        /**
+         * This is the file being wrapped.
+         */
+        SystemAbstractions::StringFile contents;
+
+        /**
+         * This is the number of times data was read from the file.
+         */
+        mutable size_t reads = 0;
+
+        /**
+         * This is the number of times data was written to the file.
+         */
+        size_t writes = 0;
+
+        /**
+         * This is the most bytes the file will accept from any
+         * one write, used to simulate write errors.
+         */
+        size_t writeLimit = SIZE_MAX;
+
+        // IFile
+
+        virtual uint64_t GetSize() const override {
+            return contents.GetSize();
+        }
+
+        virtual bool SetSize(uint64_t size) override {
+            return contents.SetSize(size);
+        }
+
+        virtual uint64_t GetPosition() const override {
+            return contents.GetPosition();
+        }
+
+        virtual void SetPosition(uint64_t position) override {
+            contents.SetPosition(position);
+        }
+
+        virtual size_t Peek(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) const override {
+            ++reads;
+            return contents.Peek(buffer, numBytes, offset);
+        }
+
+        virtual size_t Peek(void* buffer, size_t numBytes) const override {
+            ++reads;
+            return contents.Peek(buffer, numBytes);
+        }
+
+        virtual size_t Read(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override {
+            ++reads;
+            return contents.Read(buffer, numBytes, offset);
+        }
+
+        virtual size_t Read(void* buffer, size_t numBytes) override {
+            ++reads;
+            return contents.Read(buffer, numBytes);
+        }
+
+        virtual size_t Write(const Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override {
+            ++writes;
+            return contents.Write(buffer, numBytes, offset);
+        }
+
+        virtual size_t Write(const void* buffer, size_t numBytes) override {
+            ++writes;
+            return contents.Write(buffer, numBytes);
+        }
+
+        virtual size_t ReadAt(uint64_t position, void* buffer, size_t numBytes) const override {
+            ++reads;
+            return contents.ReadAt(position, buffer, numBytes);
+        }
+
+        virtual size_t WriteAt(uint64_t position, const void* buffer, size_t numBytes) override {
+            ++writes;
+            return contents.WriteAt(position, buffer, std::min(numBytes, writeLimit));
+        }
+
+        virtual std::shared_ptr< IFile > Clone() override {
+            auto clone = std::make_shared< CountingFile >();
+            clone->contents = (std::string)contents;
+            return clone;
+        }
+    };
+
+}
+
+TEST(BufferedFileTests, SmallReadsServedFromBuffer) {
+    const auto file = std::make_shared< CountingFile >();
+    std::string testString;
+    for (size_t i = 0; i < 100; ++i) {
+        testString += "record" + std::to_string(i) + "\n";
+    }
+    file->contents = testString;
+    SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+    std::string readBack;
+    char c;
+    while (bufferedFile.Read(&c, 1) == 1) {
+        readBack.push_back(c);
+    }
+    EXPECT_EQ(testString, readBack);
+    EXPECT_EQ(testString.length(), bufferedFile.GetPosition());
+    EXPECT_EQ(2, file->reads); // one to fill buffer, one to discover end
+}
+
+TEST(BufferedFileTests, PeekAndSetPositionServedFromBuffer) {
+    const auto file = std::make_shared< CountingFile >();
+    file->contents = "Hello, World!";
+    SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+    SystemAbstractions::IFile::Buffer buffer(5);
+    ASSERT_EQ(5, bufferedFile.Peek(buffer));
+    EXPECT_EQ("Hello", std::string(buffer.begin(), buffer.end()));
+    EXPECT_EQ(0, bufferedFile.GetPosition());
+    bufferedFile.SetPosition(7);
+    ASSERT_EQ(5, bufferedFile.Read(buffer));
+    EXPECT_EQ("World", std::string(buffer.begin(), buffer.end()));
+    EXPECT_EQ(12, bufferedFile.GetPosition());
+    bufferedFile.SetPosition(0);
+    ASSERT_EQ(5, bufferedFile.Read(buffer));
+    EXPECT_EQ("Hello", std::string(buffer.begin(), buffer.end()));
+    EXPECT_EQ(1, file->reads);
+}
+
+TEST(BufferedFileTests, LargeReadBypassesBuffer) {
+    const auto file = std::make_shared< CountingFile >();
+    const std::string testString(100, 'x');
+    file->contents = testString;
+    SystemAbstractions::BufferedFile bufferedFile(file, 16);
+    SystemAbstractions::IFile::Buffer buffer(testString.length() + 10);
+    ASSERT_EQ(testString.length(), bufferedFile.Read(buffer));
+    EXPECT_EQ(testString, std::string(buffer.begin(), buffer.begin() + testString.length()));
+    EXPECT_EQ(1, file->reads);
+}
+
+TEST(BufferedFileTests, SmallWritesHeldInBuffer) {
+    const auto file = std::make_shared< CountingFile >();
+    SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+    std::string testString;
+    for (size_t i = 0; i < 100; ++i) {
+        const auto record = "record" + std::to_string(i) + "\n";
+        ASSERT_EQ(record.length(), bufferedFile.Write(record.data(), record.length()));
+        testString += record;
+    }
+    EXPECT_EQ(0, file->writes);
+    EXPECT_EQ(testString.length(), bufferedFile.GetSize());
+    EXPECT_EQ(testString.length(), bufferedFile.GetPosition());
+    ASSERT_TRUE(bufferedFile.Flush());
+    EXPECT_EQ(1, file->writes);
+    EXPECT_EQ(testString, (std::string)file->contents);
+}
+
+TEST(BufferedFileTests, WritesFlushedWhenBufferFills) {
+    const auto file = std::make_shared< CountingFile >();
+    SystemAbstractions::BufferedFile bufferedFile(file, 10);
+    for (size_t i = 0; i < 5; ++i) {
+        ASSERT_EQ(4, bufferedFile.Write("abcd", 4));
+    }
+    EXPECT_EQ(2, file->writes);
+    EXPECT_EQ("abcdabcdabcdabcd", (std::string)file->contents);
+    ASSERT_TRUE(bufferedFile.Flush());
+    EXPECT_EQ("abcdabcdabcdabcdabcd", (std::string)file->contents);
+}
+
+TEST(BufferedFileTests, WritesFlushedBeforeReadAndOnDestruction) {
+    const auto file = std::make_shared< CountingFile >();
+    file->contents = "Hello, World!";
+    {
+        SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+        bufferedFile.SetPosition(7);
+        ASSERT_EQ(5, bufferedFile.Write("Bobby", 5));
+        bufferedFile.SetPosition(0);
+        SystemAbstractions::IFile::Buffer buffer(13);
+        ASSERT_EQ(13, bufferedFile.Read(buffer));
+        EXPECT_EQ("Hello, Bobby!", std::string(buffer.begin(), buffer.end()));
+        bufferedFile.SetPosition(0);
+        ASSERT_EQ(1, bufferedFile.Write("J", 1));
+        EXPECT_EQ("Hello, Bobby!", (std::string)file->contents);
+    }
+    EXPECT_EQ("Jello, Bobby!", (std::string)file->contents);
+}
+
+TEST(BufferedFileTests, WritesFlushedOnMoveAssignment) {
+    const auto file = std::make_shared< CountingFile >();
+    const auto otherFile = std::make_shared< CountingFile >();
+    SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+    SystemAbstractions::BufferedFile otherBufferedFile(otherFile, 1024);
+    ASSERT_EQ(5, bufferedFile.Write("Hello", 5));
+    EXPECT_EQ(0, file->GetSize());
+    bufferedFile = std::move(otherBufferedFile);
+    EXPECT_EQ("Hello", (std::string)file->contents);
+    ASSERT_EQ(5, bufferedFile.Write("World", 5));
+    ASSERT_TRUE(bufferedFile.Flush());
+    EXPECT_EQ("World", (std::string)otherFile->contents);
+}
+
+TEST(BufferedFileTests, WriteElsewhereFlushesFirst) {
+    const auto file = std::make_shared< CountingFile >();
+    SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+    ASSERT_EQ(5, bufferedFile.Write("Hello", 5));
+    bufferedFile.SetPosition(10);
+    ASSERT_EQ(5, bufferedFile.Write("World", 5));
+    EXPECT_EQ(1, file->writes);
+    ASSERT_TRUE(bufferedFile.Flush());
+    EXPECT_EQ(2, file->writes);
+    EXPECT_EQ(
+        std::string("Hello\0\0\0\0\0World", 15),
+        (std::string)file->contents
+    );
+}
+
+TEST(BufferedFileTests, Clone) {
+    const auto file = std::make_shared< CountingFile >();
+    SystemAbstractions::BufferedFile bufferedFile(file);
+    ASSERT_EQ(5, bufferedFile.Write("Hello", 5));
+    const auto clone = bufferedFile.Clone();
+    ASSERT_FALSE(clone == nullptr);
+    EXPECT_EQ(0, clone->GetPosition());
+    SystemAbstractions::IFile::Buffer buffer(5);
+    ASSERT_EQ(5, clone->Read(buffer));
+    EXPECT_EQ("Hello", std::string(buffer.begin(), buffer.end()));
+}
+
+TEST(BufferedFileTests, FailedWriteKeptInBuffer) {
+    const auto file = std::make_shared< CountingFile >();
+    file->contents = "Hello, World!";
+    SystemAbstractions::BufferedFile bufferedFile(file, 1024);
+    bufferedFile.SetPosition(7);
+    ASSERT_EQ(5, bufferedFile.Write("Bobby", 5));
+    file->writeLimit = 2;
+    EXPECT_FALSE(bufferedFile.Flush());
+    EXPECT_EQ("Hello, Borld!", (std::string)file->contents);
+    file->writeLimit = 0;
+    SystemAbstractions::IFile::Buffer buffer(13);
+    bufferedFile.SetPosition(0);
+    EXPECT_EQ(9, bufferedFile.Read(buffer));
+    bufferedFile.SetPosition(0);
+    EXPECT_EQ(0, bufferedFile.Write("J", 1));
+    EXPECT_TRUE(bufferedFile.Clone() == nullptr);
+    file->writeLimit = SIZE_MAX;
+    EXPECT_TRUE(bufferedFile.Flush());
+    EXPECT_EQ("Hello, Bobby!", (std::string)file->contents);
+}
@@ -9,6 +9,7 @@
 
 #include <DataQueue.hpp>
 #include <gtest/gtest.h>
+#include <memory>
 #include <stdint.h>
 #include <vector>
 
@@ -42,6 +43,43 @@ TEST(DataQueueTests, EnqueueMove) {
     EXPECT_EQ(15000, q.GetBytesQueued());
 }
 
+TEST(DataQueueTests, EnqueueShared) {
+    // Arrange
+    SystemAbstractions::DataQueue q;
+    const auto data = std::make_shared< const std::vector< uint8_t > >(10, 'X');
+
+    // Act
+    q.Enqueue(data);
+    q.Enqueue(data);
+    const auto firstDequeue = q.Dequeue(10);
+    const auto secondDequeue = q.Dequeue(4);
+
+    // Assert
+    EXPECT_EQ(*data, firstDequeue);
+    EXPECT_EQ(
+        "XXXX",
+        std::string(secondDequeue.begin(), secondDequeue.end())
+    );
+    EXPECT_EQ(10, data->size());
+    EXPECT_EQ(1, q.GetBuffersQueued());
+    EXPECT_EQ(6, q.GetBytesQueued());
+}
+
+TEST(DataQueueTests, EnqueueSharedNullIgnored) {
+    // Arrange
+    SystemAbstractions::DataQueue q;
+    SystemAbstractions::DataQueue ring(SystemAbstractions::DataQueue::Mode::Ring);
+
+    // Act
+    q.Enqueue(std::shared_ptr< const std::vector< uint8_t > >());
+    ring.Enqueue(std::shared_ptr< const std::vector< uint8_t > >());
+
+    // Assert
+    EXPECT_EQ(0, q.GetBuffersQueued());
+    EXPECT_EQ(0, q.GetBytesQueued());
+    EXPECT_EQ(0, ring.GetBytesQueued());
+}
+
 TEST(DataQueueTests, DequeuePartialBuffer) {
     // Arrange
     SystemAbstractions::DataQueue q;
@@ -252,6 +290,168 @@ TEST(DataQueueTests, DropFullBufferPlusPartialNextBuffer) {
     EXPECT_EQ(3, q.GetBytesQueued());
 }
 
+TEST(DataQueueTests, PeekSegmentsAfterPartialDrop) {
+    // Arrange
+    SystemAbstractions::DataQueue q;
+    std::vector< uint8_t > data(10, 'X');
+    q.Enqueue(data);
+    data.assign(5, 'Y');
+    q.Enqueue(data);
+    q.Drop(8);
+    std::vector< SystemAbstractions::DataQueue::Segment > segments;
+
+    // Act
+    const auto bytesProvided = q.PeekSegments(segments, 6, 16);
+
+    // Assert
+    EXPECT_EQ(6, bytesProvided);
+    ASSERT_EQ(2, segments.size());
+    EXPECT_EQ(
+        "XX",
+        std::string(segments[0].data, segments[0].data + segments[0].size)
+    );
+    EXPECT_EQ(
+        "YYYY",
+        std::string(segments[1].data, segments[1].data + segments[1].size)
+    );
+    EXPECT_EQ(2, q.GetBuffersQueued());
+    EXPECT_EQ(7, q.GetBytesQueued());
+}
+
+TEST(DataQueueTests, PeekSegmentsLimitedByNumberOfSegments) {
+    // Arrange
+    SystemAbstractions::DataQueue q;
+    std::vector< uint8_t > data(10, 'X');
+    q.Enqueue(data);
+    data.assign(5, 'Y');
+    q.Enqueue(data);
+    data.assign(3, 'Z');
+    q.Enqueue(data);
+    std::vector< SystemAbstractions::DataQueue::Segment > segments;
+
+    // Act
+    const auto bytesProvided = q.PeekSegments(segments, 100, 2);
+
+    // Assert
+    EXPECT_EQ(15, bytesProvided);
+    ASSERT_EQ(2, segments.size());
+    EXPECT_EQ(10, segments[0].size);
+    EXPECT_EQ(5, segments[1].size);
+    EXPECT_EQ(18, q.GetBytesQueued());
+}
+
+TEST(DataQueueTests, PeekContiguous) {
+    // Arrange
+    SystemAbstractions::DataQueue q;
+    std::vector< uint8_t > data(10, 'X');
+    q.Enqueue(data);
+    data.assign(5, 'Y');
+    q.Enqueue(data);
+    q.Drop(8);
+
+    // Act
+    const auto segment = q.PeekContiguous();
+
+    // Assert
+    EXPECT_EQ(
+        "XX",
+        std::string(segment.data, segment.data + segment.size)
+    );
+}
+
+TEST(DataQueueTests, PeekContiguousEmpty) {
+    // Arrange
+    SystemAbstractions::DataQueue q;
+    SystemAbstractions::DataQueue ringQ(SystemAbstractions::DataQueue::Mode::Ring);
+
+    // Act
+    const auto segment = q.PeekContiguous();
+    const auto ringSegment = ringQ.PeekContiguous();
+
+    // Assert
+    EXPECT_EQ(0, segment.size);
+    EXPECT_EQ(0, ringSegment.size);
+}
+
+TEST(DataQueueTests, RingEnqueueAndDequeue) {
+    // Arrange
+    SystemAbstractions::DataQueue q(SystemAbstractions::DataQueue::Mode::Ring);
+    std::vector< uint8_t > data(10, 'X');
+    q.Enqueue(data);
+    data.assign(5, 'Y');
+    q.Enqueue(std::move(data));
+    q.Enqueue(std::make_shared< const std::vector< uint8_t > >(3, 'Z'));
+
+    // Act
+    const auto peeked = q.Peek(12);
+    const auto dequeued = q.Dequeue(12);
+
+    // Assert
+    EXPECT_EQ(
+        "XXXXXXXXXXYY",
+        std::string(peeked.begin(), peeked.end())
+    );
+    EXPECT_EQ(peeked, dequeued);
+    EXPECT_EQ(1, q.GetBuffersQueued());
+    EXPECT_EQ(6, q.GetBytesQueued());
+    const auto segment = q.PeekContiguous();
+    EXPECT_EQ(
+        "YYYZZZ",
+        std::string(segment.data, segment.data + segment.size)
+    );
+}
+
+TEST(DataQueueTests, RingWrapsAround) {
+    // Arrange
+    SystemAbstractions::DataQueue q(SystemAbstractions::DataQueue::Mode::Ring);
+    std::vector< uint8_t > data(3000, 'X');
+    q.Enqueue(data);
+    q.Drop(2000);
+    data.assign(2000, 'Y');
+    q.Enqueue(data);
+    std::vector< SystemAbstractions::DataQueue::Segment > segments;
+
+    // Act
+    const auto bytesProvided = q.PeekSegments(segments, 3000, 16);
+    const auto firstSegment = q.PeekContiguous();
+    const auto dequeued = q.Dequeue(3000);
+
+    // Assert
+    EXPECT_EQ(3000, bytesProvided);
+    ASSERT_EQ(2, segments.size());
+    EXPECT_EQ(segments[0].data, firstSegment.data);
+    EXPECT_EQ(segments[0].size, firstSegment.size);
+    EXPECT_EQ(3000, segments[0].size + segments[1].size);
+    EXPECT_EQ(
+        std::string(1000, 'X') + std::string(2000, 'Y'),
+        std::string(dequeued.begin(), dequeued.end())
+    );
+    EXPECT_EQ(0, q.GetBuffersQueued());
+    EXPECT_EQ(0, q.GetBytesQueued());
+}
+
+TEST(DataQueueTests, RingGrowsWhileWrappedAround) {
+    // Arrange
+    SystemAbstractions::DataQueue q(SystemAbstractions::DataQueue::Mode::Ring);
+    std::vector< uint8_t > data(3000, 'X');
+    q.Enqueue(data);
+    q.Drop(2000);
+    data.assign(2000, 'Y');
+    q.Enqueue(data);
+
+    // Act
+    data.assign(5000, 'Z');
+    q.Enqueue(data);
+    const auto dequeued = q.Dequeue(8000);
+
+    // Assert
+    EXPECT_EQ(
+        std::string(1000, 'X') + std::string(2000, 'Y') + std::string(5000, 'Z'),
+        std::string(dequeued.begin(), dequeued.end())
+    );
+    EXPECT_EQ(0, q.GetBytesQueued());
+}
+
 // This recreates a specific bug in Dequeue, where a local variable
 // tracking the number of remaining bytes in the queue was subtracted
 // by the wrong value, causing the actual number of bytes returned
@@ -0,0 +1,325 @@
+/**
+ * @file DiagnosticsBinaryLogTests.cpp
+ *
+ * This module contains the unit tests of the
+ * SystemAbstractions::DiagnosticsBinaryLogReporter and
+ * SystemAbstractions::DecodeDiagnosticsBinaryLog functions.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <float.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <StringExtensions/StringExtensions.hpp>
+#include <SystemAbstractions/DiagnosticsBinaryLog.hpp>
+#include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <SystemAbstractions/File.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is used to store a message decoded from a binary log.
+     */
+    struct DecodedMessage {
+        /**
+         * This identifies the origin of the diagnostic information.
+         */
+        std::string senderName;
+
+        /**
+         * This is used to filter out less-important information.
+         * The level is higher the more important the information is.
+         */
+        size_t level;
+
+        /**
+         * This is the content of the message.
+         */
+        std::string message;
+    };
+
+    /**
+     * This function decodes the binary log at the given path.
+     *
+     * @param[in] path
+     *     This is the path to the binary log to decode.
+     *
+     * @param[out] messages
+     *     This is where to put the messages decoded.
+     *
+     * @return
+     *     An indication of whether or not the whole binary log
+     *     was decoded successfully is returned.
+     */
+    bool DecodeLog(
+        const std::string& path,
+        std::vector< DecodedMessage >& messages
+    ) {
+        const auto log = fopen(path.c_str(), "rb");
+        if (log == NULL) {
+            return false;
+        }
+        const auto decoded = SystemAbstractions::DecodeDiagnosticsBinaryLog(
+            log,
+            [&messages](
+                double time,
+                const std::string& senderName,
+                size_t level,
+                const std::string& message
+            ){
+                EXPECT_GE(time, 0.0);
+                messages.push_back({senderName, level, message});
+            }
+        );
+        (void)fclose(log);
+        return decoded;
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct DiagnosticsBinaryLogTests
+    : public ::testing::Test
+{
+    // Properties
+
+    /**
+     * This is the temporary directory to use to test
+     * the binary log.
+     */
+    std::string testAreaPath;
+
+    // Methods
+
+    // ::testing::Test
+
+    virtual void SetUp() {
+        testAreaPath = SystemAbstractions::File::GetExeParentDirectory() + "/TestArea";
+        ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath));
+    }
+
+    virtual void TearDown() {
+        ASSERT_TRUE(SystemAbstractions::File::DeleteDirectory(testAreaPath));
+    }
+};
+
+TEST_F(DiagnosticsBinaryLogTests, RecordAndDecodeMessages) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    SystemAbstractions::DiagnosticsSender foo("foo");
+    SystemAbstractions::DiagnosticsSender bar("bar");
+    const auto reporter = SystemAbstractions::DiagnosticsBinaryLogReporter(log);
+    const auto unsubscribeFoo = foo.SubscribeToRawDiagnostics(reporter);
+    const auto unsubscribeBar = bar.SubscribeToRawDiagnostics(reporter, 2);
+    foo.SendDiagnosticInformationString(0, "hello");
+    foo.SendDiagnosticInformationFormatted(
+        1,
+        "%d %+5i %hhd %hu %ld %llu %zu %td %jd %x %#o %c %% %s",
+        -42, 7, 300, 70000, -1234567890L, 12345678901234ULL,
+        (size_t)99, (ptrdiff_t)-5, (intmax_t)77, 0xbeefu, 8u, 'z', "end"
+    );
+    foo.SendDiagnosticInformationFormatted(
+        1,
+        "%.3f %e %g %Lf [%*d] [%-*.*s] %s",
+        3.14159, 1.0e10, 0.5, (long double)2.5, 6, 42, 8, 3, "abcdef", (const char*)NULL
+    );
+    foo.PushContext("ctx");
+    foo.SendDiagnosticInformationFormatted(5, "value is %d", 10);
+    foo.PushContext("inner");
+    foo.SendDiagnosticInformationString(5, "nested");
+    foo.PopContext();
+    foo.PopContext();
+    bar.SendDiagnosticInformationFormatted(1, "filtered out %d", 1);
+    bar.SendDiagnosticInformationFormatted(10, "value is %d", 11);
+    unsubscribeFoo();
+    unsubscribeBar();
+    foo.SendDiagnosticInformationString(10, "after unsubscribing");
+    (void)fclose(log);
+
+    std::vector< DecodedMessage > messages;
+    ASSERT_TRUE(DecodeLog(logPath, messages));
+    ASSERT_EQ(6, messages.size());
+    EXPECT_EQ("foo", messages[0].senderName);
+    EXPECT_EQ(0, messages[0].level);
+    EXPECT_EQ("hello", messages[0].message);
+    EXPECT_EQ(
+        "-42    +7 44 4464 -1234567890 12345678901234 99 -5 77 beef 010 z % end",
+        messages[1].message
+    );
+    EXPECT_EQ(
+        "3.142 1.000000e+10 0.5 2.500000 [    42] [abc     ] (null)",
+        messages[2].message
+    );
+    EXPECT_EQ("ctx: value is 10", messages[3].message);
+    EXPECT_EQ(5, messages[3].level);
+    EXPECT_EQ("ctx: inner: nested", messages[4].message);
+    EXPECT_EQ("bar", messages[5].senderName);
+    EXPECT_EQ(10, messages[5].level);
+    EXPECT_EQ("value is 11", messages[5].message);
+}
+
+TEST_F(DiagnosticsBinaryLogTests, UnsupportedConversionsAreFormattedWhenRecorded) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    const auto unsubscribe = sender.SubscribeToRawDiagnostics(
+        SystemAbstractions::DiagnosticsBinaryLogReporter(log)
+    );
+    sender.SendDiagnosticInformationFormatted(0, "%d %ls", 1, L"wide");
+    sender.SendDiagnosticInformationFormatted(0, "%d", 2);
+    unsubscribe();
+    (void)fclose(log);
+
+    std::vector< DecodedMessage > messages;
+    ASSERT_TRUE(DecodeLog(logPath, messages));
+    ASSERT_EQ(2, messages.size());
+    EXPECT_EQ("1 wide", messages[0].message);
+    EXPECT_EQ("2", messages[1].message);
+}
+
+TEST_F(DiagnosticsBinaryLogTests, DecodeAppendedSessions) {
+    const auto logPath = testAreaPath + "/log.bin";
+    for (int session = 0; session < 2; ++session) {
+        auto log = fopen(logPath.c_str(), "ab");
+        ASSERT_FALSE(log == NULL);
+        SystemAbstractions::DiagnosticsSender sender(session == 0 ? "first" : "second");
+        const auto unsubscribe = sender.SubscribeToRawDiagnostics(
+            SystemAbstractions::DiagnosticsBinaryLogReporter(log)
+        );
+        sender.SendDiagnosticInformationFormatted(0, "session %d", session);
+        unsubscribe();
+        (void)fclose(log);
+    }
+
+    std::vector< DecodedMessage > messages;
+    ASSERT_TRUE(DecodeLog(logPath, messages));
+    ASSERT_EQ(2, messages.size());
+    EXPECT_EQ("first", messages[0].senderName);
+    EXPECT_EQ("session 0", messages[0].message);
+    EXPECT_EQ("second", messages[1].senderName);
+    EXPECT_EQ("session 1", messages[1].message);
+}
+
+TEST_F(DiagnosticsBinaryLogTests, TruncatedLogFailsToDecode) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    const auto unsubscribe = sender.SubscribeToRawDiagnostics(
+        SystemAbstractions::DiagnosticsBinaryLogReporter(log)
+    );
+    sender.SendDiagnosticInformationString(0, "hello");
+    sender.SendDiagnosticInformationString(0, "world");
+    unsubscribe();
+    (void)fclose(log);
+    SystemAbstractions::File logFile(logPath);
+    ASSERT_TRUE(logFile.OpenReadWrite());
+    ASSERT_TRUE(logFile.SetSize(logFile.GetSize() - 1));
+    logFile.Close();
+
+    std::vector< DecodedMessage > messages;
+    ASSERT_FALSE(DecodeLog(logPath, messages));
+    ASSERT_EQ(1, messages.size());
+    EXPECT_EQ("hello", messages[0].message);
+}
+
+TEST_F(DiagnosticsBinaryLogTests, LongDoubleRecordedAtFullPrecision) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    const auto unsubscribe = sender.SubscribeToRawDiagnostics(
+        SystemAbstractions::DiagnosticsBinaryLogReporter(log)
+    );
+    const long double value = 1.0L + LDBL_EPSILON;
+    sender.SendDiagnosticInformationFormatted(0, "%.25Lf", value);
+    unsubscribe();
+    (void)fclose(log);
+
+    std::vector< DecodedMessage > messages;
+    ASSERT_TRUE(DecodeLog(logPath, messages));
+    ASSERT_EQ(1, messages.size());
+    EXPECT_EQ(StringExtensions::sprintf("%.25Lf", value), messages[0].message);
+}
+
+TEST_F(DiagnosticsBinaryLogTests, FormatsReusingAddressesRecordedOnce) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    const auto unsubscribe = sender.SubscribeToRawDiagnostics(
+        SystemAbstractions::DiagnosticsBinaryLogReporter(log)
+    );
+    char format[16];
+    for (int i = 0; i < 1000; ++i) {
+        (void)strcpy(format, ((i % 2) == 0) ? "even %d" : "odd %d");
+        sender.SendDiagnosticInformationFormatted(0, format, i);
+    }
+    unsubscribe();
+    const auto logSize = ftell(log);
+    (void)fclose(log);
+
+    // Each message record is 41 bytes: the type, time, level,
+    // three string identifiers, the argument length, and the argument.
+    EXPECT_LT(logSize, 1000 * 41 + 100);
+    std::vector< DecodedMessage > messages;
+    ASSERT_TRUE(DecodeLog(logPath, messages));
+    ASSERT_EQ(1000, messages.size());
+    EXPECT_EQ("even 998", messages[998].message);
+    EXPECT_EQ("odd 999", messages[999].message);
+}
+
+TEST_F(DiagnosticsBinaryLogTests, ManyDifferentFormatsDecoded) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    const auto unsubscribe = sender.SubscribeToRawDiagnostics(
+        SystemAbstractions::DiagnosticsBinaryLogReporter(log)
+    );
+    for (int i = 0; i < 10000; ++i) {
+        const auto format = "format " + std::to_string(i) + ": %d";
+        sender.SendDiagnosticInformationFormatted(0, format.c_str(), i);
+    }
+    unsubscribe();
+    (void)fclose(log);
+
+    std::vector< DecodedMessage > messages;
+    ASSERT_TRUE(DecodeLog(logPath, messages));
+    ASSERT_EQ(10000, messages.size());
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(
+            "format " + std::to_string(i) + ": " + std::to_string(i),
+            messages[i].message
+        ) << i;
+    }
+}
+
+TEST_F(DiagnosticsBinaryLogTests, CorruptStringLengthFailsToDecode) {
+    const auto logPath = testAreaPath + "/log.bin";
+    auto log = fopen(logPath.c_str(), "wb");
+    ASSERT_FALSE(log == NULL);
+    (void)SystemAbstractions::DiagnosticsBinaryLogReporter(log);
+    const uint8_t type = 1;
+    const uint32_t id = 1;
+    const uint32_t length = 0xFFFFFFF0;
+    (void)fwrite(&type, sizeof(type), 1, log);
+    (void)fwrite(&id, sizeof(id), 1, log);
+    (void)fwrite(&length, sizeof(length), 1, log);
+    (void)fwrite("abc", 3, 1, log);
+    (void)fclose(log);
+
+    std::vector< DecodedMessage > messages;
+    EXPECT_FALSE(DecodeLog(logPath, messages));
+    EXPECT_TRUE(messages.empty());
+}
@@ -7,9 +7,18 @@
  * © 2018 by Richard Walters
  */
 
+// Compile out diagnostic messages published through the diagnostic macros
+// with levels below 3, so that this can be tested.
+#undef SYSTEM_ABSTRACTIONS_DIAGNOSTICS_COMPILED_MIN_LEVEL
+#define SYSTEM_ABSTRACTIONS_DIAGNOSTICS_COMPILED_MIN_LEVEL 3
+
+#include <atomic>
 #include <gtest/gtest.h>
+#include <mutex>
 #include <string>
+#include <StringExtensions/StringExtensions.hpp>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
+#include <thread>
 #include <vector>
 
 /**
@@ -82,6 +91,30 @@ struct ReceivedMessage {
 
 };
 
+/**
+ * This is used to publish a diagnostic message from the destructor
+ * of a thread-local object, which runs while the thread exits.
+ */
+struct PublishOnThreadExit {
+    /**
+     * This is the sender from which to publish the message.
+     */
+    SystemAbstractions::DiagnosticsSender* sender = nullptr;
+
+    /**
+     * This is the destructor of the structure.
+     */
+    ~PublishOnThreadExit() {
+        if (sender == nullptr) {
+            return;
+        }
+        sender->PushContext("exiting");
+        sender->SendDiagnosticInformationString(0, "goodbye");
+        sender->SendDiagnosticInformationFormatted(0, "farewell %d", 42);
+        sender->PopContext();
+    }
+};
+
 TEST(DiagnosticsSenderTests, BasicSubscriptionAndTransmission) {
     SystemAbstractions::DiagnosticsSender sender("Joe");
     sender.SendDiagnosticInformationString(100, "Very important message nobody will hear; FeelsBadMan");
@@ -219,3 +252,427 @@ TEST(DiagnosticsSenderTests, PublishAfterChainedSenderDestroyed) {
         })
     );
 }
+
+TEST(DiagnosticsSenderTests, PushAndPopContext) {
+    SystemAbstractions::DiagnosticsSender sender("sender");
+    std::vector< ReceivedMessage > receivedMessages;
+    (void)sender.SubscribeToDiagnostics(
+        [&receivedMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                message
+            );
+        }
+    );
+    sender.PushContext("outer");
+    sender.PushContext("inner");
+    sender.SendDiagnosticInformationString(0, "one");
+    sender.PopContext();
+    sender.SendDiagnosticInformationString(0, "two");
+    sender.PopContext();
+    sender.SendDiagnosticInformationString(0, "three");
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "sender", 0, "outer: inner: one" },
+            { "sender", 0, "outer: two" },
+            { "sender", 0, "three" },
+        })
+    );
+}
+
+TEST(DiagnosticsSenderTests, SubscribeAndUnsubscribeFromWithinSubscriber) {
+    SystemAbstractions::DiagnosticsSender sender("sender");
+    std::vector< ReceivedMessage > receivedMessages;
+    SystemAbstractions::DiagnosticsSender::UnsubscribeDelegate unsubscribe;
+    unsubscribe = sender.SubscribeToDiagnostics(
+        [&](
+            std::string,
+            size_t,
+            std::string
+        ){
+            unsubscribe();
+            (void)sender.SubscribeToDiagnostics(
+                [&receivedMessages](
+                    std::string senderName,
+                    size_t level,
+                    std::string message
+                ){
+                    receivedMessages.emplace_back(
+                        senderName,
+                        level,
+                        message
+                    );
+                }
+            );
+        }
+    );
+    sender.SendDiagnosticInformationString(0, "one");
+    sender.SendDiagnosticInformationString(0, "two");
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "sender", 0, "two" },
+        })
+    );
+}
+
+TEST(DiagnosticsSenderTests, NoMessagesDeliveredAfterUnsubscribing) {
+    SystemAbstractions::DiagnosticsSender sender("sender");
+    std::atomic< bool > stop(false);
+    std::thread publisher(
+        [&sender, &stop]{
+            while (!stop) {
+                sender.SendDiagnosticInformationString(0, "Hello");
+            }
+        }
+    );
+    for (size_t i = 0; i < 1000; ++i) {
+        std::atomic< bool > unsubscribed(false);
+        std::atomic< bool > deliveredAfterUnsubscribing(false);
+        const auto unsubscribe = sender.SubscribeToDiagnostics(
+            [&unsubscribed, &deliveredAfterUnsubscribing](
+                std::string,
+                size_t,
+                std::string
+            ){
+                if (unsubscribed) {
+                    deliveredAfterUnsubscribing = true;
+                }
+            }
+        );
+        unsubscribe();
+        unsubscribed = true;
+        ASSERT_FALSE(deliveredAfterUnsubscribing) << i;
+    }
+    stop = true;
+    publisher.join();
+}
+
+TEST(DiagnosticsSenderTests, NoMessagesDeliveredAfterUnsubscribingFromWithinAnotherSender) {
+    SystemAbstractions::DiagnosticsSender sender("sender");
+    SystemAbstractions::DiagnosticsSender otherSender("other");
+    std::atomic< bool > stop(false);
+    std::thread publisher(
+        [&sender, &stop]{
+            while (!stop) {
+                sender.SendDiagnosticInformationString(0, "Hello");
+            }
+        }
+    );
+    for (size_t i = 0; i < 100; ++i) {
+        std::atomic< bool > delivered(false);
+        std::atomic< bool > unsubscribed(false);
+        std::atomic< bool > deliveredAfterUnsubscribing(false);
+        const auto unsubscribe = sender.SubscribeToDiagnostics(
+            [&delivered, &unsubscribed, &deliveredAfterUnsubscribing](
+                std::string,
+                size_t,
+                std::string
+            ){
+                delivered = true;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                if (unsubscribed) {
+                    deliveredAfterUnsubscribing = true;
+                }
+            }
+        );
+        const auto unsubscribeOther = otherSender.SubscribeToDiagnostics(
+            [&unsubscribe, &unsubscribed](
+                std::string,
+                size_t,
+                std::string
+            ){
+                unsubscribe();
+                unsubscribed = true;
+            }
+        );
+        while (!delivered) {
+            std::this_thread::yield();
+        }
+        otherSender.SendDiagnosticInformationString(0, "Goodbye");
+        unsubscribeOther();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_FALSE(deliveredAfterUnsubscribing) << i;
+    }
+    stop = true;
+    publisher.join();
+}
+
+TEST(DiagnosticsSenderTests, RawSubscription) {
+    SystemAbstractions::DiagnosticsSender sender("Joe");
+    std::vector< ReceivedMessage > receivedMessages;
+    std::vector< ReceivedMessage > receivedRawMessages;
+    (void)sender.SubscribeToDiagnostics(
+        [&receivedMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                message
+            );
+        },
+        5
+    );
+    (void)sender.SubscribeToRawDiagnostics(
+        [&receivedRawMessages](
+            const std::string& senderName,
+            size_t level,
+            const std::string& contextPrefix,
+            const char* format,
+            va_list args
+        ){
+            receivedRawMessages.emplace_back(
+                senderName,
+                level,
+                contextPrefix + "[" + format + "] " + StringExtensions::vsprintf(format, args)
+            );
+        }
+    );
+    sender.PushContext("ctx");
+    sender.SendDiagnosticInformationFormatted(0, "The answer is %d.", 42);
+    sender.SendDiagnosticInformationFormatted(5, "The question is %s.", "unknown");
+    sender.SendDiagnosticInformationString(5, "Hello");
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "Joe", 5, "ctx: The question is unknown." },
+            { "Joe", 5, "ctx: Hello" },
+        })
+    );
+    ASSERT_EQ(
+        receivedRawMessages,
+        (std::vector< ReceivedMessage >{
+            { "Joe", 0, "ctx: [The answer is %d.] The answer is 42." },
+            { "Joe", 5, "ctx: [The question is %s.] The question is unknown." },
+            { "Joe", 5, "ctx: [%s] Hello" },
+        })
+    );
+}
+
+TEST(DiagnosticsSenderTests, ContextChangedWhileDelivering) {
+    SystemAbstractions::DiagnosticsSender sender("Joe");
+    std::vector< ReceivedMessage > receivedMessages;
+    (void)sender.SubscribeToDiagnostics(
+        [&sender, &receivedMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                message
+            );
+            sender.PopContext();
+            sender.PushContext("a much longer context than was there before");
+        }
+    );
+    (void)sender.SubscribeToRawDiagnostics(
+        [&receivedMessages](
+            const std::string& senderName,
+            size_t level,
+            const std::string& contextPrefix,
+            const char* format,
+            va_list args
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                contextPrefix + StringExtensions::vsprintf(format, args)
+            );
+        }
+    );
+    sender.PushContext("ctx");
+    sender.SendDiagnosticInformationString(0, "Hello");
+    sender.SendDiagnosticInformationFormatted(0, "The answer is %d.", 42);
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "Joe", 0, "ctx: Hello" },
+            { "Joe", 0, "ctx: Hello" },
+            { "Joe", 0, "a much longer context than was there before: The answer is 42." },
+            { "Joe", 0, "a much longer context than was there before: The answer is 42." },
+        })
+    );
+}
+
+TEST(DiagnosticsSenderTests, MacrosOnlyEvaluateArgumentsForMessagesDelivered) {
+    SystemAbstractions::DiagnosticsSender sender("Joe");
+    size_t evaluations = 0;
+    const auto evaluate = [&evaluations](const char* value){
+        ++evaluations;
+        return std::string(value);
+    };
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(sender, 10, evaluate("nobody listening"));
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(sender, 10, "%s", evaluate("nobody listening").c_str());
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_LAZY(sender, 10, [&evaluate]{ return evaluate("nobody listening"); });
+    EXPECT_EQ(0, evaluations);
+    std::vector< ReceivedMessage > receivedMessages;
+    const auto unsubscribe = sender.SubscribeToDiagnostics(
+        [&receivedMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                message
+            );
+        },
+        5
+    );
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(sender, 4, evaluate("too low"));
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(sender, 4, "%s", evaluate("too low").c_str());
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_LAZY(sender, 4, [&evaluate]{ return evaluate("too low"); });
+    EXPECT_EQ(0, evaluations);
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(sender, 5, evaluate("string"));
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(sender, 6, "%s %d", evaluate("formatted").c_str(), 42);
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_LAZY(sender, 7, [&evaluate]{ return evaluate("lazy"); });
+    EXPECT_EQ(3, evaluations);
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "Joe", 5, "string" },
+            { "Joe", 6, "formatted 42" },
+            { "Joe", 7, "lazy" },
+        })
+    );
+    unsubscribe();
+}
+
+TEST(DiagnosticsSenderTests, MacrosCompileOutLevelsBelowCompiledMinimum) {
+    SystemAbstractions::DiagnosticsSender sender("Joe");
+    std::vector< ReceivedMessage > receivedMessages;
+    const auto unsubscribe = sender.SubscribeToDiagnostics(
+        [&receivedMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                message
+            );
+        }
+    );
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(sender, 2, "compiled out");
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_FORMATTED(sender, 2, "compiled %s", "out");
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_LAZY(sender, 2, []{ return "compiled out"; });
+    SYSTEM_ABSTRACTIONS_DIAGNOSTIC_STRING(sender, 3, "kept");
+    sender.SendDiagnosticInformationString(2, "not published through a macro");
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "Joe", 3, "kept" },
+            { "Joe", 2, "not published through a macro" },
+        })
+    );
+    unsubscribe();
+}
+
+TEST(DiagnosticsSenderTests, ContextsArePerThreadAndPerSender) {
+    SystemAbstractions::DiagnosticsSender foo("foo");
+    SystemAbstractions::DiagnosticsSender bar("bar");
+    std::mutex mutex;
+    std::vector< ReceivedMessage > receivedMessages;
+    const auto receive = [&mutex, &receivedMessages](
+        std::string senderName,
+        size_t level,
+        std::string message
+    ){
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        receivedMessages.emplace_back(
+            senderName,
+            level,
+            message
+        );
+    };
+    const auto unsubscribeFoo = foo.SubscribeToDiagnostics(receive);
+    const auto unsubscribeBar = bar.SubscribeToDiagnostics(receive);
+    std::vector< std::thread > threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back(
+            [i, &foo]{
+                const auto context = "thread" + std::to_string(i);
+                for (size_t j = 0; j < 100; ++j) {
+                    foo.PushContext(context);
+                    foo.PushContext("inner");
+                    foo.SendDiagnosticInformationFormatted(0, "%zu", i);
+                    foo.PopContext();
+                    foo.PopContext();
+                }
+            }
+        );
+    }
+    foo.PushContext("main");
+    bar.SendDiagnosticInformationString(0, "no context");
+    foo.SendDiagnosticInformationString(0, "with context");
+    foo.PopContext();
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    unsubscribeFoo();
+    unsubscribeBar();
+    ASSERT_EQ(402, receivedMessages.size());
+    size_t numMessagesFromThreads = 0;
+    for (const auto& receivedMessage: receivedMessages) {
+        if (receivedMessage.senderName == "bar") {
+            EXPECT_EQ("no context", receivedMessage.message);
+        } else if (receivedMessage.message != "main: with context") {
+            const auto i = receivedMessage.message.substr(receivedMessage.message.length() - 1);
+            EXPECT_EQ("thread" + i + ": inner: " + i, receivedMessage.message);
+            ++numMessagesFromThreads;
+        }
+    }
+    EXPECT_EQ(400, numMessagesFromThreads);
+}
+
+TEST(DiagnosticsSenderTests, PublishFromThreadLocalDestructor) {
+    SystemAbstractions::DiagnosticsSender sender("Joe");
+    std::vector< ReceivedMessage > receivedMessages;
+    const auto unsubscribe = sender.SubscribeToDiagnostics(
+        [&receivedMessages](
+            std::string senderName,
+            size_t level,
+            std::string message
+        ){
+            receivedMessages.emplace_back(
+                senderName,
+                level,
+                message
+            );
+        }
+    );
+    std::thread thread(
+        [&sender]{
+            // This is made before the thread first uses the sender,
+            // so that it's destroyed after the thread's diagnostic state.
+            thread_local PublishOnThreadExit publishOnThreadExit;
+            publishOnThreadExit.sender = &sender;
+            sender.PushContext("running");
+            sender.SendDiagnosticInformationString(0, "hello");
+            sender.PopContext();
+        }
+    );
+    thread.join();
+    unsubscribe();
+    ASSERT_EQ(
+        receivedMessages,
+        (std::vector< ReceivedMessage >{
+            { "Joe", 0, "running: hello" },
+            { "Joe", 0, "goodbye" },
+            { "Joe", 0, "farewell 42" },
+        })
+    );
+}
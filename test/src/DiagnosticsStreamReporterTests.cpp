@@ -8,11 +8,13 @@
  */
 
 #include <gtest/gtest.h>
+#include <set>
 #include <stdio.h>
 #include <string>
 #include <SystemAbstractions/DiagnosticsStreamReporter.hpp>
 #include <SystemAbstractions/DiagnosticsSender.hpp>
 #include <SystemAbstractions/File.hpp>
+#include <thread>
 #include <vector>
 
 /**
@@ -179,3 +181,243 @@ TEST_F(DiagnosticsStreamReporterTests, SaveDiagnosticMessagesToLogFiles) {
     CheckIsEndOfFile(error);
     (void)fclose(error);
 }
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterSavesDiagnosticMessagesToLogFiles) {
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    auto error = fopen((testAreaPath + "/error.txt").c_str(), "wt");
+    {
+        SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(output, error);
+        const auto unsubscribeDelegate = sender.SubscribeToDiagnostics(reporter.GetDelegate());
+        sender.SendDiagnosticInformationString(0, "hello");
+        sender.SendDiagnosticInformationString(10, "world");
+        sender.SendDiagnosticInformationString(2, "last message");
+        sender.SendDiagnosticInformationString(5, "be careful");
+        unsubscribeDelegate();
+        sender.SendDiagnosticInformationString(0, "really the last message");
+    }
+    (void)fclose(output);
+    (void)fclose(error);
+    output = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    CheckLogMessage(output, "foo:0] hello\n");
+    CheckLogMessage(output, "foo:2] last message\n");
+    CheckIsEndOfFile(output);
+    (void)fclose(output);
+    error = fopen((testAreaPath + "/error.txt").c_str(), "rt");
+    CheckLogMessage(error, "foo:10] error: world\n");
+    CheckLogMessage(error, "foo:5] warning: be careful\n");
+    CheckIsEndOfFile(error);
+    (void)fclose(error);
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterFlush) {
+    SystemAbstractions::DiagnosticsSender sender("foo");
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(output, output);
+    (void)sender.SubscribeToDiagnostics(reporter.GetDelegate());
+    sender.SendDiagnosticInformationString(0, "hello");
+    reporter.Flush();
+    auto input = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    CheckLogMessage(input, "foo:0] hello\n");
+    CheckIsEndOfFile(input);
+    (void)fclose(input);
+    sender.SendDiagnosticInformationString(0, "world");
+    reporter.Flush();
+    input = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    CheckLogMessage(input, "foo:0] hello\n");
+    CheckLogMessage(input, "foo:0] world\n");
+    CheckIsEndOfFile(input);
+    (void)fclose(input);
+    (void)fclose(output);
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterFlushWhilePublishersBusy) {
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    constexpr size_t numThreads = 4;
+    constexpr size_t numMessagesPerThread = 1000;
+    constexpr size_t numMarkers = 20;
+    SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(output, output, 8);
+    const auto delegate = reporter.GetDelegate();
+    std::vector< std::thread > publishers;
+    for (size_t i = 0; i < numThreads; ++i) {
+        publishers.emplace_back(
+            [delegate, i]{
+                for (size_t j = 0; j < numMessagesPerThread; ++j) {
+                    delegate(std::to_string(i), 0, "noise");
+                }
+            }
+        );
+    }
+    auto input = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    std::vector< char > lineBuffer(256);
+    for (size_t i = 0; i < numMarkers; ++i) {
+        const auto marker = "marker " + std::to_string(i);
+        delegate("main", 0, marker);
+        reporter.Flush();
+        bool found = false;
+        while (
+            !found
+            && (fgets(lineBuffer.data(), (int)lineBuffer.size(), input) != NULL)
+        ) {
+            const std::string line(lineBuffer.data());
+            found = (line.substr(line.find(' ') + 1) == "main:0] " + marker + "\n");
+        }
+        clearerr(input);
+        EXPECT_TRUE(found) << marker;
+    }
+    (void)fclose(input);
+    for (auto& publisher: publishers) {
+        publisher.join();
+    }
+    reporter.Flush();
+    (void)fclose(output);
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterBlocksWhenFull) {
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    constexpr size_t numThreads = 4;
+    constexpr size_t numMessagesPerThread = 1000;
+    {
+        SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(
+            output,
+            output,
+            2,
+            SystemAbstractions::AsyncDiagnosticsStreamReporter::OverflowPolicy::Block
+        );
+        const auto delegate = reporter.GetDelegate();
+        std::vector< std::thread > publishers;
+        for (size_t i = 0; i < numThreads; ++i) {
+            publishers.emplace_back(
+                [delegate, i]{
+                    for (size_t j = 0; j < numMessagesPerThread; ++j) {
+                        delegate(std::to_string(i), 0, std::to_string(j));
+                    }
+                }
+            );
+        }
+        for (auto& publisher: publishers) {
+            publisher.join();
+        }
+        EXPECT_EQ(0, reporter.GetDroppedCount());
+    }
+    (void)fclose(output);
+    output = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    std::vector< char > lineBuffer(256);
+    std::set< std::string > lines;
+    while (fgets(lineBuffer.data(), (int)lineBuffer.size(), output) != NULL) {
+        const std::string line(lineBuffer.data());
+        (void)lines.insert(line.substr(line.find(' ') + 1));
+    }
+    (void)fclose(output);
+    EXPECT_EQ(numThreads * numMessagesPerThread, lines.size());
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterDropsNewestWhenFull) {
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    size_t dropped;
+    {
+        SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(
+            output,
+            output,
+            4,
+            SystemAbstractions::AsyncDiagnosticsStreamReporter::OverflowPolicy::DropNewest
+        );
+        const auto delegate = reporter.GetDelegate();
+        for (size_t i = 0; i < 10000; ++i) {
+            delegate("foo", 0, std::to_string(i));
+        }
+        reporter.Flush();
+        dropped = reporter.GetDroppedCount();
+    }
+    (void)fclose(output);
+    output = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    std::vector< char > lineBuffer(256);
+    size_t messagesWritten = 0;
+    size_t droppedReported = 0;
+    while (fgets(lineBuffer.data(), (int)lineBuffer.size(), output) != NULL) {
+        const std::string line(lineBuffer.data());
+        const auto dropNotice = line.find("] warning: ");
+        if (dropNotice == std::string::npos) {
+            ++messagesWritten;
+        } else {
+            droppedReported += (size_t)std::stoul(line.substr(dropNotice + 11));
+        }
+    }
+    (void)fclose(output);
+    EXPECT_EQ(10000, messagesWritten + dropped);
+    EXPECT_EQ(dropped, droppedReported);
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterDropsOldestWhenFull) {
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    {
+        SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(
+            output,
+            output,
+            4,
+            SystemAbstractions::AsyncDiagnosticsStreamReporter::OverflowPolicy::DropOldest
+        );
+        const auto delegate = reporter.GetDelegate();
+        for (size_t i = 0; i < 10000; ++i) {
+            delegate("foo", 0, std::to_string(i));
+        }
+    }
+    (void)fclose(output);
+    output = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    std::vector< char > lineBuffer(256);
+    std::string lastMessage;
+    while (fgets(lineBuffer.data(), (int)lineBuffer.size(), output) != NULL) {
+        const std::string line(lineBuffer.data());
+        if (line.find("] warning: ") == std::string::npos) {
+            lastMessage = line.substr(line.find(' ') + 1);
+        }
+    }
+    (void)fclose(output);
+    EXPECT_EQ("foo:0] 9999\n", lastMessage);
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterDelegateAfterReporterDestroyed) {
+    auto output = fopen((testAreaPath + "/out.txt").c_str(), "wt");
+    SystemAbstractions::DiagnosticsSender::DiagnosticMessageDelegate delegate;
+    {
+        SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(output, output);
+        delegate = reporter.GetDelegate();
+    }
+    delegate("foo", 0, "hello");
+    (void)fclose(output);
+    output = fopen((testAreaPath + "/out.txt").c_str(), "rt");
+    CheckIsEndOfFile(output);
+    (void)fclose(output);
+}
+
+TEST_F(DiagnosticsStreamReporterTests, AsyncReporterMoveAssignedThenExit) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    const auto firstPath = testAreaPath + "/first.txt";
+    const auto secondPath = testAreaPath + "/second.txt";
+    EXPECT_EXIT(
+        {
+            auto first = fopen(firstPath.c_str(), "wt");
+            auto second = fopen(secondPath.c_str(), "wt");
+            SystemAbstractions::AsyncDiagnosticsStreamReporter reporter(first, first);
+            reporter.GetDelegate()("foo", 0, "hello");
+            SystemAbstractions::AsyncDiagnosticsStreamReporter other(second, second);
+            other.GetDelegate()("bar", 0, "world");
+            reporter = std::move(other);
+            reporter.GetDelegate()("bar", 0, "last message");
+            exit(0);
+        },
+        ::testing::ExitedWithCode(0),
+        ""
+    );
+    auto first = fopen(firstPath.c_str(), "rt");
+    ASSERT_FALSE(first == NULL);
+    CheckLogMessage(first, "foo:0] hello\n");
+    CheckIsEndOfFile(first);
+    (void)fclose(first);
+    auto second = fopen(secondPath.c_str(), "rt");
+    ASSERT_FALSE(second == NULL);
+    CheckLogMessage(second, "bar:0] world\n");
+    CheckLogMessage(second, "bar:0] last message\n");
+    CheckIsEndOfFile(second);
+    (void)fclose(second);
+}
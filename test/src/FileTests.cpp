@@ -7,10 +7,20 @@
  * © 2018 by Richard Walters
  */
 
+#include <functional>
+#include <future>
 #include <gtest/gtest.h>
 #include <set>
+#include <string>
 #include <SystemAbstractions/File.hpp>
 #include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <Posix/FileIoEngine.hpp>
+#include <unistd.h>
+#endif /* not _WIN32 */
 
 /**
  * This is the test fixture for these tests, providing common
@@ -55,6 +65,128 @@ struct FileTests
         }
         ASSERT_FALSE(failedToDeleteTestArea);
     }
+
+    // Types
+
+    /**
+     * This is the type of function called when an asynchronous
+     * operation completes.
+     */
+    typedef SystemAbstractions::File::AsyncCompletionDelegate AsyncCompletionDelegate;
+
+    /**
+     * This is the type of function used to start writing data
+     * asynchronously at the given position in a file.
+     */
+    typedef std::function<
+        void(
+            uint64_t position,
+            const void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        )
+    > AsyncWriteAtDelegate;
+
+    /**
+     * This is the type of function used to start flushing a file
+     * to storage asynchronously.
+     */
+    typedef std::function<
+        void(AsyncCompletionDelegate completionDelegate)
+    > AsyncSyncDelegate;
+
+    /**
+     * This is the type of function used to start reading data
+     * asynchronously from the given position in a file.
+     */
+    typedef std::function<
+        void(
+            uint64_t position,
+            void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        )
+    > AsyncReadAtDelegate;
+
+    // Methods
+
+    /**
+     * This method writes blocks of data to an empty file asynchronously,
+     * flushes the file, and then reads the whole file back
+     * asynchronously, checking that each step completes
+     * and that the data read back matches the data written.
+     *
+     * @param[in] writeAt
+     *     This is the function to call to start each write.
+     *
+     * @param[in] sync
+     *     This is the function to call to start the flush.
+     *
+     * @param[in] readAt
+     *     This is the function to call to start the read.
+     */
+    void CheckAsyncWriteSyncAndReadBack(
+        AsyncWriteAtDelegate writeAt,
+        AsyncSyncDelegate sync,
+        AsyncReadAtDelegate readAt
+    ) {
+        constexpr size_t numBlocks = 32;
+        constexpr size_t blockSize = 4096;
+        std::vector< uint8_t > contents(numBlocks * blockSize);
+        for (size_t i = 0; i < contents.size(); ++i) {
+            contents[i] = (uint8_t)(i / blockSize);
+        }
+        std::vector< std::promise< size_t > > writesDone(numBlocks);
+        for (size_t i = 0; i < numBlocks; ++i) {
+            auto& writeDone = writesDone[i];
+            writeAt(
+                i * blockSize,
+                contents.data() + i * blockSize,
+                blockSize,
+                [&writeDone](bool success, size_t amount){
+                    writeDone.set_value(success ? amount : 0);
+                }
+            );
+        }
+        for (auto& writeDone: writesDone) {
+            auto future = writeDone.get_future();
+            ASSERT_EQ(
+                std::future_status::ready,
+                future.wait_for(std::chrono::seconds(5))
+            );
+            EXPECT_EQ(blockSize, future.get());
+        }
+        std::promise< bool > syncDone;
+        sync(
+            [&syncDone](bool success, size_t){
+                syncDone.set_value(success);
+            }
+        );
+        auto syncFuture = syncDone.get_future();
+        ASSERT_EQ(
+            std::future_status::ready,
+            syncFuture.wait_for(std::chrono::seconds(5))
+        );
+        EXPECT_TRUE(syncFuture.get());
+        std::vector< uint8_t > readBack(contents.size() + 100);
+        std::promise< size_t > readDone;
+        readAt(
+            0,
+            readBack.data(),
+            readBack.size(),
+            [&readDone](bool success, size_t amount){
+                readDone.set_value(success ? amount : 0);
+            }
+        );
+        auto readFuture = readDone.get_future();
+        ASSERT_EQ(
+            std::future_status::ready,
+            readFuture.wait_for(std::chrono::seconds(5))
+        );
+        ASSERT_EQ(contents.size(), readFuture.get());
+        readBack.resize(contents.size());
+        EXPECT_TRUE(readBack == contents);
+    }
 };
 
 TEST_F(FileTests, BasicFileMethods) {
@@ -218,6 +350,177 @@ TEST_F(FileTests, DirectoryTests) {
     ASSERT_FALSE(file4.IsExisting());
 }
 
+TEST_F(FileTests, CopyReplacesLongerFile) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadWrite());
+    std::vector< uint8_t > contents(1000000);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = (uint8_t)(i * 7);
+    }
+    ASSERT_EQ(contents.size(), file.Write(contents));
+    file.Close();
+    SystemAbstractions::File file2(testFilePath + "2");
+    ASSERT_TRUE(file2.OpenReadWrite());
+    const std::vector< uint8_t > longerContents(contents.size() + 100, 'x');
+    ASSERT_EQ(longerContents.size(), file2.Write(longerContents));
+    file2.Close();
+    ASSERT_TRUE(file.Copy(file2.GetPath()));
+    ASSERT_TRUE(file2.OpenReadOnly());
+    ASSERT_EQ(contents.size(), file2.GetSize());
+    SystemAbstractions::IFile::Buffer buffer(contents.size());
+    ASSERT_EQ(buffer.size(), file2.Read(buffer));
+    ASSERT_TRUE(buffer == contents);
+}
+
+TEST_F(FileTests, CopyDirectoryWithManyFiles) {
+    const std::string sourcePath = testAreaPath + "/source";
+    constexpr size_t numSubdirectories = 4;
+    constexpr size_t numFilesPerSubdirectory = 25;
+    for (size_t i = 0; i < numSubdirectories; ++i) {
+        for (size_t j = 0; j < numFilesPerSubdirectory; ++j) {
+            const auto name = std::to_string(i) + "/" + std::to_string(j);
+            SystemAbstractions::File file(sourcePath + "/" + name);
+            ASSERT_TRUE(file.OpenReadWrite());
+            ASSERT_EQ(name.length(), file.Write(name.data(), name.length()));
+        }
+    }
+    const std::string destinationPath = testAreaPath + "/destination";
+    ASSERT_TRUE(SystemAbstractions::File::CopyDirectory(sourcePath, destinationPath));
+    for (size_t i = 0; i < numSubdirectories; ++i) {
+        for (size_t j = 0; j < numFilesPerSubdirectory; ++j) {
+            const auto name = std::to_string(i) + "/" + std::to_string(j);
+            SystemAbstractions::File file(destinationPath + "/" + name);
+            ASSERT_TRUE(file.OpenReadOnly()) << name;
+            SystemAbstractions::IFile::Buffer buffer((size_t)file.GetSize());
+            ASSERT_EQ(buffer.size(), file.Read(buffer));
+            EXPECT_EQ(name, std::string(buffer.begin(), buffer.end()));
+        }
+    }
+}
+
+TEST_F(FileTests, DeleteDirectorySummary) {
+    const std::string treePath = testAreaPath + "/tree";
+    for (const auto& name: { "a", "b/c", "b/d/e", "b/d/f" }) {
+        SystemAbstractions::File file(treePath + "/" + name);
+        ASSERT_TRUE(file.OpenReadWrite()) << name;
+    }
+    SystemAbstractions::File::DirectoryOperationResult result;
+    EXPECT_TRUE(SystemAbstractions::File::DeleteDirectory(treePath, result));
+    EXPECT_EQ(4, result.filesProcessed);
+    EXPECT_EQ(3, result.directoriesProcessed);
+    EXPECT_EQ(0, result.failures);
+    EXPECT_EQ("", result.firstFailurePath);
+    SystemAbstractions::File tree(treePath);
+    EXPECT_FALSE(tree.IsExisting());
+}
+
+TEST_F(FileTests, DeleteMissingDirectorySucceeds) {
+    SystemAbstractions::File::DirectoryOperationResult result;
+    EXPECT_TRUE(SystemAbstractions::File::DeleteDirectory(testAreaPath + "/missing", result));
+    EXPECT_EQ(0, result.filesProcessed);
+    EXPECT_EQ(0, result.directoriesProcessed);
+}
+
+TEST_F(FileTests, CopyDirectorySummary) {
+    const std::string sourcePath = testAreaPath + "/source";
+    for (const auto& name: { "a", "b/c", "b/d/e", "b/d/f" }) {
+        SystemAbstractions::File file(sourcePath + "/" + name);
+        ASSERT_TRUE(file.OpenReadWrite()) << name;
+    }
+    SystemAbstractions::File::DirectoryOperationResult result;
+    EXPECT_TRUE(
+        SystemAbstractions::File::CopyDirectory(
+            sourcePath,
+            testAreaPath + "/destination",
+            result
+        )
+    );
+    EXPECT_EQ(4, result.filesProcessed);
+    EXPECT_EQ(3, result.directoriesProcessed);
+    EXPECT_EQ(0, result.failures);
+}
+
+TEST_F(FileTests, CopyMissingDirectoryFails) {
+    SystemAbstractions::File::DirectoryOperationResult result;
+    EXPECT_FALSE(
+        SystemAbstractions::File::CopyDirectory(
+            testAreaPath + "/missing",
+            testAreaPath + "/destination",
+            result
+        )
+    );
+    EXPECT_EQ(1, result.failures);
+    EXPECT_EQ(testAreaPath + "/missing", result.firstFailurePath);
+}
+
+TEST_F(FileTests, VisitDirectory) {
+    SystemAbstractions::File file(testAreaPath + "/foo.txt");
+    ASSERT_TRUE(file.OpenReadWrite());
+    const std::string testString = "Hello, World!";
+    ASSERT_EQ(testString.length(), file.Write(testString.data(), testString.length()));
+    file.Close();
+    ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath + "/sub"));
+    std::set< std::string > namesVisited;
+    ASSERT_TRUE(
+        SystemAbstractions::File::VisitDirectory(
+            testAreaPath,
+            [&](const SystemAbstractions::File::DirectoryEntry& entry){
+                namesVisited.insert(entry.GetName());
+                if (entry.GetName() == "foo.txt") {
+                    EXPECT_EQ(
+                        SystemAbstractions::File::DirectoryEntry::Type::File,
+                        entry.GetType()
+                    );
+                    EXPECT_EQ(testString.length(), entry.GetSize());
+                    EXPECT_EQ(file.GetLastModifiedTime(), entry.GetLastModifiedTime());
+                } else if (entry.GetName() == "sub") {
+                    EXPECT_EQ(
+                        SystemAbstractions::File::DirectoryEntry::Type::Directory,
+                        entry.GetType()
+                    );
+                }
+                return true;
+            }
+        )
+    );
+    EXPECT_EQ(
+        (std::set< std::string >{ "foo.txt", "sub" }),
+        namesVisited
+    );
+}
+
+TEST_F(FileTests, VisitDirectoryStopsWhenVisitorSaysSo) {
+    for (size_t i = 0; i < 10; ++i) {
+        SystemAbstractions::File file(testAreaPath + "/" + std::to_string(i));
+        ASSERT_TRUE(file.OpenReadWrite());
+    }
+    size_t entriesVisited = 0;
+    ASSERT_TRUE(
+        SystemAbstractions::File::VisitDirectory(
+            testAreaPath,
+            [&](const SystemAbstractions::File::DirectoryEntry&){
+                return (++entriesVisited < 3);
+            }
+        )
+    );
+    EXPECT_EQ(3, entriesVisited);
+}
+
+TEST_F(FileTests, VisitMissingDirectoryFails) {
+    size_t entriesVisited = 0;
+    EXPECT_FALSE(
+        SystemAbstractions::File::VisitDirectory(
+            testAreaPath + "/missing",
+            [&](const SystemAbstractions::File::DirectoryEntry&){
+                ++entriesVisited;
+                return true;
+            }
+        )
+    );
+    EXPECT_EQ(0, entriesVisited);
+}
+
 TEST_F(FileTests, RepurposeFileObject) {
     const std::string testFilePath1 = testAreaPath + "/foo.txt";
     const std::string testFilePath2 = testAreaPath + "/bar.txt";
@@ -473,6 +776,194 @@ TEST_F(FileTests, WriteBeyondEndAndIntoMiddle) {
     );
 }
 
+TEST_F(FileTests, ReadAtAndWriteAtDoNotMovePosition) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadWrite());
+    const std::string testString = "Hello, World!";
+    ASSERT_EQ(testString.length(), file.WriteAt(0, testString.data(), testString.length()));
+    ASSERT_EQ(0, file.GetPosition());
+    ASSERT_EQ(testString.length(), file.GetSize());
+    file.SetPosition(3);
+    ASSERT_EQ(1, file.WriteAt(0, "J", 1));
+    ASSERT_EQ(3, file.GetPosition());
+    char buffer[5];
+    ASSERT_EQ(5, file.ReadAt(7, buffer, sizeof(buffer)));
+    ASSERT_EQ("World", std::string(buffer, sizeof(buffer)));
+    ASSERT_EQ(3, file.GetPosition());
+    ASSERT_EQ(5, file.ReadAt(0, buffer, sizeof(buffer)));
+    ASSERT_EQ("Jello", std::string(buffer, sizeof(buffer)));
+    ASSERT_EQ(1, file.ReadAt(12, buffer, sizeof(buffer)));
+    ASSERT_EQ('!', buffer[0]);
+    ASSERT_EQ(0, file.ReadAt(13, buffer, sizeof(buffer)));
+    ASSERT_EQ(3, file.GetPosition());
+}
+
+TEST_F(FileTests, ReadAtFromManyThreads) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadWrite());
+    constexpr size_t numBlocks = 64;
+    constexpr size_t blockSize = 1024;
+    std::vector< uint8_t > contents(numBlocks * blockSize);
+    for (size_t i = 0; i < contents.size(); ++i) {
+        contents[i] = (uint8_t)(i / blockSize);
+    }
+    ASSERT_EQ(contents.size(), file.Write(contents));
+    std::vector< int > blocksMatched(numBlocks, 0);
+    std::vector< std::thread > readers;
+    constexpr size_t numReaders = 4;
+    for (size_t i = 0; i < numReaders; ++i) {
+        readers.emplace_back(
+            [&file, &blocksMatched, i]{
+                std::vector< uint8_t > block(blockSize);
+                for (size_t j = i; j < numBlocks; j += numReaders) {
+                    if (file.ReadAt(j * blockSize, block.data(), blockSize) != blockSize) {
+                        continue;
+                    }
+                    blocksMatched[j] = (int)(
+                        block == std::vector< uint8_t >(blockSize, (uint8_t)j)
+                    );
+                }
+            }
+        );
+    }
+    for (auto& reader: readers) {
+        reader.join();
+    }
+    for (size_t i = 0; i < numBlocks; ++i) {
+        EXPECT_TRUE(blocksMatched[i]) << i;
+    }
+}
+
+TEST_F(FileTests, AsyncWriteReadAndSync) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadWrite());
+    CheckAsyncWriteSyncAndReadBack(
+        [&file](
+            uint64_t position,
+            const void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        ){
+            file.WriteAtAsync(position, buffer, numBytes, completionDelegate);
+        },
+        [&file](AsyncCompletionDelegate completionDelegate){
+            file.SyncAsync(completionDelegate);
+        },
+        [&file](
+            uint64_t position,
+            void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        ){
+            file.ReadAtAsync(position, buffer, numBytes, completionDelegate);
+        }
+    );
+    EXPECT_EQ(0, file.GetPosition());
+}
+
+#ifndef _WIN32
+TEST_F(FileTests, AsyncWriteReadAndSyncWithoutKernelQueue) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::FileIoEngine engine(false);
+    ASSERT_FALSE(engine.IsUsingKernelQueue());
+    const auto handle = open(testFilePath.c_str(), O_RDWR | O_CREAT, 0666);
+    ASSERT_GE(handle, 0);
+    CheckAsyncWriteSyncAndReadBack(
+        [&engine, handle](
+            uint64_t position,
+            const void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        ){
+            engine.WriteAt(handle, position, buffer, numBytes, completionDelegate);
+        },
+        [&engine, handle](AsyncCompletionDelegate completionDelegate){
+            engine.Sync(handle, completionDelegate);
+        },
+        [&engine, handle](
+            uint64_t position,
+            void* buffer,
+            size_t numBytes,
+            AsyncCompletionDelegate completionDelegate
+        ){
+            engine.ReadAt(handle, position, buffer, numBytes, completionDelegate);
+        }
+    );
+    (void)close(handle);
+}
+#endif /* not _WIN32 */
+
+TEST_F(FileTests, AsyncOperationOnClosedFileFails) {
+    SystemAbstractions::File file(testAreaPath + "/foo.txt");
+    uint8_t buffer[4];
+    bool called = false;
+    bool succeeded = true;
+    file.ReadAtAsync(
+        0,
+        buffer,
+        sizeof(buffer),
+        [&called, &succeeded](bool success, size_t){
+            called = true;
+            succeeded = success;
+        }
+    );
+    EXPECT_TRUE(called);
+    EXPECT_FALSE(succeeded);
+}
+
+TEST_F(FileTests, PreallocateWithoutChangingSize) {
+    SystemAbstractions::File file(testAreaPath + "/foo.txt");
+    ASSERT_TRUE(file.OpenReadWrite());
+    ASSERT_EQ(5, file.Write("Hello", 5));
+    ASSERT_TRUE(file.Preallocate(0, 1048576));
+    EXPECT_EQ(5, file.GetSize());
+    ASSERT_EQ(7, file.Write(", World", 7));
+    EXPECT_EQ(12, file.GetSize());
+}
+
+TEST_F(FileTests, PreallocateAndChangeSize) {
+    SystemAbstractions::File file(testAreaPath + "/foo.txt");
+    ASSERT_TRUE(file.OpenReadWrite());
+    ASSERT_EQ(5, file.Write("Hello", 5));
+    ASSERT_TRUE(file.Preallocate(0, 65536, true));
+    EXPECT_EQ(65536, file.GetSize());
+    SystemAbstractions::IFile::Buffer buffer(5);
+    ASSERT_EQ(5, file.ReadAt(0, buffer.data(), buffer.size()));
+    EXPECT_EQ("Hello", std::string(buffer.begin(), buffer.end()));
+}
+
+TEST_F(FileTests, PunchHole) {
+    SystemAbstractions::File file(testAreaPath + "/foo.txt");
+    ASSERT_TRUE(file.OpenReadWrite());
+    const std::string testString(3 * 65536, 'x');
+    ASSERT_EQ(testString.length(), file.Write(testString.data(), testString.length()));
+    ASSERT_TRUE(file.PunchHole(65536, 65536));
+    EXPECT_EQ(testString.length(), file.GetSize());
+    SystemAbstractions::IFile::Buffer buffer(testString.length());
+    ASSERT_EQ(buffer.size(), file.ReadAt(0, buffer.data(), buffer.size()));
+    EXPECT_EQ(std::string(65536, 'x'), std::string(buffer.begin(), buffer.begin() + 65536));
+    EXPECT_EQ(std::string(65536, '\0'), std::string(buffer.begin() + 65536, buffer.begin() + 131072));
+    EXPECT_EQ(std::string(65536, 'x'), std::string(buffer.begin() + 131072, buffer.end()));
+}
+
+TEST_F(FileTests, SyncModes) {
+    SystemAbstractions::File file(testAreaPath + "/foo.txt");
+    EXPECT_FALSE(file.Sync());
+    ASSERT_TRUE(file.OpenReadWrite());
+    for (const auto mode: {
+        SystemAbstractions::File::SyncMode::None,
+        SystemAbstractions::File::SyncMode::StartWriteback,
+        SystemAbstractions::File::SyncMode::Data,
+        SystemAbstractions::File::SyncMode::Full,
+    }) {
+        ASSERT_EQ(5, file.Write("Hello", 5));
+        EXPECT_TRUE(file.Sync(mode)) << (int)mode;
+    }
+}
+
 TEST_F(FileTests, IsAbsolutePath) {
     struct TestVector {
         std::string path;
@@ -0,0 +1,205 @@
+/**
+ * @file MappedFileTests.cpp
+ *
+ * This module contains the unit tests of the
+ * SystemAbstractions::MappedFile class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <SystemAbstractions/File.hpp>
+#include <SystemAbstractions/MappedFile.hpp>
+#include <thread>
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct MappedFileTests
+    : public ::testing::Test
+{
+    // Properties
+
+    /**
+     * This is the temporary directory to use to test
+     * the MappedFile class.
+     */
+    std::string testAreaPath;
+
+    // Methods
+
+    // ::testing::Test
+
+    virtual void SetUp() {
+        testAreaPath = SystemAbstractions::File::GetExeParentDirectory() + "/TestArea";
+        ASSERT_TRUE(SystemAbstractions::File::CreateDirectory(testAreaPath));
+    }
+
+    virtual void TearDown() {
+        bool failedToDeleteTestArea = true;
+        for (size_t i = 0; i < 10; ++i) {
+            if (SystemAbstractions::File::DeleteDirectory(testAreaPath)) {
+                failedToDeleteTestArea = false;
+                break;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+        ASSERT_FALSE(failedToDeleteTestArea);
+    }
+};
+
+TEST_F(MappedFileTests, ReadFileWrittenNormally) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadWrite());
+    const std::string testString("Hello, World!");
+    const SystemAbstractions::IFile::Buffer testBuffer(testString.begin(), testString.end());
+    ASSERT_EQ(testBuffer.size(), file.Write(testBuffer));
+    file.Close();
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    ASSERT_TRUE(mappedFile.OpenReadOnly());
+    ASSERT_EQ(testBuffer.size(), mappedFile.GetSize());
+    SystemAbstractions::IFile::Buffer buffer(5);
+    ASSERT_EQ(5, mappedFile.Peek(buffer));
+    EXPECT_EQ("Hello", std::string(buffer.begin(), buffer.end()));
+    EXPECT_EQ(0, mappedFile.GetPosition());
+    ASSERT_EQ(5, mappedFile.Read(buffer));
+    EXPECT_EQ("Hello", std::string(buffer.begin(), buffer.end()));
+    EXPECT_EQ(5, mappedFile.GetPosition());
+    mappedFile.SetPosition(7);
+    ASSERT_EQ(5, mappedFile.Read(buffer));
+    EXPECT_EQ("World", std::string(buffer.begin(), buffer.end()));
+    ASSERT_EQ(1, mappedFile.Read(buffer));
+    EXPECT_EQ('!', buffer[0]);
+    ASSERT_EQ(0, mappedFile.Read(buffer));
+    EXPECT_EQ(0, mappedFile.Write(buffer));
+    EXPECT_FALSE(mappedFile.SetSize(0));
+}
+
+TEST_F(MappedFileTests, GetRange) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadWrite());
+    const std::string testString("Hello, World!");
+    (void)file.Write(testString.data(), testString.length());
+    file.Close();
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    auto range = mappedFile.GetRange(0, 5);
+    EXPECT_EQ(0, range.size);
+    ASSERT_TRUE(mappedFile.OpenReadOnly());
+    range = mappedFile.GetRange(7, 5);
+    ASSERT_EQ(5, range.size);
+    EXPECT_EQ("World", std::string((const char*)range.data, range.size));
+    range = mappedFile.GetRange(7, 100);
+    ASSERT_EQ(6, range.size);
+    EXPECT_EQ("World!", std::string((const char*)range.data, range.size));
+    range = mappedFile.GetRange(13, 5);
+    EXPECT_EQ(0, range.size);
+    range = mappedFile.GetRange(0, testString.length());
+    EXPECT_EQ(testString, std::string((const char*)range.data, range.size));
+    EXPECT_EQ(0, mappedFile.GetPosition());
+}
+
+TEST_F(MappedFileTests, WriteBeyondEndAndReadBackNormally) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    ASSERT_TRUE(mappedFile.OpenReadWrite());
+    EXPECT_EQ(0, mappedFile.GetSize());
+    const std::string firstPart("Hello, ");
+    const std::string secondPart("World!");
+    ASSERT_EQ(firstPart.length(), mappedFile.Write(firstPart.data(), firstPart.length()));
+    ASSERT_EQ(secondPart.length(), mappedFile.Write(secondPart.data(), secondPart.length()));
+    EXPECT_EQ(firstPart.length() + secondPart.length(), mappedFile.GetSize());
+    mappedFile.SetPosition(0);
+    ASSERT_EQ(1, mappedFile.Write("J", 1));
+    ASSERT_TRUE(mappedFile.SetSize(5));
+    mappedFile.Close();
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadOnly());
+    SystemAbstractions::IFile::Buffer buffer(100);
+    ASSERT_EQ(5, file.Read(buffer));
+    EXPECT_EQ("Jello", std::string(buffer.begin(), buffer.begin() + 5));
+}
+
+TEST_F(MappedFileTests, OpenReadOnlyMissingFile) {
+    SystemAbstractions::MappedFile mappedFile(testAreaPath + "/foo.txt");
+    EXPECT_FALSE(mappedFile.OpenReadOnly());
+    EXPECT_EQ(0, mappedFile.GetSize());
+}
+
+TEST_F(MappedFileTests, Clone) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    ASSERT_TRUE(mappedFile.OpenReadWrite());
+    const std::string testString("Hello, World!");
+    (void)mappedFile.Write(testString.data(), testString.length());
+    const auto clone = mappedFile.Clone();
+    ASSERT_FALSE(clone == nullptr);
+    EXPECT_EQ(testString.length(), clone->GetSize());
+    EXPECT_EQ(0, clone->GetPosition());
+    SystemAbstractions::IFile::Buffer buffer(testString.length());
+    ASSERT_EQ(testString.length(), clone->Read(buffer));
+    EXPECT_EQ(testString, std::string(buffer.begin(), buffer.end()));
+    clone->SetPosition(0);
+    ASSERT_EQ(1, clone->Write("J", 1));
+    mappedFile.SetPosition(0);
+    ASSERT_EQ(1, mappedFile.Read(buffer, 1));
+    EXPECT_EQ('J', buffer[0]);
+}
+
+TEST_F(MappedFileTests, ReadAtAndWriteAtDoNotMovePosition) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    ASSERT_TRUE(mappedFile.OpenReadWrite());
+    const std::string testString("Hello, World!");
+    ASSERT_EQ(testString.length(), mappedFile.WriteAt(0, testString.data(), testString.length()));
+    ASSERT_EQ(0, mappedFile.GetPosition());
+    ASSERT_EQ(1, mappedFile.WriteAt(0, "J", 1));
+    char buffer[5];
+    ASSERT_EQ(5, mappedFile.ReadAt(7, buffer, sizeof(buffer)));
+    EXPECT_EQ("World", std::string(buffer, sizeof(buffer)));
+    ASSERT_EQ(5, mappedFile.ReadAt(0, buffer, sizeof(buffer)));
+    EXPECT_EQ("Jello", std::string(buffer, sizeof(buffer)));
+    EXPECT_EQ(0, mappedFile.GetPosition());
+}
+
+TEST_F(MappedFileTests, AppendManyTimes) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    ASSERT_TRUE(mappedFile.OpenReadWrite());
+    const std::string testString("0123456789");
+    for (size_t i = 0; i < 10000; ++i) {
+        ASSERT_EQ(testString.length(), mappedFile.Write(testString.data(), testString.length()));
+    }
+    EXPECT_EQ(testString.length() * 10000, mappedFile.GetSize());
+    char buffer[10];
+    ASSERT_EQ(sizeof(buffer), mappedFile.ReadAt(testString.length() * 9999, buffer, sizeof(buffer)));
+    EXPECT_EQ(testString, std::string(buffer, sizeof(buffer)));
+    EXPECT_EQ(0, mappedFile.ReadAt(testString.length() * 10000, buffer, sizeof(buffer)));
+    mappedFile.Close();
+    SystemAbstractions::File file(testFilePath);
+    ASSERT_TRUE(file.OpenReadOnly());
+    EXPECT_EQ(testString.length() * 10000, file.GetSize());
+}
+
+TEST_F(MappedFileTests, ShrinkThenGrowReadsZeros) {
+    const std::string testFilePath = testAreaPath + "/foo.txt";
+    SystemAbstractions::MappedFile mappedFile(testFilePath);
+    ASSERT_TRUE(mappedFile.OpenReadWrite());
+    const std::string testString("Hello, World!");
+    ASSERT_EQ(testString.length(), mappedFile.Write(testString.data(), testString.length()));
+    ASSERT_TRUE(mappedFile.SetSize(5));
+    EXPECT_EQ(5, mappedFile.GetSize());
+    ASSERT_TRUE(mappedFile.SetSize(7));
+    ASSERT_EQ(1, mappedFile.WriteAt(9, "!", 1));
+    EXPECT_EQ(10, mappedFile.GetSize());
+    char buffer[10];
+    ASSERT_EQ(sizeof(buffer), mappedFile.ReadAt(0, buffer, sizeof(buffer)));
+    EXPECT_EQ(std::string("Hello\0\0\0\0!", 10), std::string(buffer, sizeof(buffer)));
+    const auto clone = mappedFile.Clone();
+    ASSERT_FALSE(clone == nullptr);
+    EXPECT_EQ(10, clone->GetSize());
+}
@@ -0,0 +1,158 @@
+/**
+ * @file MpscQueueTests.cpp
+ *
+ * This module contains the unit tests of the
+ * SystemAbstractions::MpscQueue class template.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <MpscQueue.hpp>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+TEST(MpscQueueTests, CapacityRoundedUpToPowerOfTwo) {
+    // Arrange
+    SystemAbstractions::MpscQueue< int > q(5);
+
+    // Act
+    const auto capacity = q.GetCapacity();
+
+    // Assert
+    EXPECT_EQ(8, capacity);
+}
+
+TEST(MpscQueueTests, PushAndPopInOrder) {
+    // Arrange
+    SystemAbstractions::MpscQueue< int > q(4);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(q.TryPush([i](int& item){ item = i; }));
+    }
+
+    // Act
+    std::vector< int > popped;
+    while (q.TryPop([&popped](int& item){ popped.push_back(item); })) {
+    }
+
+    // Assert
+    EXPECT_EQ(std::vector< int >({0, 1, 2}), popped);
+}
+
+TEST(MpscQueueTests, PushFailsWhenFull) {
+    // Arrange
+    SystemAbstractions::MpscQueue< int > q(2);
+    ASSERT_TRUE(q.TryPush([](int& item){ item = 1; }));
+    ASSERT_TRUE(q.TryPush([](int& item){ item = 2; }));
+
+    // Act
+    const auto pushedWhenFull = q.TryPush([](int& item){ item = 3; });
+    ASSERT_TRUE(q.TryPop([](int&){}));
+    const auto pushedAfterPop = q.TryPush([](int& item){ item = 3; });
+
+    // Assert
+    EXPECT_FALSE(pushedWhenFull);
+    EXPECT_TRUE(pushedAfterPop);
+}
+
+TEST(MpscQueueTests, PositionsCoverSlotsStillBeingFilled) {
+    // Arrange
+    SystemAbstractions::MpscQueue< int > q(4);
+    bool poppedWhileFilling = true;
+    size_t pushPositionWhileFilling = 0;
+    size_t popPositionWhileFilling = 0;
+
+    // Act
+    ASSERT_TRUE(
+        q.TryPush(
+            [&](int& item){
+                ASSERT_TRUE(q.TryPush([](int& item){ item = 2; }));
+                poppedWhileFilling = q.TryPop([](int&){});
+                pushPositionWhileFilling = q.GetPushPosition();
+                popPositionWhileFilling = q.GetPopPosition();
+                item = 1;
+            }
+        )
+    );
+    std::vector< int > popped;
+    while (q.TryPop([&popped](int& item){ popped.push_back(item); })) {
+    }
+
+    // Assert
+    EXPECT_FALSE(poppedWhileFilling);
+    EXPECT_EQ(2, pushPositionWhileFilling);
+    EXPECT_EQ(0, popPositionWhileFilling);
+    EXPECT_EQ(std::vector< int >({1, 2}), popped);
+    EXPECT_EQ(2, q.GetPopPosition());
+}
+
+TEST(MpscQueueTests, ItemsStayInSlotsForReuse) {
+    // Arrange
+    SystemAbstractions::MpscQueue< std::vector< int > > q(1);
+    std::vector< int > buffer(100, 42);
+    const auto bufferMemory = buffer.data();
+    ASSERT_TRUE(q.TryPush([&buffer](std::vector< int >& item){ item.swap(buffer); }));
+    ASSERT_TRUE(q.TryPop([](std::vector< int >& item){ item.clear(); }));
+
+    // Act
+    std::vector< int > reused;
+    ASSERT_TRUE(q.TryPush([](std::vector< int >& item){ item.push_back(7); }));
+    ASSERT_TRUE(q.TryPop([&reused](std::vector< int >& item){ reused.swap(item); }));
+
+    // Assert
+    EXPECT_EQ(bufferMemory, reused.data());
+    EXPECT_EQ(std::vector< int >({7}), reused);
+}
+
+TEST(MpscQueueTests, ManyProducers) {
+    // Arrange
+    constexpr size_t numProducers = 4;
+    constexpr size_t itemsPerProducer = 10000;
+    SystemAbstractions::MpscQueue< size_t > q(64);
+    std::vector< std::thread > producers;
+
+    // Act
+    for (size_t producer = 0; producer < numProducers; ++producer) {
+        producers.emplace_back(
+            [&q, producer]{
+                for (size_t i = 0; i < itemsPerProducer; ++i) {
+                    const auto value = producer * itemsPerProducer + i;
+                    while (!q.TryPush([value](size_t& item){ item = value; })) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        );
+    }
+    std::vector< size_t > nextExpected(numProducers);
+    size_t numPopped = 0;
+    bool inOrder = true;
+    while (numPopped < numProducers * itemsPerProducer) {
+        if (
+            !q.TryPop(
+                [&nextExpected, &inOrder](size_t& item){
+                    const auto producer = item / itemsPerProducer;
+                    if (item % itemsPerProducer != nextExpected[producer]) {
+                        inOrder = false;
+                    }
+                    ++nextExpected[producer];
+                }
+            )
+        ) {
+            std::this_thread::yield();
+            continue;
+        }
+        ++numPopped;
+    }
+    for (auto& producer: producers) {
+        producer.join();
+    }
+
+    // Assert
+    EXPECT_TRUE(inOrder);
+    for (size_t producer = 0; producer < numProducers; ++producer) {
+        EXPECT_EQ(itemsPerProducer, nextExpected[producer]);
+    }
+    EXPECT_FALSE(q.TryPop([](size_t&){}));
+}
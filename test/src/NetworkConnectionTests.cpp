@@ -556,6 +556,158 @@ TEST_F(NetworkConnectionTests, SendingMessage) {
     ASSERT_EQ(messageAsVector, serverConnectionOwner.streamReceived);
 }
 
+TEST_F(NetworkConnectionTests, SendingMessageWithoutCopying) {
+    SystemAbstractions::NetworkEndpoint server;
+    Owner serverConnectionOwner;
+    std::vector< std::shared_ptr< SystemAbstractions::NetworkConnection > > clients;
+    std::condition_variable_any callbackCondition;
+    std::mutex callbackMutex;
+    const auto newConnectionDelegate = [
+        &clients,
+        &callbackCondition,
+        &callbackMutex,
+        &serverConnectionOwner
+    ](
+        std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+    ){
+        std::unique_lock< std::mutex > lock(callbackMutex);
+        clients.push_back(newConnection);
+        ASSERT_TRUE(
+            newConnection->Process(
+                [&serverConnectionOwner](const std::vector< uint8_t >& message){
+                    serverConnectionOwner.NetworkConnectionMessageReceived(message);
+                },
+                [&serverConnectionOwner](bool graceful){
+                    serverConnectionOwner.NetworkConnectionBroken(graceful);
+                }
+            )
+        );
+        callbackCondition.notify_all();
+    };
+    const auto packetReceivedDelegate = [](
+        uint32_t,
+        uint16_t,
+        const std::vector< uint8_t >&
+    ){
+    };
+    ASSERT_TRUE(
+        server.Open(
+            newConnectionDelegate,
+            packetReceivedDelegate,
+            SystemAbstractions::NetworkEndpoint::Mode::Connection,
+            0x7F000001,
+            0,
+            0
+        )
+    );
+    ASSERT_TRUE(client.Connect(0x7F000001, server.GetBoundPort()));
+    auto clientOwnerCopy = clientOwner;
+    ASSERT_TRUE(
+        client.Process(
+            [clientOwnerCopy](const std::vector< uint8_t >& message){
+                clientOwnerCopy->NetworkConnectionMessageReceived(message);
+            },
+            [clientOwnerCopy](bool graceful){
+                clientOwnerCopy->NetworkConnectionBroken(graceful);
+            }
+        )
+    );
+    const std::string ownedMessageAsString("Hello, ");
+    std::vector< uint8_t > ownedMessageAsVector(ownedMessageAsString.begin(), ownedMessageAsString.end());
+    const std::string sharedMessageAsString("World!");
+    const auto sharedMessageAsVector = std::make_shared< const std::vector< uint8_t > >(
+        sharedMessageAsString.begin(),
+        sharedMessageAsString.end()
+    );
+    client.SendMessage(std::move(ownedMessageAsVector));
+    client.SendMessage(sharedMessageAsVector);
+    const std::string expectedStreamAsString("Hello, World!");
+    const std::vector< uint8_t > expectedStream(expectedStreamAsString.begin(), expectedStreamAsString.end());
+    ASSERT_TRUE(serverConnectionOwner.AwaitStream(expectedStream.size()));
+    ASSERT_EQ(expectedStream, serverConnectionOwner.streamReceived);
+    ASSERT_EQ(
+        std::vector< uint8_t >(sharedMessageAsString.begin(), sharedMessageAsString.end()),
+        *sharedMessageAsVector
+    );
+}
+
+TEST_F(NetworkConnectionTests, ReceivingMessageInOwnedBuffers) {
+    SystemAbstractions::NetworkEndpoint server;
+    Owner serverConnectionOwner;
+    std::vector< std::shared_ptr< SystemAbstractions::NetworkConnection > > clients;
+    std::vector< std::shared_ptr< std::vector< uint8_t > > > buffersReceived;
+    std::condition_variable_any callbackCondition;
+    std::mutex callbackMutex;
+    const auto newConnectionDelegate = [
+        &clients,
+        &buffersReceived,
+        &callbackCondition,
+        &callbackMutex,
+        &serverConnectionOwner
+    ](
+        std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+    ){
+        std::unique_lock< std::mutex > lock(callbackMutex);
+        clients.push_back(newConnection);
+        ASSERT_TRUE(
+            newConnection->Process(
+                [&buffersReceived, &serverConnectionOwner](std::shared_ptr< std::vector< uint8_t > > message){
+                    buffersReceived.push_back(message);
+                    serverConnectionOwner.NetworkConnectionMessageReceived(*message);
+                },
+                [&serverConnectionOwner](bool graceful){
+                    serverConnectionOwner.NetworkConnectionBroken(graceful);
+                }
+            )
+        );
+        callbackCondition.notify_all();
+    };
+    const auto packetReceivedDelegate = [](
+        uint32_t,
+        uint16_t,
+        const std::vector< uint8_t >&
+    ){
+    };
+    ASSERT_TRUE(
+        server.Open(
+            newConnectionDelegate,
+            packetReceivedDelegate,
+            SystemAbstractions::NetworkEndpoint::Mode::Connection,
+            0x7F000001,
+            0,
+            0
+        )
+    );
+    ASSERT_TRUE(client.Connect(0x7F000001, server.GetBoundPort()));
+    auto clientOwnerCopy = clientOwner;
+    ASSERT_TRUE(
+        client.Process(
+            [clientOwnerCopy](const std::vector< uint8_t >& message){
+                clientOwnerCopy->NetworkConnectionMessageReceived(message);
+            },
+            [clientOwnerCopy](bool graceful){
+                clientOwnerCopy->NetworkConnectionBroken(graceful);
+            }
+        )
+    );
+    const std::string firstMessageAsString("Hello, ");
+    const std::vector< uint8_t > firstMessage(firstMessageAsString.begin(), firstMessageAsString.end());
+    client.SendMessage(firstMessage);
+    ASSERT_TRUE(serverConnectionOwner.AwaitStream(firstMessage.size()));
+    const std::string secondMessageAsString("World!");
+    const std::vector< uint8_t > secondMessage(secondMessageAsString.begin(), secondMessageAsString.end());
+    client.SendMessage(secondMessage);
+    const std::string expectedStreamAsString("Hello, World!");
+    const std::vector< uint8_t > expectedStream(expectedStreamAsString.begin(), expectedStreamAsString.end());
+    ASSERT_TRUE(serverConnectionOwner.AwaitStream(expectedStream.size()));
+    ASSERT_EQ(expectedStream, serverConnectionOwner.streamReceived);
+    std::vector< uint8_t > bufferedStream;
+    for (const auto& buffer: buffersReceived) {
+        bufferedStream.insert(bufferedStream.end(), buffer->begin(), buffer->end());
+    }
+    ASSERT_EQ(expectedStream, bufferedStream);
+}
+
 TEST_F(NetworkConnectionTests, ReceivingMessage) {
     SystemAbstractions::NetworkEndpoint server;
     Owner serverConnectionOwner;
@@ -1419,3 +1571,121 @@ TEST_F(NetworkConnectionTests, ReleaseFromDelegate) {
         wasClosed.wait_for(std::chrono::milliseconds(1000))
     );
 }
+
+TEST_F(NetworkConnectionTests, SharedEventLoop) {
+    // Switch to the shared event loop, if supported.
+    if (
+        !SystemAbstractions::NetworkConnection::SetProcessingModel(
+            SystemAbstractions::NetworkConnection::ProcessingModel::SharedEventLoop,
+            2
+        )
+    ) {
+        return;
+    }
+    std::shared_ptr< int > restoreProcessingModel(
+        nullptr,
+        [](int*){
+            (void)SystemAbstractions::NetworkConnection::SetProcessingModel(
+                SystemAbstractions::NetworkConnection::ProcessingModel::ThreadPerConnection
+            );
+        }
+    );
+
+    // Set up a server which echoes back anything it receives.
+    SystemAbstractions::NetworkEndpoint server;
+    std::mutex serverMutex;
+    std::vector< std::shared_ptr< SystemAbstractions::NetworkConnection > > serverConnections;
+    const auto newConnectionDelegate = [&serverMutex, &serverConnections](
+        std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+    ){
+        std::lock_guard< std::mutex > lock(serverMutex);
+        serverConnections.push_back(newConnection);
+        const std::weak_ptr< SystemAbstractions::NetworkConnection > weakConnection(newConnection);
+        (void)newConnection->Process(
+            [weakConnection](const std::vector< uint8_t >& message){
+                const auto connection = weakConnection.lock();
+                if (connection != nullptr) {
+                    connection->SendMessage(message);
+                }
+            },
+            [weakConnection](bool){
+                const auto connection = weakConnection.lock();
+                if (connection != nullptr) {
+                    connection->Close(true);
+                }
+            }
+        );
+    };
+    const auto packetReceivedDelegate = [](
+        uint32_t,
+        uint16_t,
+        const std::vector< uint8_t >&
+    ){
+    };
+    ASSERT_TRUE(
+        server.Open(
+            newConnectionDelegate,
+            packetReceivedDelegate,
+            SystemAbstractions::NetworkEndpoint::Mode::Connection,
+            0x7F000001,
+            0,
+            0
+        )
+    );
+
+    // Connect a number of clients, exceeding the number of event loop
+    // threads, and have each send a message.
+    constexpr size_t numClients = 20;
+    std::vector< std::shared_ptr< SystemAbstractions::NetworkConnection > > clients;
+    std::vector< std::shared_ptr< Owner > > owners;
+    for (size_t i = 0; i < numClients; ++i) {
+        const auto client = std::make_shared< SystemAbstractions::NetworkConnection >();
+        const auto owner = std::make_shared< Owner >();
+        ASSERT_TRUE(client->Connect(0x7F000001, server.GetBoundPort()));
+        ASSERT_TRUE(
+            client->Process(
+                [owner](const std::vector< uint8_t >& message){
+                    owner->NetworkConnectionMessageReceived(message);
+                },
+                [owner](bool graceful){
+                    owner->NetworkConnectionBroken(graceful);
+                }
+            )
+        );
+        const auto messageAsString = StringExtensions::sprintf("Hello from client %zu!", i);
+        client->SendMessage(
+            std::vector< uint8_t >(messageAsString.begin(), messageAsString.end())
+        );
+        clients.push_back(client);
+        owners.push_back(owner);
+    }
+
+    // Verify each client gets its own message echoed back.
+    for (size_t i = 0; i < numClients; ++i) {
+        const auto messageAsString = StringExtensions::sprintf("Hello from client %zu!", i);
+        ASSERT_TRUE(owners[i]->AwaitStream(messageAsString.length()));
+        EXPECT_EQ(
+            messageAsString,
+            std::string(
+                owners[i]->streamReceived.begin(),
+                owners[i]->streamReceived.end()
+            )
+        );
+    }
+
+    // Close each client gracefully, and verify the server
+    // closes its end in response.
+    for (size_t i = 0; i < numClients; ++i) {
+        clients[i]->Close(true);
+    }
+    for (size_t i = 0; i < numClients; ++i) {
+        ASSERT_TRUE(owners[i]->AwaitDisconnection());
+    }
+    const auto startTime = time(NULL);
+    for (size_t i = 0; i < numClients; ++i) {
+        while (clients[i]->IsConnected()) {
+            ASSERT_FALSE(time(NULL) - startTime > 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+}
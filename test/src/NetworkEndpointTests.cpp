@@ -7,10 +7,13 @@
  * © 2018 by Richard Walters
  */
 
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <condition_variable>
 #include <mutex>
 #include <SystemAbstractions/NetworkEndpoint.hpp>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 /**
@@ -109,6 +112,11 @@ namespace {
          */
         std::vector< Packet > packetsReceived;
 
+        /**
+         * This counts the number of batches of packets received.
+         */
+        size_t batchesReceived = 0;
+
         /**
          * This holds the data received from a connection-oriented stream.
          */
@@ -148,6 +156,29 @@ namespace {
             );
         }
 
+        /**
+         * This method waits up to a second for the given number
+         * of packets to be received at the network endpoint.
+         *
+         * @param[in] numPackets
+         *     This is the number of packets we expect to receive.
+         *
+         * @return
+         *     An indication of whether or not the given number
+         *     of packets were received at the network endpoint
+         *     is returned.
+         */
+        bool AwaitPackets(size_t numPackets) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            return condition.wait_for(
+                lock,
+                std::chrono::seconds(1),
+                [this, numPackets]{
+                    return (packetsReceived.size() >= numPackets);
+                }
+            );
+        }
+
         /**
          * This method waits up to a second for the given number
          * of bytes to be received from a client connected
@@ -279,6 +310,29 @@ namespace {
             condition.notify_all();
         }
 
+        /**
+         * This is the callback issued whenever one or more
+         * datagram-oriented messages are received by the network
+         * endpoint, when configured to receive them in batches.
+         *
+         * @param[in] packets
+         *     These are the datagrams received.
+         */
+        void NetworkEndpointPacketsReceived(
+            const std::vector< SystemAbstractions::NetworkEndpoint::ReceivedPacket >& packets
+        ) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            for (const auto& packet: packets) {
+                packetsReceived.emplace_back(
+                    std::vector< uint8_t >(packet.body, packet.body + packet.bodySize),
+                    packet.address,
+                    packet.port
+                );
+            }
+            ++batchesReceived;
+            condition.notify_all();
+        }
+
         /**
          * This is the callback issued whenever more data
          * is received from the peer of the connection.
@@ -407,6 +461,82 @@ TEST_F(NetworkEndpointTests, DatagramSending) {
     ASSERT_EQ(endpoint.GetBoundPort(), ntohs(senderAddress.sin_port));
 }
 
+TEST_F(NetworkEndpointTests, DatagramSendingFromManyThreads) {
+    // Set up a datagram socket to test sending from NetworkEndpoint.
+    auto receiver = socket(AF_INET, SOCK_DGRAM, 0);
+#if _WIN32
+    ASSERT_FALSE(receiver == INVALID_SOCKET);
+#else /* POSIX */
+    ASSERT_FALSE(receiver < 0);
+#endif /* _WIN32 or POSIX */
+    struct sockaddr_in receiverAddress;
+    (void)memset(&receiverAddress, 0, sizeof(receiverAddress));
+    receiverAddress.sin_family = AF_INET;
+    receiverAddress.IPV4_ADDRESS_IN_SOCKADDR = 0;
+    receiverAddress.sin_port = 0;
+    ASSERT_TRUE(bind(receiver, (struct sockaddr*)&receiverAddress, sizeof(receiverAddress)) == 0);
+    SOCKADDR_LENGTH_TYPE receiverAddressLength = sizeof(receiverAddress);
+    uint16_t port;
+    ASSERT_TRUE(getsockname(receiver, (struct sockaddr*)&receiverAddress, &receiverAddressLength) == 0);
+    port = ntohs(receiverAddress.sin_port);
+
+    // Set up the NetworkEndpoint.
+    SystemAbstractions::NetworkEndpoint endpoint;
+    Owner owner;
+    endpoint.Open(
+        [&owner](
+            std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+        ){ owner.NetworkEndpointNewConnection(newConnection); },
+        [&owner](
+            uint32_t address,
+            uint16_t port,
+            const std::vector< uint8_t >& body
+        ){ owner.NetworkEndpointPacketReceived(address, port, body); },
+        SystemAbstractions::NetworkEndpoint::Mode::Datagram,
+        0,
+        0,
+        0
+    );
+
+    // Send datagrams from several threads at once.  Each datagram
+    // identifies the thread that sent it and its sequence number
+    // from that thread.
+    constexpr size_t numSenders = 4;
+    constexpr size_t packetsPerSender = 50;
+    std::vector< std::thread > senders;
+    for (size_t sender = 0; sender < numSenders; ++sender) {
+        senders.emplace_back(
+            [&endpoint, port, sender]{
+                for (size_t i = 0; i < packetsPerSender; ++i) {
+                    const std::vector< uint8_t > testPacket{ (uint8_t)sender, (uint8_t)i };
+                    endpoint.SendPacket(0x7F000001, port, testPacket);
+                }
+            }
+        );
+    }
+    for (auto& sender: senders) {
+        sender.join();
+    }
+
+    // Verify that we received all the datagrams, and that the ones
+    // from each thread arrived in the order sent.
+    std::vector< size_t > nextExpected(numSenders);
+    for (size_t i = 0; i < numSenders * packetsPerSender; ++i) {
+        std::vector< uint8_t > buffer(4);
+        const int amountReceived = recv(
+            receiver,
+            (char*)buffer.data(),
+            (int)buffer.size(),
+            0
+        );
+        ASSERT_EQ(2, amountReceived);
+        const auto sender = (size_t)buffer[0];
+        ASSERT_LT(sender, numSenders);
+        EXPECT_EQ(nextExpected[sender], (size_t)buffer[1]);
+        ++nextExpected[sender];
+    }
+}
+
 TEST_F(NetworkEndpointTests, DatagramReceiving) {
     // Set up a datagram socket to test sending to NetworkEndpoint.
     auto sender = socket(AF_INET, SOCK_DGRAM, 0);
@@ -467,6 +597,141 @@ TEST_F(NetworkEndpointTests, DatagramReceiving) {
     ASSERT_EQ(ntohs(senderAddress.sin_port), owner.packetsReceived[0].port);
 }
 
+TEST_F(NetworkEndpointTests, DatagramReceivingInBatches) {
+    // Set up a datagram socket to test sending to NetworkEndpoint.
+    auto sender = socket(AF_INET, SOCK_DGRAM, 0);
+#if _WIN32
+    ASSERT_FALSE(sender == INVALID_SOCKET);
+#else /* POSIX */
+    ASSERT_FALSE(sender < 0);
+#endif /* _WIN32 or POSIX */
+    struct sockaddr_in senderAddress;
+    (void)memset(&senderAddress, 0, sizeof(senderAddress));
+    senderAddress.sin_family = AF_INET;
+    senderAddress.IPV4_ADDRESS_IN_SOCKADDR = 0;
+    senderAddress.sin_port = 0;
+    ASSERT_TRUE(bind(sender, (struct sockaddr*)&senderAddress, sizeof(senderAddress)) == 0);
+    SOCKADDR_LENGTH_TYPE senderAddressLength = sizeof(senderAddress);
+    ASSERT_TRUE(getsockname(sender, (struct sockaddr*)&senderAddress, &senderAddressLength) == 0);
+
+    // Set up the NetworkEndpoint.
+    SystemAbstractions::NetworkEndpoint endpoint;
+    Owner owner;
+    ASSERT_TRUE(
+        endpoint.Open(
+            [&owner](
+                std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+            ){ owner.NetworkEndpointNewConnection(newConnection); },
+            [&owner](
+                const std::vector< SystemAbstractions::NetworkEndpoint::ReceivedPacket >& packets
+            ){ owner.NetworkEndpointPacketsReceived(packets); },
+            SystemAbstractions::NetworkEndpoint::Mode::Datagram,
+            0,
+            0,
+            0,
+            4
+        )
+    );
+
+    // Test receiving several datagrams at the unit under test.
+    struct sockaddr_in receiverAddress;
+    (void)memset(&receiverAddress, 0, sizeof(receiverAddress));
+    receiverAddress.sin_family = AF_INET;
+    receiverAddress.IPV4_ADDRESS_IN_SOCKADDR = htonl(0x7F000001);
+    receiverAddress.sin_port = htons(endpoint.GetBoundPort());
+    constexpr size_t numPackets = 10;
+    for (size_t i = 0; i < numPackets; ++i) {
+        const std::vector< uint8_t > testPacket(i + 1, (uint8_t)i);
+        (void)sendto(
+            sender,
+            (const char*)testPacket.data(),
+            (int)testPacket.size(),
+            0,
+            (const sockaddr*)&receiverAddress,
+            sizeof(receiverAddress)
+        );
+    }
+
+    // Verify that we received the datagrams, in order, in no more
+    // batches than datagrams.
+    ASSERT_TRUE(owner.AwaitPackets(numPackets));
+    ASSERT_EQ(numPackets, owner.packetsReceived.size());
+    EXPECT_LE(owner.batchesReceived, numPackets);
+    for (size_t i = 0; i < numPackets; ++i) {
+        EXPECT_EQ(std::vector< uint8_t >(i + 1, (uint8_t)i), owner.packetsReceived[i].payload);
+        EXPECT_EQ(0x7F000001, owner.packetsReceived[i].address);
+        EXPECT_EQ(ntohs(senderAddress.sin_port), owner.packetsReceived[i].port);
+    }
+}
+
+TEST_F(NetworkEndpointTests, DatagramReceivingInBatchesCutsLargeDatagramsShort) {
+    // Set up a datagram socket to test sending to NetworkEndpoint.
+    auto sender = socket(AF_INET, SOCK_DGRAM, 0);
+#if _WIN32
+    ASSERT_FALSE(sender == INVALID_SOCKET);
+#else /* POSIX */
+    ASSERT_FALSE(sender < 0);
+#endif /* _WIN32 or POSIX */
+    struct sockaddr_in senderAddress;
+    (void)memset(&senderAddress, 0, sizeof(senderAddress));
+    senderAddress.sin_family = AF_INET;
+    senderAddress.IPV4_ADDRESS_IN_SOCKADDR = 0;
+    senderAddress.sin_port = 0;
+    ASSERT_TRUE(bind(sender, (struct sockaddr*)&senderAddress, sizeof(senderAddress)) == 0);
+    SOCKADDR_LENGTH_TYPE senderAddressLength = sizeof(senderAddress);
+    ASSERT_TRUE(getsockname(sender, (struct sockaddr*)&senderAddress, &senderAddressLength) == 0);
+
+    // Set up the NetworkEndpoint.
+    SystemAbstractions::NetworkEndpoint endpoint;
+    Owner owner;
+    ASSERT_TRUE(
+        endpoint.Open(
+            [&owner](
+                std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+            ){ owner.NetworkEndpointNewConnection(newConnection); },
+            [&owner](
+                const std::vector< SystemAbstractions::NetworkEndpoint::ReceivedPacket >& packets
+            ){ owner.NetworkEndpointPacketsReceived(packets); },
+            SystemAbstractions::NetworkEndpoint::Mode::Datagram,
+            0,
+            0,
+            0,
+            4,
+            4
+        )
+    );
+
+    // Test receiving datagrams both smaller and larger than
+    // the largest size expected by the unit under test.
+    struct sockaddr_in receiverAddress;
+    (void)memset(&receiverAddress, 0, sizeof(receiverAddress));
+    receiverAddress.sin_family = AF_INET;
+    receiverAddress.IPV4_ADDRESS_IN_SOCKADDR = htonl(0x7F000001);
+    receiverAddress.sin_port = htons(endpoint.GetBoundPort());
+    constexpr size_t numPackets = 8;
+    for (size_t i = 0; i < numPackets; ++i) {
+        const std::vector< uint8_t > testPacket(i + 1, (uint8_t)i);
+        (void)sendto(
+            sender,
+            (const char*)testPacket.data(),
+            (int)testPacket.size(),
+            0,
+            (const sockaddr*)&receiverAddress,
+            sizeof(receiverAddress)
+        );
+    }
+
+    // Verify that we received the datagrams, in order, with
+    // the larger ones cut short.
+    ASSERT_TRUE(owner.AwaitPackets(numPackets));
+    ASSERT_EQ(numPackets, owner.packetsReceived.size());
+    for (size_t i = 0; i < numPackets; ++i) {
+        EXPECT_EQ(std::vector< uint8_t >(std::min(i + 1, (size_t)4), (uint8_t)i), owner.packetsReceived[i].payload);
+        EXPECT_EQ(0x7F000001, owner.packetsReceived[i].address);
+        EXPECT_EQ(ntohs(senderAddress.sin_port), owner.packetsReceived[i].port);
+    }
+}
+
 TEST_F(NetworkEndpointTests, ConnectionSending) {
     // Set up a connection-oriented socket to test sending
     // from NetworkEndpoint.
@@ -756,3 +1021,71 @@ TEST_F(NetworkEndpointTests, MultipleConnections) {
     owner.AwaitStream(testPacket.size());
     ASSERT_EQ(testPacket, owner.streamReceived);
 }
+
+TEST_F(NetworkEndpointTests, ConnectionsOnSeveralListeners) {
+    // Set up the NetworkEndpoint.
+    SystemAbstractions::NetworkEndpoint endpoint;
+    Owner owner;
+    endpoint.SetNumListeners(4);
+    ASSERT_TRUE(
+        endpoint.Open(
+            [&owner](
+                std::shared_ptr< SystemAbstractions::NetworkConnection > newConnection
+            ){ owner.NetworkEndpointNewConnection(newConnection); },
+            [&owner](
+                uint32_t address,
+                uint16_t port,
+                const std::vector< uint8_t >& body
+            ){ owner.NetworkEndpointPacketReceived(address, port, body); },
+            SystemAbstractions::NetworkEndpoint::Mode::Connection,
+            0x7F000001,
+            0,
+            0
+        )
+    );
+
+    // Connect to the NetworkEndpoint many times.
+    constexpr size_t numClients = 32;
+    struct sockaddr_in receiverAddress;
+    (void)memset(&receiverAddress, 0, sizeof(receiverAddress));
+    receiverAddress.sin_family = AF_INET;
+    receiverAddress.IPV4_ADDRESS_IN_SOCKADDR = htonl(0x7F000001);
+    receiverAddress.sin_port = htons(endpoint.GetBoundPort());
+    std::vector< decltype(socket(AF_INET, SOCK_STREAM, 0)) > clients;
+    for (size_t i = 0; i < numClients; ++i) {
+        const auto client = socket(AF_INET, SOCK_STREAM, 0);
+#if _WIN32
+        ASSERT_FALSE(client == INVALID_SOCKET);
+#else /* POSIX */
+        ASSERT_FALSE(client < 0);
+#endif /* _WIN32 or POSIX */
+        clients.push_back(client);
+        ASSERT_TRUE(
+            connect(
+                client,
+                (const sockaddr*)&receiverAddress,
+                sizeof(receiverAddress)
+            ) == 0
+        );
+    }
+
+    // Verify that every connection was accepted, and that each one
+    // knows its local address.
+    ASSERT_TRUE(owner.AwaitConnections(numClients));
+    {
+        std::unique_lock< decltype(owner.mutex) > lock(owner.mutex);
+        EXPECT_EQ(numClients, owner.connections.size());
+        for (const auto& connection: owner.connections) {
+            EXPECT_EQ(0x7F000001, connection->GetBoundAddress());
+            EXPECT_EQ(endpoint.GetBoundPort(), connection->GetBoundPort());
+        }
+    }
+    endpoint.Close();
+    for (const auto client: clients) {
+#if _WIN32
+        (void)closesocket(client);
+#else /* POSIX */
+        (void)close(client);
+#endif /* _WIN32 or POSIX */
+    }
+}
@@ -7,11 +7,79 @@
  * © 2018 by Richard Walters
  */
 
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <stdint.h>
+#include <string>
 #include <SystemAbstractions/StringFile.hpp>
 #include <vector>
 
+namespace {
+
+    /**
+     * This is a file which wraps a StringFile, leaving out the
+     * ReadAt and WriteAt methods, in order to test the default
+     * implementations of them provided by IFile.
+     */
+    struct FileWithoutPositionalAccess
+        : public SystemAbstractions::IFile
+    {
+        // Properties
+
+        /**
+         * This is the file being wrapped.
+         */
+        SystemAbstractions::StringFile contents;
+
+        // IFile
+
+        virtual uint64_t GetSize() const override {
+            return contents.GetSize();
+        }
+
+        virtual bool SetSize(uint64_t size) override {
+            return contents.SetSize(size);
+        }
+
+        virtual uint64_t GetPosition() const override {
+            return contents.GetPosition();
+        }
+
+        virtual void SetPosition(uint64_t position) override {
+            contents.SetPosition(position);
+        }
+
+        virtual size_t Peek(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) const override {
+            return contents.Peek(buffer, numBytes, offset);
+        }
+
+        virtual size_t Peek(void* buffer, size_t numBytes) const override {
+            return contents.Peek(buffer, numBytes);
+        }
+
+        virtual size_t Read(Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override {
+            return contents.Read(buffer, numBytes, offset);
+        }
+
+        virtual size_t Read(void* buffer, size_t numBytes) override {
+            return contents.Read(buffer, numBytes);
+        }
+
+        virtual size_t Write(const Buffer& buffer, size_t numBytes = 0, size_t offset = 0) override {
+            return contents.Write(buffer, numBytes, offset);
+        }
+
+        virtual size_t Write(const void* buffer, size_t numBytes) override {
+            return contents.Write(buffer, numBytes);
+        }
+
+        virtual std::shared_ptr< IFile > Clone() override {
+            return contents.Clone();
+        }
+    };
+
+}
+
 TEST(StringFileTests, WriteAndReadBack) {
     SystemAbstractions::StringFile sf;
     const std::string testString = "Hello, World!\r\n";
@@ -374,3 +442,88 @@ TEST(StringFileTests, MoveAssignment) {
     (void)copy.Read(buffer);
     ASSERT_EQ("World", std::string(buffer.begin(), buffer.end()));
 }
+
+TEST(StringFileTests, ReadAtAndWriteAtDoNotMovePosition) {
+    SystemAbstractions::StringFile file("Hello, World!");
+    file.SetPosition(3);
+    ASSERT_EQ(1, file.WriteAt(0, "J", 1));
+    ASSERT_EQ(3, file.WriteAt(13, "!!!", 3));
+    ASSERT_EQ(16, file.GetSize());
+    ASSERT_EQ(3, file.GetPosition());
+    char buffer[5];
+    ASSERT_EQ(5, file.ReadAt(0, buffer, sizeof(buffer)));
+    ASSERT_EQ("Jello", std::string(buffer, sizeof(buffer)));
+    ASSERT_EQ(4, file.ReadAt(12, buffer, sizeof(buffer)));
+    ASSERT_EQ("!!!!", std::string(buffer, 4));
+    ASSERT_EQ(0, file.ReadAt(16, buffer, sizeof(buffer)));
+    ASSERT_EQ(0, file.ReadAt(100, buffer, sizeof(buffer)));
+    ASSERT_EQ(3, file.GetPosition());
+}
+
+TEST(StringFileTests, GetData) {
+    SystemAbstractions::StringFile sf("Hello, World!");
+    ASSERT_EQ(
+        "Hello, World!",
+        std::string((const char*)sf.GetData(), (size_t)sf.GetSize())
+    );
+    sf.Remove(7);
+    ASSERT_EQ(
+        "World!",
+        std::string((const char*)sf.GetData(), (size_t)sf.GetSize())
+    );
+}
+
+TEST(StringFileTests, RemoveAndWriteManyTimes) {
+    SystemAbstractions::StringFile sf;
+    std::string expected;
+    for (size_t i = 0; i < 1000; ++i) {
+        const auto piece = std::to_string(i) + ",";
+        sf.SetPosition(sf.GetSize());
+        (void)sf.Write(piece.data(), piece.length());
+        expected += piece;
+        if (i % 3 == 0) {
+            const auto numBytes = std::min((size_t)5, expected.length());
+            sf.Remove(numBytes);
+            expected.erase(0, numBytes);
+        }
+    }
+    ASSERT_EQ(expected, (std::string)sf);
+    ASSERT_EQ(expected.length(), sf.GetSize());
+    SystemAbstractions::IFile::Buffer buffer(10);
+    ASSERT_EQ(10, sf.ReadAt(0, buffer.data(), buffer.size()));
+    ASSERT_EQ(expected.substr(0, 10), std::string(buffer.begin(), buffer.end()));
+}
+
+TEST(StringFileTests, MoveVectorInAndOut) {
+    std::vector< uint8_t > testVector{'H', 'e', 'l', 'l', 'o'};
+    const auto testVectorData = testVector.data();
+    SystemAbstractions::StringFile sf(std::move(testVector));
+    ASSERT_EQ(testVectorData, sf.GetData());
+    sf.SetPosition(5);
+    (void)sf.Write(", World!", 8);
+    auto released = sf.Release();
+    ASSERT_EQ("Hello, World!", std::string(released.begin(), released.end()));
+    ASSERT_EQ(0, sf.GetSize());
+    ASSERT_EQ(0, sf.GetPosition());
+    const auto releasedData = released.data();
+    sf = std::move(released);
+    ASSERT_EQ(releasedData, sf.GetData());
+    ASSERT_EQ(13, sf.GetSize());
+    sf.Remove(7);
+    released = sf.Release();
+    ASSERT_EQ("World!", std::string(released.begin(), released.end()));
+}
+
+TEST(StringFileTests, DefaultReadAtAndWriteAtDoNotMovePosition) {
+    FileWithoutPositionalAccess file;
+    file.contents = "Hello, World!";
+    file.SetPosition(3);
+    SystemAbstractions::IFile& iFile = file;
+    ASSERT_EQ(5, iFile.WriteAt(7, "Bobby", 5));
+    EXPECT_EQ(3, file.GetPosition());
+    char buffer[5];
+    ASSERT_EQ(5, iFile.ReadAt(0, buffer, sizeof(buffer)));
+    EXPECT_EQ("Hello", std::string(buffer, sizeof(buffer)));
+    EXPECT_EQ(3, file.GetPosition());
+    EXPECT_EQ("Hello, Bobby!", (std::string)file.contents);
+}
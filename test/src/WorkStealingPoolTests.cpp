@@ -0,0 +1,80 @@
+/**
+ * @file WorkStealingPoolTests.cpp
+ *
+ * This module contains the unit tests of the
+ * SystemAbstractions::WorkStealingPool class.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <atomic>
+#include <functional>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <WorkStealingPool.hpp>
+
+TEST(WorkStealingPoolTests, RunSubmittedTasks) {
+    // Arrange
+    SystemAbstractions::WorkStealingPool pool(4);
+    std::atomic< size_t > tasksRun(0);
+
+    // Act
+    for (size_t i = 0; i < 100; ++i) {
+        pool.Submit([&tasksRun]{ ++tasksRun; });
+    }
+    pool.Wait();
+
+    // Assert
+    EXPECT_EQ(100, tasksRun);
+}
+
+TEST(WorkStealingPoolTests, WaitIncludesTasksSubmittedByTasks) {
+    // Arrange
+    SystemAbstractions::WorkStealingPool pool(4);
+    std::atomic< size_t > leavesReached(0);
+    std::function< void(size_t depth) > walk;
+    walk = [&pool, &walk, &leavesReached](size_t depth){
+        if (depth == 0) {
+            ++leavesReached;
+            return;
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            pool.Submit([&walk, depth]{ walk(depth - 1); });
+        }
+    };
+
+    // Act
+    pool.Submit([&walk]{ walk(5); });
+    pool.Wait();
+
+    // Assert
+    EXPECT_EQ(1024, leavesReached);
+}
+
+TEST(WorkStealingPoolTests, IdleThreadsStealWork) {
+    // Arrange
+    SystemAbstractions::WorkStealingPool pool(4);
+    std::mutex mutex;
+    std::set< std::thread::id > threadsUsed;
+
+    // Act
+    pool.Submit(
+        [&]{
+            for (size_t i = 0; i < 100; ++i) {
+                pool.Submit(
+                    [&]{
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        std::lock_guard< decltype(mutex) > lock(mutex);
+                        (void)threadsUsed.insert(std::this_thread::get_id());
+                    }
+                );
+            }
+        }
+    );
+    pool.Wait();
+
+    // Assert
+    EXPECT_GT(threadsUsed.size(), 1);
+}
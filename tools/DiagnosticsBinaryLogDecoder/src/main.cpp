@@ -0,0 +1,70 @@
+/**
+ * @file main.cpp
+ *
+ * This module contains a program which renders a binary log, recorded
+ * by the delegate returned by SystemAbstractions::DiagnosticsBinaryLogReporter,
+ * as text, in the same form as SystemAbstractions::DiagnosticsStreamReporter.
+ *
+ * Usage: DiagnosticsBinaryLogDecoder [LOG]
+ *
+ * LOG is the path to the binary log to render (default is to read
+ * the log from standard input).  Messages are written to standard output.
+ *
+ * © 2018 by Richard Walters
+ */
+
+#include <stdio.h>
+#include <string>
+#include <SystemAbstractions/DiagnosticsBinaryLog.hpp>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif /* _WIN32 */
+
+int main(int argc, char* argv[]) {
+    FILE* log = stdin;
+    if (argc >= 2) {
+        log = fopen(argv[1], "rb");
+        if (log == NULL) {
+            (void)fprintf(stderr, "error: unable to open '%s'\n", argv[1]);
+            return 1;
+        }
+    } else {
+#ifdef _WIN32
+        (void)_setmode(_fileno(stdin), _O_BINARY);
+#endif /* _WIN32 */
+    }
+    const auto decoded = SystemAbstractions::DecodeDiagnosticsBinaryLog(
+        log,
+        [](
+            double time,
+            const std::string& senderName,
+            size_t level,
+            const std::string& message
+        ){
+            const char* prefix = "";
+            if (level >= SystemAbstractions::DiagnosticsSender::Levels::ERROR) {
+                prefix = "error: ";
+            } else if (level >= SystemAbstractions::DiagnosticsSender::Levels::WARNING) {
+                prefix = "warning: ";
+            }
+            (void)printf(
+                "[%.6lf %s:%zu] %s%s\n",
+                time,
+                senderName.c_str(),
+                level,
+                prefix,
+                message.c_str()
+            );
+        }
+    );
+    if (log != stdin) {
+        (void)fclose(log);
+    }
+    if (!decoded) {
+        (void)fprintf(stderr, "error: log is corrupt or truncated\n");
+        return 1;
+    }
+    return 0;
+}